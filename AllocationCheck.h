@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+// Debug check that the warm AnalyzeBar path never touches the heap. Build
+// with BSTS_CHECK_ALLOCATIONS=1 to replace the global operator new with a
+// counting version; BSTS_EXPECT_NO_ALLOCATIONS then aborts with a message
+// if the thread allocated anywhere in the rest of the enclosing scope.
+// Disabled (the default), the macro expands to nothing and operator new
+// is untouched. The replacements are ordinary definitions in this header,
+// which is fine for this project's single translation unit builds (DLL,
+// standalone, tests, benchmarks); a multi-file build must enable the check
+// in exactly one of them.
+#ifndef BSTS_CHECK_ALLOCATIONS
+#define BSTS_CHECK_ALLOCATIONS 0
+#endif
+
+// Heap allocations made by the calling thread (always 0 when disabled)
+inline std::uint64_t& ThreadAllocationCount() {
+    thread_local std::uint64_t count = 0;
+    return count;
+}
+
+#if BSTS_CHECK_ALLOCATIONS
+void* operator new(std::size_t size) {
+    ++ThreadAllocationCount();
+    if (void* block = std::malloc(size ? size : 1)) return block;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return ::operator new(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    ++ThreadAllocationCount();
+    return std::malloc(size ? size : 1);
+}
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept { return ::operator new(size, tag); }
+// GCC flags free() on a block from operator new once both are inlined, not
+// knowing that this operator new is malloc
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* block) noexcept { std::free(block); }
+void operator delete[](void* block) noexcept { std::free(block); }
+void operator delete(void* block, std::size_t) noexcept { std::free(block); }
+void operator delete[](void* block, std::size_t) noexcept { std::free(block); }
+void operator delete(void* block, const std::nothrow_t&) noexcept { std::free(block); }
+void operator delete[](void* block, const std::nothrow_t&) noexcept { std::free(block); }
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
+
+// Aborts if the thread's allocation count moved during its lifetime
+class NoAllocationScope {
+private:
+    const char* where;
+    bool active;
+    std::uint64_t start;
+
+public:
+    NoAllocationScope(const char* scope, bool enabled)
+        : where(scope), active(enabled), start(ThreadAllocationCount()) {}
+    ~NoAllocationScope() {
+        std::uint64_t allocations = ThreadAllocationCount() - start;
+        if (active && allocations != 0) {
+            std::fprintf(stderr, "BSTS_CHECK_ALLOCATIONS: %llu heap allocation(s) in %s\n",
+                         static_cast<unsigned long long>(allocations), where);
+            std::abort();
+        }
+    }
+
+    NoAllocationScope(const NoAllocationScope&) = delete;
+    NoAllocationScope& operator=(const NoAllocationScope&) = delete;
+};
+
+// Fail if the rest of the enclosing scope allocates while `condition` holds
+#define BSTS_EXPECT_NO_ALLOCATIONS(where, condition) NoAllocationScope noAllocationScope((where), (condition))
+#else
+#define BSTS_EXPECT_NO_ALLOCATIONS(where, condition) ((void)0)
+#endif
@@ -0,0 +1,224 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+// Asynchronous signal pipeline: the chart thread hands each bar to a
+// background worker through a lock-free single-producer/single-consumer
+// queue and returns at once; the worker computes the signal and publishes
+// it through a seqlock, which the chart thread reads without blocking.
+
+// Bar handed to the worker; sequence numbers count submitted bars from 1
+struct AsyncBar {
+    std::uint64_t sequence = 0;
+    double open = 0.0;
+    double high = 0.0;
+    double low = 0.0;
+    double close = 0.0;
+    double volume = 0.0;
+    int barNumber = 0;
+};
+
+// Completed signal, tagged with the bar it belongs to (sequence 0: none yet)
+struct AsyncSignal {
+    std::uint64_t sequence = 0;
+    int barNumber = 0;
+    int action = 0;
+    double buySignal = 0.0;
+    double sellSignal = 0.0;
+    double confidence = 0.0;
+};
+
+// Fixed-capacity ring for one producer thread and one consumer thread.
+// Each side owns one index and only reads the other's, so push and pop
+// are wait-free; the indices sit on separate cache lines.
+template <typename T, std::size_t Capacity>
+class SpscQueue {
+private:
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    // Padded rather than alignas(64), so the pipeline holding the queue
+    // needs no over-aligned new before C++17
+    static constexpr std::size_t kLine = 64;
+
+    T items[Capacity];
+    char itemsPadding[kLine];
+    std::atomic<std::size_t> head{0};   // Next pop (consumer)
+    char headPadding[kLine];
+    std::atomic<std::size_t> tail{0};   // Next push (producer)
+    char tailPadding[kLine];
+
+public:
+    // Producer only; false when full
+    bool TryPush(const T& item) {
+        std::size_t position = tail.load(std::memory_order_relaxed);
+        if (position - head.load(std::memory_order_acquire) == Capacity) return false;
+        items[position & (Capacity - 1)] = item;
+        tail.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only; false when empty
+    bool TryPop(T& item) {
+        std::size_t position = head.load(std::memory_order_relaxed);
+        if (position == tail.load(std::memory_order_acquire)) return false;
+        item = items[position & (Capacity - 1)];
+        head.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool Empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+};
+
+// Latest value from one writer thread, readable from any thread without
+// locks. The value is kept as relaxed atomic words guarded by a sequence
+// counter that is odd while a write is in progress; readers retry until
+// they see the same even count before and after their copy.
+template <typename T>
+class Seqlock {
+private:
+    static_assert(std::is_trivially_copyable<T>::value, "Seqlock values are copied word by word");
+    static constexpr std::size_t kWords = (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+    std::atomic<std::uint64_t> version{0};
+    std::atomic<std::uint64_t> words[kWords];
+
+public:
+    Seqlock() { Store(T()); }
+
+    // Writer only
+    void Store(const T& value) {
+        std::uint64_t buffer[kWords] = {};
+        std::memcpy(buffer, &value, sizeof(T));
+        std::uint64_t start = version.load(std::memory_order_relaxed);
+        version.store(start + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 0; i < kWords; ++i) words[i].store(buffer[i], std::memory_order_relaxed);
+        version.store(start + 2, std::memory_order_release);
+    }
+
+    T Load() const {
+        std::uint64_t buffer[kWords];
+        for (;;) {
+            std::uint64_t before = version.load(std::memory_order_acquire);
+            if (before & 1) continue;
+            for (std::size_t i = 0; i < kWords; ++i) buffer[i] = words[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (version.load(std::memory_order_relaxed) == before) break;
+        }
+        T value;
+        std::memcpy(&value, buffer, sizeof(T));
+        return value;
+    }
+};
+
+// One background worker running compute(bar) for every submitted bar, in
+// order. Submit never blocks unless kQueueBars bars are already waiting
+// (it then yields until the worker frees a slot, so no bar is dropped).
+// The worker sleeps while the queue is empty; the producer only touches
+// the mutex to wake it. Stop() finishes the queued bars and joins the
+// worker; the destructor does not join, so a pipeline owned by a static
+// object never waits on a thread under the DLL loader lock.
+class AsyncSignalPipeline {
+public:
+    static constexpr std::size_t kQueueBars = 64;
+    using Compute = std::function<AsyncSignal(const AsyncBar&)>;
+
+private:
+    Compute compute;
+    SpscQueue<AsyncBar, kQueueBars> queue;
+    Seqlock<AsyncSignal> latest;
+    std::atomic<std::uint64_t> submitted{0};
+    std::atomic<std::uint64_t> completed{0};
+    std::atomic<bool> sleeping{false};
+    std::atomic<bool> stopping{false};
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::thread worker;
+
+public:
+    explicit AsyncSignalPipeline(Compute computeSignal)
+        : compute(std::move(computeSignal)), worker([this] { WorkerLoop(); }) {}
+
+    ~AsyncSignalPipeline() {
+        assert(!worker.joinable() && "Stop() an AsyncSignalPipeline before destroying it");
+        if (worker.joinable()) {
+            SignalStop();
+            worker.detach();
+        }
+    }
+
+    AsyncSignalPipeline(const AsyncSignalPipeline&) = delete;
+    AsyncSignalPipeline& operator=(const AsyncSignalPipeline&) = delete;
+
+    // Producer thread only: queue the bar, assigning its sequence number
+    std::uint64_t Submit(AsyncBar bar) {
+        bar.sequence = submitted.load(std::memory_order_relaxed) + 1;
+        while (!queue.TryPush(bar)) std::this_thread::yield();
+        submitted.store(bar.sequence, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);   // Push before the sleep check
+        if (sleeping.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(mutex);
+            wake.notify_one();
+        }
+        return bar.sequence;
+    }
+
+    // Last completed signal
+    AsyncSignal Latest() const { return latest.Load(); }
+
+    std::uint64_t Submitted() const { return submitted.load(std::memory_order_acquire); }
+    std::uint64_t Completed() const { return completed.load(std::memory_order_acquire); }
+
+    // Wait until every submitted bar has been computed
+    void Drain() const {
+        while (Completed() != Submitted()) std::this_thread::yield();
+    }
+
+    // Compute the queued bars, then join the worker. No bar may be
+    // submitted afterwards; calling Stop() again does nothing.
+    void Stop() {
+        if (!worker.joinable()) return;
+        SignalStop();
+        worker.join();
+    }
+
+private:
+    void SignalStop() {
+        stopping.store(true, std::memory_order_seq_cst);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+        }
+        wake.notify_one();
+    }
+
+    void WorkerLoop() {
+        AsyncBar bar;
+        for (;;) {
+            if (queue.TryPop(bar)) {
+                latest.Store(compute(bar));
+                completed.store(bar.sequence, std::memory_order_release);
+                continue;
+            }
+            if (stopping.load(std::memory_order_acquire) && queue.Empty()) return;
+
+            // Announce the sleep before the last check, so a bar pushed in
+            // between is either seen here or followed by a notify
+            std::unique_lock<std::mutex> lock(mutex);
+            sleeping.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            wake.wait(lock, [&] { return !queue.Empty() || stopping.load(std::memory_order_seq_cst); });
+            sleeping.store(false, std::memory_order_relaxed);
+        }
+    }
+};
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+#include <vector>
+
+#include "RollingStatistics.h"
+
+// Native replay of the ELD strategy over a bar series. Each bar goes
+// through the strategy's AnalyzeBar; orders are placed on the bar's close
+// and filled at the next bar's open, as "next bar at market" does on a
+// chart:
+//
+//   - Flat and confidence >= minConfidence: buy on action 1 with buy
+//     strength >= minSignalStrength, sell short on action -1 with sell
+//     strength >= minSignalStrength. Size is whole shares worth
+//     maxPositionSize of initial capital plus closed-trade profit.
+//   - In a position: the strategy is told the fill (SetPosition) and
+//     exits when ShouldClosePosition reports its stop or target hit.
+//
+// A position still open after the last bar is closed at its close. The
+// strategy's own simulation is the only per-bar cost, so years of minute
+// bars replay in seconds with the analytic or terminal-sampling engines.
+
+// Structure-of-arrays view of OHLCV bars, oldest first. Nothing is copied,
+// so a series can be shared read-only by many backtests. volume may be null.
+struct BarSeries {
+    const double* open = nullptr;
+    const double* high = nullptr;
+    const double* low = nullptr;
+    const double* close = nullptr;
+    const double* volume = nullptr;
+    std::size_t count = 0;
+
+    // A close-only series: open, high and low all read the closes
+    static BarSeries FromCloses(const double* closes, std::size_t count) {
+        BarSeries bars;
+        bars.open = bars.high = bars.low = bars.close = closes;
+        bars.count = count;
+        return bars;
+    }
+};
+
+// Strategy-level (ELD input) settings; the algorithm parameters themselves
+// are set on the strategy instance before the run
+struct BacktestSettings {
+    double initialCapital = 100000.0;
+    double maxPositionSize = 0.1;
+    double minConfidence = 0.5;
+    double minSignalStrength = 0.3;
+    double barsPerYear = 252.0;    // Annualizes the Sharpe ratio
+};
+
+struct BacktestTrade {
+    std::size_t entryBar = 0;      // Fill bars (index into the series)
+    std::size_t exitBar = 0;
+    int shares = 0;                // Positive long, negative short
+    double entryPrice = 0.0;
+    double exitPrice = 0.0;
+    double profit = 0.0;
+};
+
+struct BacktestMetrics {
+    double totalReturn = 0.0;
+    double sharpeRatio = 0.0;      // Annualized from per-bar equity returns
+    double maxDrawdown = 0.0;      // Largest peak-to-trough equity loss, as a fraction
+    int trades = 0;
+    double winRate = 0.0;          // Fraction of trades with a profit
+    double profitFactor = 0.0;     // Gross profit / gross loss (infinite with no losses)
+};
+
+struct BacktestReport {
+    std::vector<double> equity;    // Marked to each bar's close, one per replayed bar
+    std::vector<BacktestTrade> trades;
+    BacktestMetrics metrics;
+};
+
+// Replay bars [begin, end) through `strategy`, which provides the
+// BlackScholesTradeStation interface (AnalyzeBar, SetPosition,
+// ShouldClosePosition). The strategy should already be warmed up on any
+// bars before `begin` it needs.
+template <typename Strategy>
+BacktestReport RunBacktest(Strategy& strategy, const BarSeries& bars, const BacktestSettings& settings,
+                           std::size_t begin = 0, std::size_t end = std::numeric_limits<std::size_t>::max()) {
+    BacktestReport report;
+    end = std::min(end, bars.count);
+    if (!bars.close || begin >= end) return report;
+    report.equity.reserve(end - begin);
+
+    double closedProfit = 0.0;
+    int shares = 0;                 // Open position
+    double entryPrice = 0.0;
+    std::size_t entryBar = 0;
+    int pendingShares = 0;          // Order for the next bar's open: entry size, or 0
+    bool pendingExit = false;
+
+    auto closeTrade = [&](std::size_t bar, double price) {
+        BacktestTrade trade;
+        trade.entryBar = entryBar;
+        trade.exitBar = bar;
+        trade.shares = shares;
+        trade.entryPrice = entryPrice;
+        trade.exitPrice = price;
+        trade.profit = shares * (price - entryPrice);
+        closedProfit += trade.profit;
+        report.trades.push_back(trade);
+        shares = 0;
+        strategy.SetPosition(0.0, 0);
+    };
+
+    for (std::size_t i = begin; i < end; ++i) {
+        double open = bars.open[i];
+        double close = bars.close[i];
+        if (pendingExit) {
+            closeTrade(i, open);
+            pendingExit = false;
+        } else if (pendingShares != 0) {
+            shares = pendingShares;
+            entryPrice = open;
+            entryBar = i;
+            strategy.SetPosition(entryPrice, shares);
+        }
+        pendingShares = 0;
+
+        double buySignal, sellSignal, confidence;
+        int action = strategy.AnalyzeBar(open, bars.high[i], bars.low[i], close,
+                                         bars.volume ? bars.volume[i] : 0.0, static_cast<int>(i + 1),
+                                         buySignal, sellSignal, confidence);
+
+        if (shares != 0) {
+            pendingExit = strategy.ShouldClosePosition();
+        } else if (confidence >= settings.minConfidence && close > 0.0) {
+            int size = static_cast<int>((settings.initialCapital + closedProfit) * settings.maxPositionSize / close);
+            if (action == 1 && buySignal >= settings.minSignalStrength) pendingShares = size;
+            if (action == -1 && sellSignal >= settings.minSignalStrength) pendingShares = -size;
+        }
+
+        report.equity.push_back(settings.initialCapital + closedProfit + shares * (close - entryPrice));
+    }
+    if (shares != 0) closeTrade(end - 1, bars.close[end - 1]);
+
+    // Metrics from the equity curve and the closed trades
+    BacktestMetrics& metrics = report.metrics;
+    metrics.totalReturn = closedProfit / settings.initialCapital;
+
+    RollingStatistics barReturns;
+    double previous = settings.initialCapital, peak = settings.initialCapital;
+    for (double value : report.equity) {
+        barReturns.Add(value / previous - 1.0);
+        previous = value;
+        peak = std::max(peak, value);
+        metrics.maxDrawdown = std::max(metrics.maxDrawdown, 1.0 - value / peak);
+    }
+    double deviation = std::sqrt(barReturns.Variance());
+    metrics.sharpeRatio = deviation > 0.0 ? barReturns.Mean() / deviation * std::sqrt(settings.barsPerYear) : 0.0;
+
+    double grossProfit = 0.0, grossLoss = 0.0;
+    int wins = 0;
+    for (const BacktestTrade& trade : report.trades) {
+        if (trade.profit > 0.0) {
+            grossProfit += trade.profit;
+            ++wins;
+        } else {
+            grossLoss -= trade.profit;
+        }
+    }
+    metrics.trades = static_cast<int>(report.trades.size());
+    metrics.winRate = metrics.trades > 0 ? static_cast<double>(wins) / metrics.trades : 0.0;
+    metrics.profitFactor = grossLoss > 0.0 ? grossProfit / grossLoss
+                         : grossProfit > 0.0 ? std::numeric_limits<double>::infinity() : 0.0;
+    return report;
+}
+
+// Summary line and one row per trade
+inline void WriteBacktestReport(std::ostream& out, const BacktestReport& report) {
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    const BacktestMetrics& m = report.metrics;
+    out << std::fixed << std::setprecision(3) << "Return " << m.totalReturn << ", Sharpe " << m.sharpeRatio
+        << ", max drawdown " << m.maxDrawdown << ", trades " << m.trades << ", win rate " << m.winRate
+        << ", profit factor " << m.profitFactor << "\n";
+    out << "   Entry     Exit   Shares    Entry $     Exit $      Profit\n";
+    out << std::setprecision(2);
+    for (const BacktestTrade& trade : report.trades) {
+        out << std::setw(8) << trade.entryBar << std::setw(9) << trade.exitBar << std::setw(9) << trade.shares
+            << std::setw(11) << trade.entryPrice << std::setw(11) << trade.exitPrice
+            << std::setw(12) << trade.profit << "\n";
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
@@ -0,0 +1,284 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Backtester.h"
+#include "MappedFile.h"
+
+// Columnar binary bar files. A 128-byte header is followed by six columns,
+// each starting on a 64-byte boundary:
+//
+//   timestamp  int64   YYYYMMDDhhmm, strictly increasing (the time index)
+//   open, high, low, close, volume   double
+//
+// Files are little-endian and written once. BarFile maps a file read-only
+// and hands out BarSeries views that point straight into the mapping, so
+// opening a multi-GB history costs no reads or copies, and every backtest
+// or sweep worker in the process shares the same pages.
+
+struct BarFileHeader {
+    char magic[8];                   // "BSTSBARS"
+    std::uint32_t version;
+    std::uint32_t columnCount;
+    std::uint64_t barCount;
+    std::uint64_t columnOffsets[6];  // Bytes from the start of the file
+    std::uint8_t reserved[56];
+};
+static_assert(sizeof(BarFileHeader) == 128, "bar file header layout");
+
+constexpr char kBarFileMagic[8] = {'B', 'S', 'T', 'S', 'B', 'A', 'R', 'S'};
+constexpr std::uint32_t kBarFileVersion = 1;
+constexpr std::size_t kBarFileAlignment = 64;
+
+enum BarFileColumn {
+    kBarTimestamp,
+    kBarOpen,
+    kBarHigh,
+    kBarLow,
+    kBarClose,
+    kBarVolume,
+    kBarColumnCount
+};
+
+// Owning columns, as parsed from CSV or built in memory
+struct BarColumns {
+    std::vector<std::int64_t> timestamps;
+    std::vector<double> open, high, low, close, volume;
+
+    std::size_t Size() const { return close.size(); }
+
+    BarSeries Series() const {
+        BarSeries bars;
+        bars.open = open.data();
+        bars.high = high.data();
+        bars.low = low.data();
+        bars.close = close.data();
+        bars.volume = volume.data();
+        bars.count = Size();
+        return bars;
+    }
+};
+
+// Write `bars` (with one timestamp per bar) as a bar file; false on I/O
+// failure or timestamps that are not strictly increasing
+inline bool WriteBarFile(const char* path, const std::int64_t* timestamps, const BarSeries& bars) {
+    for (std::size_t i = 1; i < bars.count; ++i) {
+        if (timestamps[i] <= timestamps[i - 1]) return false;
+    }
+
+    BarFileHeader header = {};
+    std::memcpy(header.magic, kBarFileMagic, sizeof(header.magic));
+    header.version = kBarFileVersion;
+    header.columnCount = kBarColumnCount;
+    header.barCount = bars.count;
+    std::uint64_t columnBytes = bars.count * sizeof(double);
+    std::uint64_t stride = (columnBytes + kBarFileAlignment - 1) / kBarFileAlignment * kBarFileAlignment;
+    for (int c = 0; c < kBarColumnCount; ++c) header.columnOffsets[c] = sizeof(BarFileHeader) + c * stride;
+
+    std::vector<double> zeros;
+    const void* columns[kBarColumnCount] = {timestamps, bars.open, bars.high, bars.low, bars.close, bars.volume};
+    if (!bars.volume) {
+        zeros.assign(bars.count, 0.0);
+        columns[kBarVolume] = zeros.data();
+    }
+
+    std::FILE* file = std::fopen(path, "wb");
+    if (!file) return false;
+    static const char padding[kBarFileAlignment] = {};
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    for (int c = 0; c < kBarColumnCount && ok; ++c) {
+        ok = bars.count == 0 || std::fwrite(columns[c], columnBytes, 1, file) == 1;
+        if (ok && stride > columnBytes) ok = std::fwrite(padding, stride - columnBytes, 1, file) == 1;
+    }
+    return std::fclose(file) == 0 && ok;
+}
+
+inline bool WriteBarFile(const char* path, const BarColumns& columns) {
+    return WriteBarFile(path, columns.timestamps.data(), columns.Series());
+}
+
+// Read-only mapping of a bar file
+class BarFile {
+private:
+    MappedFile mapped;
+    const unsigned char* data = nullptr;
+    std::size_t size = 0;
+    const BarFileHeader* header = nullptr;
+
+    const double* Column(int column) const {
+        return reinterpret_cast<const double*>(data + header->columnOffsets[column]);
+    }
+
+    // Magic, version and every column inside the mapped size and aligned
+    bool Validate() const {
+        if (size < sizeof(BarFileHeader)) return false;
+        if (std::memcmp(header->magic, kBarFileMagic, sizeof(kBarFileMagic)) != 0) return false;
+        if (header->version != kBarFileVersion || header->columnCount != kBarColumnCount) return false;
+        if (header->barCount > size / sizeof(double)) return false;
+        std::uint64_t columnBytes = header->barCount * sizeof(double);
+        for (int c = 0; c < kBarColumnCount; ++c) {
+            std::uint64_t offset = header->columnOffsets[c];
+            if (offset % kBarFileAlignment != 0 || offset > size || size - offset < columnBytes) return false;
+        }
+        return true;
+    }
+
+public:
+    BarFile() = default;
+
+    BarFile(const BarFile&) = delete;
+    BarFile& operator=(const BarFile&) = delete;
+
+    // Map `path`; false (and nothing mapped) if it is missing or not a
+    // valid bar file
+    bool Open(const char* path) {
+        Close();
+        if (!mapped.Open(path)) return false;
+        data = mapped.Data();
+        size = mapped.Size();
+        header = reinterpret_cast<const BarFileHeader*>(data);
+        if (!Validate()) {
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    void Close() {
+        mapped.Close();
+        data = nullptr;
+        header = nullptr;
+        size = 0;
+    }
+
+    bool IsOpen() const { return data != nullptr; }
+    std::size_t Count() const { return header ? static_cast<std::size_t>(header->barCount) : 0; }
+
+    const std::int64_t* Timestamps() const {
+        return header ? reinterpret_cast<const std::int64_t*>(data + header->columnOffsets[kBarTimestamp]) : nullptr;
+    }
+
+    // Zero-copy view of the whole file; valid while the file stays open
+    BarSeries Bars() const {
+        BarSeries bars;
+        if (!header) return bars;
+        bars.open = Column(kBarOpen);
+        bars.high = Column(kBarHigh);
+        bars.low = Column(kBarLow);
+        bars.close = Column(kBarClose);
+        bars.volume = Column(kBarVolume);
+        bars.count = Count();
+        return bars;
+    }
+
+    // First bar at or after `timestamp` (Count() if none), by binary search
+    // on the time index
+    std::size_t LowerBound(std::int64_t timestamp) const {
+        const std::int64_t* timestamps = Timestamps();
+        return timestamps ? static_cast<std::size_t>(std::lower_bound(timestamps, timestamps + Count(), timestamp) -
+                                                     timestamps)
+                          : 0;
+    }
+};
+
+// TradeStation CSV export ("Date","Time","Open","High","Low","Close",
+// "Vol", ...; dates MM/DD/YYYY, times HH:MM or HHMM). Columns are found by
+// header name; daily exports without a Time column get 00:00, and a
+// missing volume column reads as 0. Rows are sorted by time and repeated
+// timestamps keep the last row. Returns false if the file cannot be read,
+// a required column is missing, or a row does not parse.
+inline bool ReadTradeStationCsv(const char* path, BarColumns& out) {
+    out = BarColumns();
+    std::ifstream in(path);
+    if (!in) return false;
+
+    auto split = [](const std::string& line) {
+        std::vector<std::string> fields;
+        std::string field;
+        std::istringstream stream(line);
+        while (std::getline(stream, field, ',')) {
+            field.erase(std::remove(field.begin(), field.end(), '"'), field.end());
+            field.erase(std::remove_if(field.begin(), field.end(),
+                                       [](unsigned char ch) { return std::isspace(ch) != 0; }),
+                        field.end());
+            fields.push_back(field);
+        }
+        return fields;
+    };
+
+    std::string line;
+    if (!std::getline(in, line)) return false;
+    int date = -1, time = -1, open = -1, high = -1, low = -1, close = -1, volume = -1;
+    std::vector<std::string> names = split(line);
+    for (int i = 0; i < static_cast<int>(names.size()); ++i) {
+        std::string name = names[i];
+        std::transform(name.begin(), name.end(), name.begin(), [](unsigned char ch) { return std::tolower(ch); });
+        if (name == "date") date = i;
+        else if (name == "time") time = i;
+        else if (name == "open") open = i;
+        else if (name == "high") high = i;
+        else if (name == "low") low = i;
+        else if (name == "close") close = i;
+        else if (name == "vol" || name == "volume" || name == "totalvolume") volume = i;
+    }
+    if (date < 0 || open < 0 || high < 0 || low < 0 || close < 0) return false;
+    int required = std::max({date, time, open, high, low, close, volume});
+
+    struct Row {
+        std::int64_t timestamp;
+        double open, high, low, close, volume;
+    };
+    std::vector<Row> rows;
+    while (std::getline(in, line)) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+        std::vector<std::string> fields = split(line);
+        if (static_cast<int>(fields.size()) <= required) return false;
+
+        int month, day, year, hour = 0, minute = 0;
+        if (std::sscanf(fields[date].c_str(), "%d/%d/%d", &month, &day, &year) != 3) return false;
+        if (time >= 0) {
+            const std::string& t = fields[time];
+            bool parsed = t.find(':') != std::string::npos
+                ? std::sscanf(t.c_str(), "%d:%d", &hour, &minute) == 2
+                : std::sscanf(t.c_str(), "%d", &hour) == 1 && (minute = hour % 100, hour /= 100, true);
+            if (!parsed) return false;
+        }
+
+        Row row;
+        row.timestamp = ((static_cast<std::int64_t>(year) * 100 + month) * 100 + day) * 10000 + hour * 100 + minute;
+        char* end;
+        const int columns[5] = {open, high, low, close, volume};
+        double* values[5] = {&row.open, &row.high, &row.low, &row.close, &row.volume};
+        for (int c = 0; c < 5; ++c) {
+            if (columns[c] < 0) {
+                *values[c] = 0.0;
+                continue;
+            }
+            *values[c] = std::strtod(fields[columns[c]].c_str(), &end);
+            if (end == fields[columns[c]].c_str()) return false;
+        }
+        rows.push_back(row);
+    }
+
+    std::stable_sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) { return a.timestamp < b.timestamp; });
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        if (i + 1 < rows.size() && rows[i + 1].timestamp == rows[i].timestamp) continue;
+        out.timestamps.push_back(rows[i].timestamp);
+        out.open.push_back(rows[i].open);
+        out.high.push_back(rows[i].high);
+        out.low.push_back(rows[i].low);
+        out.close.push_back(rows[i].close);
+        out.volume.push_back(rows[i].volume);
+    }
+    return true;
+}
@@ -5,6 +5,32 @@
 #include <algorithm>
 #include <map>
 #include <string>
+#include <limits>
+#include <cstdlib>
+#include <memory>
+#include <type_traits>
+
+#include "RingBuffer.h"
+#include "RollingStatistics.h"
+#include "RangeVolatility.h"
+#include "SimdKernels.h"
+#include "NormalCDF.h"
+#include "OptionChainPricer.h"
+#include "ImpliedVolatility.h"
+#include "ThreadPool.h"
+#include "SobolSequence.h"
+#include "InstanceTable.h"
+#include "Backtester.h"
+#include "ParameterSweep.h"
+#include "BarFile.h"
+#include "Portfolio.h"
+#include "AsyncSignals.h"
+#include "SignalCache.h"
+#include "PricingSurface.h"
+#include "Random.h"
+#include "StateFile.h"
+#include "PerfStats.h"
+#include "AllocationCheck.h"
 
 // TradeStation C++ DLL Interface Headers
 #ifdef TRADESTATION_DLL
@@ -12,7 +38,93 @@
 #include "TSStudyInfo.h"
 #endif
 
-class BlackScholesTradeStation {
+// How GenerateTradingSignal evaluates the 21-day terminal price
+// distribution. Values are shared with the SetSimulationEngine DLL export.
+enum class SimulationEngine {
+    PathStepping = 0,      // Step every day of the path (needed for path-dependent rules)
+    TerminalSampling = 1,  // Draw the GBM terminal price exactly in one step
+    Analytic = 2,          // Closed-form lognormal statistics, no simulation
+    Barrier = 3            // Paths absorbed at the stop-loss / take-profit levels (first passage)
+};
+
+// How the simulated engines reduce estimator variance. Values are shared
+// with the SetVarianceReduction DLL export.
+enum class VarianceReduction {
+    None = 0,            // Independent pseudo-random paths
+    Antithetic = 1,      // Every path is paired with its mirrored shocks (z, -z)
+    ControlVariate = 2,  // Probabilities regressed on S_T, whose mean S*exp(mu*T) is known
+    Sobol = 3            // Owen-scrambled Sobol points, independent scrambles give the error
+};
+
+// Statistics of the simulated (or exact) terminal price distribution
+struct TerminalDistribution {
+    double meanPrice = 0.0;
+    double profitProbability = 0.0;  // P(S_T > kProfitThreshold * S)
+    double lossProbability = 0.0;    // P(S_T < kLossThreshold * S)
+    double confidence = 0.0;         // min(1, effectivePaths / 1000)
+    
+    // Standard errors of the estimates above (0 when exact)
+    double meanPriceStdError = 0.0;
+    double profitProbabilityStdError = 0.0;
+    double lossProbabilityStdError = 0.0;
+    
+    // Independent plain Monte Carlo paths that would give the same
+    // probability error; the path count itself without variance reduction
+    double effectivePaths = 0.0;
+    
+    // Barrier engine only (0 otherwise), for a long entered at the spot:
+    // the chances of touching the stop-loss and take-profit levels within
+    // the horizon, and the expected holding time min(exit, horizon) in
+    // trading days. The statistics above are then those of the exit price,
+    // with a stop-loss exit counted as a loss and a take-profit exit as a
+    // profit.
+    double stopLossHitProbability = 0.0;
+    double takeProfitHitProbability = 0.0;
+    double expectedExitDays = 0.0;
+    double expectedExitDaysStdError = 0.0;
+};
+
+// Compile-time choices of a BasicBlackScholesTradeStation. The signal
+// horizon and thresholds, the normal CDF tier behind the signal pricing
+// and the analytic engine, and optionally the engine itself: with
+// kFixedEngine the engine is kEngine for good, its switches fold away and
+// SetSimulationEngine has no effect; otherwise kEngine is the initial one.
+//
+// Rng, NormalSampler and Real choose the random numbers and arithmetic of
+// the Monte Carlo paths: a Random.h-style generator constructible from a
+// 64-bit seed, a sampler template over it, and the type the log paths are
+// accumulated in. The defaults, Philox4x32 with Box-Muller in double, are
+// what the SIMD path kernels generate in registers, so they run there; any
+// other choice runs a scalar loop over the same chunks. Sobol runs and the
+// barrier engine keep their own sequences.
+struct DefaultSignalPolicy {
+    static constexpr int kHorizonDays = 21;
+    static constexpr double kProfitThreshold = 1.05;
+    static constexpr double kLossThreshold = 0.95;
+    static constexpr CdfAccuracy kCdfAccuracy = kDefaultCdfAccuracy;
+    static constexpr bool kFixedEngine = false;
+    static constexpr SimulationEngine kEngine = SimulationEngine::TerminalSampling;
+    
+    using Rng = Philox4x32;
+    template <typename Generator> using NormalSampler = BoxMullerNormal<Generator>;
+    using Real = double;
+};
+
+// Exact terminal sampling only
+struct TerminalSamplingPolicy : DefaultSignalPolicy {
+    static constexpr bool kFixedEngine = true;
+};
+
+// Screening: closed-form distribution and the fast CDF tier, no
+// simulation; a fraction of a microsecond per bar for wide universes
+struct ScreeningPolicy : DefaultSignalPolicy {
+    static constexpr CdfAccuracy kCdfAccuracy = CdfAccuracy::Fast;
+    static constexpr bool kFixedEngine = true;
+    static constexpr SimulationEngine kEngine = SimulationEngine::Analytic;
+};
+
+template <typename Policy>
+class BasicBlackScholesTradeStation {
 private:
     // Algorithm parameters
     double riskFreeRate;
@@ -21,15 +133,74 @@ private:
     double takeProfitPercent;
     int lookbackPeriod;
     int monteCarloSimulations;
+    SimulationEngine simulationEngine;
+    VarianceReduction varianceReduction;
+    
+    // Signal horizon and the relative price levels counted as profit/loss
+    static constexpr int kSignalHorizonDays = Policy::kHorizonDays;
+    static constexpr double kProfitThreshold = Policy::kProfitThreshold;
+    static constexpr double kLossThreshold = Policy::kLossThreshold;
+    
+    // Options behind the signal: 5% OTM call and put, 30 days out
+    static constexpr double kSignalCallMoneyness = 1.05;
+    static constexpr double kSignalPutMoneyness = 0.95;
+    static constexpr double kSignalOptionYears = 30.0 / 365.0;
+    
+    // Paths per parallel work chunk (in 16-path kernel tiles). Fixed so the
+    // split, and therefore every path, is the same for any thread count.
+    static constexpr std::size_t kParallelChunkTiles = 64;
+    
+    // Independent scrambles behind the Sobol standard error
+    static constexpr int kSobolReplicates = 16;
+    
+    // Path random numbers (see DefaultSignalPolicy); the defaults run on
+    // the SIMD kernels
+    using Rng = typename Policy::Rng;
+    using NormalSampler = typename Policy::template NormalSampler<Rng>;
+    using Real = typename Policy::Real;
+    static constexpr bool kKernelSampling = std::is_same<Rng, Philox4x32>::value &&
+                                            std::is_same<NormalSampler, BoxMullerNormal<Philox4x32>>::value &&
+                                            std::is_same<Real, double>::value;
+    
+    // Trading days per step of the barrier engine; the bridge test keeps
+    // the first passage exact between steps
+    static constexpr int kBarrierStepDays = 5;
+    
+    // Simulation key for sweep evaluations, so every run scores the same
+    static constexpr std::uint64_t kSweepSeed = 0x5EEDULL;
     
-    // Data storage
-    std::vector<double> priceHistory;
-    std::vector<double> volatilityHistory;
-    std::vector<double> returns;
+    // Data storage (fixed-capacity rolling windows sized to lookbackPeriod)
+    RingBuffer<double> priceHistory;
+    RingBuffer<double> volatilityHistory;
+    RingBuffer<double> returns;
     
-    // Random number generation
-    std::mt19937 generator;
-    std::normal_distribution<double> normalDist;
+    // Streaming return statistics, kept in step with the returns window
+    static constexpr std::size_t kDriftWindow = 21;
+    static constexpr std::size_t kStatisticsResyncInterval = 1024;
+    RollingStatistics returnStats;   // Whole lookback window (volatility)
+    RollingStatistics driftStats;    // Last kDriftWindow returns (expected return)
+    
+    // OHLC range estimator (SetVolatilityEstimator) over the lookback; its
+    // window has no capacity under close-to-close
+    RangeVolatility rangeVolatility;
+    
+    // Closes before the first signal. The range estimators are several
+    // times more efficient, so they reach the precision of 30 bars of
+    // returns in a third of the bars.
+    static constexpr std::size_t kWarmupBars = 30;
+    static constexpr std::size_t kRangeWarmupBars = 10;
+    
+    // Random number generation: counter-based Philox streams keyed by the
+    // seed. Each bar owns 256 streams numbered from the bars ingested, one
+    // per use, so a bar close draws the same paths however many ticks and
+    // diagnostics were evaluated before it.
+    enum class StreamUse : std::uint64_t { BarClose = 0, Tick = 1, Diagnostic = 2 };
+    std::uint64_t simulationSeed;
+    std::uint64_t barsIngested;
+    
+    std::uint64_t SimulationStream(StreamUse use) const {
+        return (barsIngested << 8) | static_cast<std::uint64_t>(use);
+    }
     
     // Position tracking
     struct Position {
@@ -40,227 +211,1131 @@ private:
     };
     Position currentPosition;
     
+    // Implied volatility solutions from the last chain, the next chain's
+    // starting points
+    ImpliedVolatilitySolver impliedVolatility;
+    
+    // Partial sums of the Monte Carlo chunks, reused by every bar
+    std::vector<simd::TerminalPriceSums> chunkSums;
+    std::vector<simd::BarrierSums> barrierChunkSums;
+    
+    struct TradingSignal {
+        double buyStrength = 0.0;
+        double sellStrength = 0.0;
+        double confidence = 0.0;
+        int action = 0; // 1 = Buy, -1 = Sell, 0 = Hold
+    };
+    
+    // Last full evaluation of the forming bar (UpdateTick), reused while
+    // the tick price stays within tickEpsilon of it. Any new bar or
+    // simulation setting invalidates it.
+    struct TickEvaluation {
+        bool valid = false;
+        double price = 0.0;
+        TerminalDistribution distribution;
+    };
+    TickEvaluation tickEvaluation;
+    double tickEpsilon;   // Relative price move that triggers a re-evaluation
+    
+    // Recent bar signals by quantized (price, volatility, drift, horizon,
+    // paths) cell, reused while the bar's state stays in a cached cell
+    SignalCache<TradingSignal> signalCache;
+    double signalCacheTolerance;   // Cell width; 0 disables the cache
+    
+    // Signal option values over volatility at the current rate
+    // (SetPricingSurface), rebuilt whenever the rate changes
+    PricingSurface pricingSurface;
+    bool usePricingSurface = false;
+    
+    // Bar in flight between BeginBatchBar and FinishBatchBar
+    struct BatchBar {
+        bool signal = false;      // Enough history for a signal
+        bool simulated = false;   // Monte Carlo chunks run by the batch (else evaluated on finish)
+        bool cacheable = false;   // Has a signal cache cell (cell)
+        bool cached = false;      // Signal taken from the cache (signal)
+        SignalCacheKey cell;
+        TradingSignal cachedSignal;
+        double close = 0.0;
+        double volatility = 0.0;
+        double drift = 0.0;
+        simd::GbmTileParameters parameters;
+        simd::TerminalReduction reduction;
+    };
+    BatchBar batchBar;
+    
+#if BSTS_CHECK_ALLOCATIONS
+    // Set once a signal has run with the current settings; later signal
+    // bars must not allocate
+    bool signalPathWarm = false;
+#endif
+    
+#if BSTS_PERF_STATS
+    // Per-stage AnalyzeBar latencies (GetPerfStats)
+    PerfStats perfStats;
+#endif
+    
+    // Latest close seen by the caller's thread, which marks new positions
+    // (the windows belong to the worker in async mode)
+    double markPrice = 0.0;
+    
+    // Async mode (SetAsyncMode): the worker that owns the windows and
+    // computes the signals. Declared last, so it stops before anything it
+    // uses is destroyed.
+    std::unique_ptr<AsyncSignalPipeline> asyncPipeline;
+    
 public:
-    BlackScholesTradeStation() 
+    BasicBlackScholesTradeStation() 
         : riskFreeRate(0.02),
           maxPositionSize(0.1),
           stopLossPercent(0.05),
           takeProfitPercent(0.15),
           lookbackPeriod(252),
           monteCarloSimulations(1000),
-          generator(std::random_device{}()),
-          normalDist(0.0, 1.0) {
-        
-        priceHistory.reserve(lookbackPeriod);
-        volatilityHistory.reserve(lookbackPeriod);
-        returns.reserve(lookbackPeriod);
+          simulationEngine(Policy::kEngine),
+          varianceReduction(VarianceReduction::None),
+          priceHistory(lookbackPeriod),
+          volatilityHistory(lookbackPeriod),
+          returns(lookbackPeriod),
+          simulationSeed(RandomSeed()),
+          barsIngested(0),
+          tickEpsilon(0.001),
+          signalCacheTolerance(0.0) {
+        ReserveSimulationBuffer();
     }
     
-    // Main analysis function called by TradeStation
+    // Joins the async worker, if any, on the destroying thread
+    ~BasicBlackScholesTradeStation() { SetAsyncMode(false); }
+    
+    // Main analysis function called by TradeStation. In async mode the bar
+    // is queued for the worker and the last completed signal is returned.
     int AnalyzeBar(double open, double high, double low, double close, double volume, 
                    int barNumber, double& buySignal, double& sellSignal, double& confidence) {
+        std::uint64_t sequence;
+        return AnalyzeBar(open, high, low, close, volume, barNumber, buySignal, sellSignal, confidence,
+                          sequence);
+    }
+    
+    // As above, also giving the sequence number of the returned signal: in
+    // async mode the count of bars submitted up to the one it was computed
+    // for (0 before the first completes), so the caller can tell how stale
+    // it is; always 0 in synchronous mode, where the signal is this bar's
+    int AnalyzeBar(double open, double high, double low, double close, double volume, 
+                   int barNumber, double& buySignal, double& sellSignal, double& confidence,
+                   std::uint64_t& sequence) {
+        BSTS_PERF_SPAN(perfStats, PerfStage::Bar);
+        markPrice = close;
+        sequence = 0;
+        if (asyncPipeline) {
+            BSTS_EXPECT_NO_ALLOCATIONS("async AnalyzeBar", true);
+            AsyncBar bar;
+            bar.open = open;
+            bar.high = high;
+            bar.low = low;
+            bar.close = close;
+            bar.volume = volume;
+            bar.barNumber = barNumber;
+            asyncPipeline->Submit(bar);
+            UpdatePosition(close);
+            return LatestSignal(buySignal, sellSignal, confidence, &sequence);
+        }
         
-        // Update price history
-        UpdatePriceHistory(close);
+        BSTS_EXPECT_NO_ALLOCATIONS("warm AnalyzeBar", signalPathWarm);
+        TradingSignal signal = AnalyzeClose(open, high, low, close);
+        buySignal = signal.buyStrength;
+        sellSignal = signal.sellStrength;
+        confidence = signal.confidence;
         
-        // Need minimum data for analysis
-        if (priceHistory.size() < 30) {
-            buySignal = 0.0;
-            sellSignal = 0.0;
-            confidence = 0.0;
+        // Update position tracking
+        if (priceHistory.Size() >= WarmupBars()) {
+            BSTS_PERF_SPAN(perfStats, PerfStage::Position);
+            UpdatePosition(close);
+        }
+        
+        return signal.action; // 1 = Buy, -1 = Sell, 0 = Hold
+    }
+    
+    // Async mode: AnalyzeBar returns at once and a background worker
+    // computes the signal, so a large simulation never holds up the chart
+    // thread. Results arrive through PollSignal, tagged with the sequence
+    // number of their bar, so the caller decides whether a signal is too
+    // stale to act on. While a worker runs, calls that read or change the
+    // windows or the simulation settings first wait for the queued bars;
+    // UpdateTick only reports the latest signal. Position tracking stays in
+    // the calling thread. Switching off drains the queue and stops the
+    // worker. An instance must not be moved while async.
+    void SetAsyncMode(bool enabled) {
+        if (enabled && !asyncPipeline) {
+            asyncPipeline.reset(new AsyncSignalPipeline([this](const AsyncBar& bar) {
+                AsyncSignal result;
+                result.sequence = bar.sequence;
+                result.barNumber = bar.barNumber;
+                BSTS_EXPECT_NO_ALLOCATIONS("async signal", signalPathWarm);
+                TradingSignal signal = AnalyzeClose(bar.open, bar.high, bar.low, bar.close);
+                result.action = signal.action;
+                result.buySignal = signal.buyStrength;
+                result.sellSignal = signal.sellStrength;
+                result.confidence = signal.confidence;
+                return result;
+            }));
+        } else if (!enabled && asyncPipeline) {
+            asyncPipeline->Stop();
+            asyncPipeline.reset();
+        }
+    }
+    bool AsyncMode() const { return asyncPipeline != nullptr; }
+    
+    // Latest completed async signal (sequence 0 before the first, and
+    // always 0 in synchronous mode)
+    AsyncSignal PollSignal() const {
+        return asyncPipeline ? asyncPipeline->Latest() : AsyncSignal();
+    }
+    
+    // Bars queued in async mode so far; a polled signal with this sequence
+    // is current
+    std::uint64_t SubmittedBars() const {
+        return asyncPipeline ? asyncPipeline->Submitted() : 0;
+    }
+    
+    // Intrabar refresh for IntrabarOrderGeneration: the signal as if the
+    // forming bar closed at `price`. The tick is a provisional last
+    // element of the windows; the rolling statistics are advanced on
+    // copies, so the windows themselves only move when AnalyzeBar closes
+    // the bar. The terminal distribution (simulated or analytic) is
+    // reused while the price stays within tickEpsilon of the last
+    // evaluated tick, which keeps tick-rate calls to an O(1) statistics
+    // update plus a two-contract Black-Scholes pricing.
+    int UpdateTick(double price, double& buySignal, double& sellSignal, double& confidence) {
+        BSTS_PERF_SPAN(perfStats, PerfStage::Tick);
+        if (asyncPipeline) {
+            UpdatePosition(price);
+            return LatestSignal(buySignal, sellSignal, confidence);
+        }
+        BSTS_EXPECT_NO_ALLOCATIONS("warm UpdateTick", signalPathWarm);
+        
+        buySignal = 0.0;
+        sellSignal = 0.0;
+        confidence = 0.0;
+        if (priceHistory.Empty() || !(price > 0.0) ||
+            std::min(priceHistory.Size() + 1, priceHistory.Capacity()) < WarmupBars()) {
             return 0;
         }
         
-        // Calculate current volatility
-        double currentVolatility = CalculateVolatility();
-        volatilityHistory.push_back(currentVolatility);
+        // Provisional return statistics with the forming bar's return
+        double tickReturn = std::log(price / priceHistory.Back());
+        RollingStatistics tickReturnStats = returnStats;
+        RollingStatistics tickDriftStats = driftStats;
+        SlideReturnStatistics(tickReturnStats, tickDriftStats, tickReturn);
         
-        // Keep volatility history within bounds
-        if (volatilityHistory.size() > lookbackPeriod) {
-            volatilityHistory.erase(volatilityHistory.begin());
+        // The forming bar's range is unknown until it closes, so the range
+        // estimators use the closed bars
+        double volatility = RangeEstimator() ? CalculateVolatility() : AnnualizedVolatility(tickReturnStats);
+        double drift = AnnualizedDrift(tickDriftStats, std::min(returns.Size() + 1, returns.Capacity()));
+        
+        if (!tickEvaluation.valid || std::abs(price - tickEvaluation.price) > tickEpsilon * tickEvaluation.price) {
+            BSTS_PERF_SPAN(perfStats, PerfStage::Simulation);
+            tickEvaluation.distribution = HorizonDistribution(price, drift, volatility, StreamUse::Tick);
+            tickEvaluation.price = price;
+            tickEvaluation.valid = true;
         }
         
-        // Generate trading signals using Black-Scholes and Monte Carlo
-        auto signal = GenerateTradingSignal(close, currentVolatility);
+        // The probabilities are relative to the spot; the mean scales with it
+        TerminalDistribution distribution = tickEvaluation.distribution;
+        double scale = price / tickEvaluation.price;
+        distribution.meanPrice *= scale;
+        distribution.meanPriceStdError *= scale;
         
+        TradingSignal signal = SignalFromDistribution(price, volatility, distribution);
         buySignal = signal.buyStrength;
         sellSignal = signal.sellStrength;
         confidence = signal.confidence;
+        UpdatePosition(price);
+        return signal.action;
+    }
+    
+    // Portfolio bar close (PortfolioEngine) in three phases with the same
+    // results as AnalyzeBar on the same bar: BeginBatchBar ingests the bar
+    // and prepares the Monte Carlo run, returning its chunk count (0 when
+    // there is no signal yet, or under the analytic and barrier engines or
+    // Sobol); RunBatchChunk(chunk) simulates one chunk and may run on any
+    // thread, concurrently with other chunks; FinishBatchBar reduces the
+    // chunks and emits the signal. The latency stages record history,
+    // volatility, pricing and position only.
+    std::size_t BeginBatchBar(double open, double high, double low, double close) {
+        Synchronize();
+        BSTS_EXPECT_NO_ALLOCATIONS("warm BeginBatchBar", signalPathWarm);
+        markPrice = close;
+        batchBar = BatchBar();
+        batchBar.close = close;
+        batchBar.volatility = IngestBar(open, high, low, close);
+        if (priceHistory.Size() < WarmupBars()) return 0;
         
-        // Update position tracking
-        UpdatePosition(close);
+        batchBar.signal = true;
+        batchBar.drift = CalculateExpectedReturn();
+        batchBar.cacheable = SignalCell(close, batchBar.volatility, batchBar.drift, batchBar.cell);
+        if (batchBar.cacheable) {
+            if (const TradingSignal* cached = FindCachedSignal(batchBar.cell)) {
+                batchBar.cached = true;
+                batchBar.cachedSignal = *cached;
+                return 0;
+            }
+        }
+        if (Engine() == SimulationEngine::Analytic || Engine() == SimulationEngine::Barrier ||
+            varianceReduction == VarianceReduction::Sobol) {
+            return 0;
+        }
+        batchBar.simulated = true;
+        batchBar.parameters = PathParameters(close, batchBar.drift, batchBar.volatility, kSignalHorizonDays,
+                                             SimulationStream(StreamUse::BarClose));
+        batchBar.reduction = ThresholdReduction(close);
+        return PrepareChunks(batchBar.parameters, batchBar.reduction);
+    }
+    
+    // Close-only batches carry no range, so an instance on a range
+    // estimator refuses the bar (it is not ingested and FinishBatchBar
+    // reports no signal) rather than silently degrading its estimate
+    std::size_t BeginBatchBar(double close) {
+        if (RangeEstimator()) {
+            batchBar = BatchBar();
+            return 0;
+        }
+        return BeginBatchBar(close, close, close, close);
+    }
+    
+    void RunBatchChunk(std::size_t chunk) {
+        SimulateChunk(batchBar.parameters, batchBar.reduction, chunk);
+    }
+    
+    int FinishBatchBar(double& buySignal, double& sellSignal, double& confidence) {
+        BSTS_EXPECT_NO_ALLOCATIONS("warm FinishBatchBar", signalPathWarm);
+        if (!batchBar.signal) {
+            buySignal = 0.0;
+            sellSignal = 0.0;
+            confidence = 0.0;
+            return 0;
+        }
         
-        return signal.action; // 1 = Buy, -1 = Sell, 0 = Hold
+        double close = batchBar.close;
+        TradingSignal signal = batchBar.cachedSignal;
+        if (!batchBar.cached) {
+            TerminalDistribution distribution = batchBar.simulated
+                ? MonteCarloEstimate(SumChunks(), close, batchBar.drift, kSignalHorizonDays)
+                : HorizonDistribution(close, batchBar.drift, batchBar.volatility, StreamUse::BarClose);
+            signal = SignalFromDistribution(close, batchBar.volatility, distribution);
+            if (batchBar.cacheable) signalCache.Insert(batchBar.cell, signal);
+        }
+        buySignal = signal.buyStrength;
+        sellSignal = signal.sellStrength;
+        confidence = signal.confidence;
+        {
+            BSTS_PERF_SPAN(perfStats, PerfStage::Position);
+            UpdatePosition(close);
+        }
+#if BSTS_CHECK_ALLOCATIONS
+        signalPathWarm = true;
+#endif
+        return signal.action;
+    }
+    
+    // Chart warm-up: feed a block of closes (oldest first) in one pass.
+    // Windows and rolling statistics end up exactly as if every close had
+    // gone through AnalyzeBar, but only the last signalBars closes run the
+    // simulation. Their results are written to the optional output arrays
+    // (signalBars entries each, oldest first). Returns the bars consumed.
+    int LoadHistory(const double* closes, int count, int signalBars = 0,
+                    int* actions = nullptr, double* buySignals = nullptr,
+                    double* sellSignals = nullptr, double* confidences = nullptr) {
+        if (!closes || count <= 0) return 0;
+        return LoadHistory(BarSeries::FromCloses(closes, count), signalBars, actions, buySignals,
+                           sellSignals, confidences);
+    }
+    
+    // The same from full bars, whose ranges feed the range estimators
+    int LoadHistory(const BarSeries& bars, int signalBars = 0,
+                    int* actions = nullptr, double* buySignals = nullptr,
+                    double* sellSignals = nullptr, double* confidences = nullptr) {
+        int count = static_cast<int>(bars.count);
+        if (!bars.open || !bars.high || !bars.low || !bars.close || count <= 0) return 0;
+        Synchronize();
+        signalBars = std::min(std::max(signalBars, 0), count);
+        
+        int warmupBars = count - signalBars;
+        for (int i = 0; i < warmupBars; ++i) {
+            IngestBar(bars.open[i], bars.high[i], bars.low[i], bars.close[i]);
+        }
+        if (warmupBars > 0) markPrice = bars.close[warmupBars - 1];
+        
+        for (int i = 0; i < signalBars; ++i) {
+            int bar = warmupBars + i;
+            double buySignal, sellSignal, confidence;
+            int action = AnalyzeBar(bars.open[bar], bars.high[bar], bars.low[bar], bars.close[bar],
+                                    bars.volume ? bars.volume[bar] : 0.0, bar + 1,
+                                    buySignal, sellSignal, confidence);
+            if (actions) actions[i] = action;
+            if (buySignals) buySignals[i] = buySignal;
+            if (sellSignals) sellSignals[i] = sellSignal;
+            if (confidences) confidences[i] = confidence;
+        }
+        return count;
+    }
+    
+    // Snapshot for a state file (StateFile.h): the windows, the return and
+    // range accumulators, the random stream and the position, tagged with the
+    // caller's key and `stamp` for the last close
+    void SaveState(StateFileWriter& writer, std::uint64_t key, double stamp) const {
+        Synchronize();
+        EngineStateRecord record = {};
+        record.key = key;
+        record.stamp = stamp;
+        record.lookbackPeriod = static_cast<std::uint32_t>(lookbackPeriod);
+        record.returnStats = returnStats.Save();
+        record.driftStats = driftStats.Save();
+        record.seed = simulationSeed;
+        record.stream = barsIngested;
+        record.markPrice = markPrice;
+        record.entryPrice = currentPosition.entryPrice;
+        record.unrealizedPnL = currentPosition.unrealizedPnL;
+        record.quantity = currentPosition.quantity;
+        record.isLong = currentPosition.isLong ? 1 : 0;
+        record.volatilityEstimator = static_cast<std::uint32_t>(rangeVolatility.Estimator());
+        rangeVolatility.Save(record.overnightStats, record.bodyStats, record.rangeTermStats);
+        writer.Add(record, priceHistory, volatilityHistory, returns, rangeVolatility.Bars());
+    }
+    
+    // Continue from a snapshot: with the same settings, later bars get the
+    // signals the saving instance would have given them. The signal cache
+    // starts empty. A range window saved under another estimator is kept
+    // and its accumulators rebuilt; under close-to-close it is dropped.
+    // False, with nothing changed, when the snapshot's lookback differs
+    // from this instance's or its windows are inconsistent.
+    bool LoadState(const EngineStateView& state) {
+        Synchronize();
+        const EngineStateRecord& record = *state.record;
+        std::size_t driftCount = std::min<std::size_t>(std::min(kDriftWindow, returns.Capacity()), record.returnCount);
+        if (record.lookbackPeriod != static_cast<std::uint32_t>(lookbackPeriod) ||
+            record.priceCount > priceHistory.Capacity() || record.volatilityCount > volatilityHistory.Capacity() ||
+            record.returnCount > returns.Capacity() || record.returnStats.count != record.returnCount ||
+            record.driftStats.count != driftCount ||
+            record.rangeCount > static_cast<std::uint32_t>(lookbackPeriod)) {
+            return false;
+        }
+        
+        priceHistory.Clear();
+        volatilityHistory.Clear();
+        returns.Clear();
+        for (std::uint32_t i = 0; i < record.priceCount; ++i) priceHistory.Push(state.prices[i]);
+        for (std::uint32_t i = 0; i < record.volatilityCount; ++i) volatilityHistory.Push(state.volatilities[i]);
+        for (std::uint32_t i = 0; i < record.returnCount; ++i) returns.Push(state.returns[i]);
+        returnStats.Restore(record.returnStats);
+        driftStats.Restore(record.driftStats);
+        bool sameEstimator = record.volatilityEstimator == static_cast<std::uint32_t>(rangeVolatility.Estimator());
+        if (RangeEstimator() && sameEstimator) {
+            rangeVolatility.Restore(state.ranges, record.rangeCount, record.overnightStats, record.bodyStats,
+                                    record.rangeTermStats);
+        } else if (RangeEstimator()) {
+            rangeVolatility.ResyncAfterRestore(state.ranges, record.rangeCount);
+        }
+        
+        simulationSeed = record.seed;
+        barsIngested = record.stream;
+        markPrice = record.markPrice;
+        currentPosition.entryPrice = record.entryPrice;
+        currentPosition.unrealizedPnL = record.unrealizedPnL;
+        currentPosition.quantity = record.quantity;
+        currentPosition.isLong = record.isLong != 0;
+        InvalidateEvaluations();
+        return true;
+    }
+    
+    // Sweep scoring for RunParameterSweep / RunWalkForward: a fresh
+    // instance with the given parameters and a fixed seed warms up on the
+    // lookback before `begin`, then RunBacktest trades bars [begin, end)
+    static BacktestMetrics EvaluateParameters(const SweepParameters& parameters, const BarSeries& bars,
+                                              std::size_t begin, std::size_t end) {
+        BasicBlackScholesTradeStation algo;
+        algo.SetRiskFreeRate(parameters.riskFreeRate);
+        algo.SetMaxPositionSize(parameters.maxPositionSize);
+        algo.SetStopLoss(parameters.stopLossPercent);
+        algo.SetTakeProfit(parameters.takeProfitPercent);
+        algo.SetLookbackPeriod(parameters.lookbackPeriod);
+        algo.SetMonteCarloSimulations(parameters.monteCarloSimulations);
+        algo.SetRandomSeed(kSweepSeed);
+        
+        begin = std::min(begin, bars.count);
+        std::size_t warmupBegin = begin - std::min<std::size_t>(begin, algo.lookbackPeriod);
+        algo.LoadHistory(bars.close + warmupBegin, static_cast<int>(begin - warmupBegin));
+        
+        BacktestSettings settings;
+        settings.maxPositionSize = parameters.maxPositionSize;
+        settings.minConfidence = parameters.minConfidence;
+        settings.minSignalStrength = parameters.minSignalStrength;
+        return RunBacktest(algo, bars, settings, begin, end).metrics;
     }
     
 private:
-    struct TradingSignal {
-        double buyStrength = 0.0;
-        double sellStrength = 0.0;
-        double confidence = 0.0;
-        int action = 0; // 1 = Buy, -1 = Sell, 0 = Hold
-    };
+    // EstimateTerminalDistribution without the wait, for the bar paths
+    // (which may be the async worker itself)
+    TerminalDistribution HorizonDistribution(double currentPrice, double drift, double volatility,
+                                             StreamUse use) {
+        if (Engine() == SimulationEngine::Analytic) {
+            return AnalyticTerminalDistribution(currentPrice, drift, volatility, kSignalHorizonDays);
+        }
+        if (Engine() == SimulationEngine::Barrier) {
+            return BarrierDistribution(currentPrice, drift, volatility, kSignalHorizonDays, SimulationStream(use));
+        }
+        return SimulatedTerminalDistribution(currentPrice, drift, volatility, kSignalHorizonDays,
+                                             SimulationStream(use));
+    }
     
-    void UpdatePriceHistory(double price) {
-        priceHistory.push_back(price);
+    // The bar through the windows and, once enough bars are in, the
+    // signal (run by AnalyzeBar, or by the async worker)
+    TradingSignal AnalyzeClose(double open, double high, double low, double close) {
+        // Update price history
+        double currentVolatility = IngestBar(open, high, low, close);
+        
+        // Need minimum data for analysis
+        if (priceHistory.Size() < WarmupBars()) return TradingSignal();
         
-        // Maintain lookback period
-        if (priceHistory.size() > lookbackPeriod) {
-            priceHistory.erase(priceHistory.begin());
+        // Generate trading signals using Black-Scholes and Monte Carlo
+        TradingSignal signal = GenerateTradingSignal(close, currentVolatility);
+#if BSTS_CHECK_ALLOCATIONS
+        signalPathWarm = true;
+#endif
+        return signal;
+    }
+    
+    int LatestSignal(double& buySignal, double& sellSignal, double& confidence,
+                     std::uint64_t* sequence = nullptr) const {
+        AsyncSignal latest = asyncPipeline->Latest();
+        if (sequence) *sequence = latest.sequence;
+        buySignal = latest.buySignal;
+        sellSignal = latest.sellSignal;
+        confidence = latest.confidence;
+        return latest.action;
+    }
+    
+    // Wait for the async worker to finish the queued bars, after which the
+    // windows and settings may be used from this thread
+    void Synchronize() const {
+        if (asyncPipeline) asyncPipeline->Drain();
+    }
+    
+    // Advance the windows by one bar (close-only callers pass the close
+    // four times); returns the current volatility (pushed to
+    // volatilityHistory once enough bars are in)
+    double IngestBar(double open, double high, double low, double close) {
+        tickEvaluation.valid = false;   // The forming bar is now a new one
+        ++barsIngested;
+        {
+            BSTS_PERF_SPAN(perfStats, PerfStage::History);
+            UpdatePriceHistory(open, high, low, close);
         }
+        if (priceHistory.Size() < WarmupBars()) return 0.0;
         
-        // Calculate returns if we have enough data
-        if (priceHistory.size() >= 2) {
-            double dailyReturn = std::log(price / priceHistory[priceHistory.size() - 2]);
-            returns.push_back(dailyReturn);
+        BSTS_PERF_SPAN(perfStats, PerfStage::Volatility);
+        double currentVolatility = CalculateVolatility();
+        volatilityHistory.Push(currentVolatility);
+        return currentVolatility;
+    }
+    
+    void UpdatePriceHistory(double open, double high, double low, double price) {
+        // Calculate the return against the previous close before the
+        // window can overwrite it
+        if (!priceHistory.Empty()) {
+            if (RangeEstimator()) rangeVolatility.Push(MakeBarRange(priceHistory.Back(), open, high, low, price));
+            double dailyReturn = std::log(price / priceHistory.Back());
+            UpdateReturnStatistics(dailyReturn);
+            returns.Push(dailyReturn);
             
-            if (returns.size() > lookbackPeriod) {
-                returns.erase(returns.begin());
+            // Periodically rebuild to bound accumulated rounding error
+            if (returnStats.UpdatesSinceRebuild() >= kStatisticsResyncInterval) {
+                ResyncReturnStatistics();
             }
         }
+        
+        // Full windows drop their oldest bar in O(1)
+        priceHistory.Push(price);
     }
     
-    double CalculateVolatility() {
-        if (returns.size() < 10) return 0.2; // Default volatility
-        
-        // Calculate mean return
-        double meanReturn = 0.0;
-        for (double ret : returns) {
-            meanReturn += ret;
+    // Slide both return windows by one bar. Called before the new return
+    // is pushed, so the values about to leave are still readable.
+    void UpdateReturnStatistics(double dailyReturn) {
+        SlideReturnStatistics(returnStats, driftStats, dailyReturn);
+    }
+    
+    // The same slide applied to the given accumulators (UpdateTick passes
+    // copies for a provisional bar)
+    void SlideReturnStatistics(RollingStatistics& whole, RollingStatistics& recent, double dailyReturn) const {
+        if (returns.Full()) {
+            whole.Replace(returns.Front(), dailyReturn);
+        } else {
+            whole.Add(dailyReturn);
         }
-        meanReturn /= returns.size();
         
-        // Calculate variance
-        double variance = 0.0;
-        for (double ret : returns) {
-            variance += std::pow(ret - meanReturn, 2);
+        // Short lookbacks cap the drift window at the returns window
+        std::size_t driftWindow = std::min(kDriftWindow, returns.Capacity());
+        if (returns.Size() >= driftWindow) {
+            recent.Replace(returns[returns.Size() - driftWindow], dailyReturn);
+        } else {
+            recent.Add(dailyReturn);
         }
-        variance /= (returns.size() - 1);
+    }
+    
+    // Rebuild both accumulators exactly from the returns window
+    void ResyncReturnStatistics() {
+        returnStats.Rebuild(returns, 0, returns.Size());
+        
+        std::size_t driftCount = std::min(kDriftWindow, returns.Size());
+        driftStats.Rebuild(returns, returns.Size() - driftCount, driftCount);
+    }
+    
+    // Range estimate once its window has two bars, else close-to-close
+    double CalculateVolatility() const {
+        double variance;
+        if (RangeEstimator() && rangeVolatility.DailyVariance(variance)) return std::sqrt(variance * 252);
+        return AnnualizedVolatility(returnStats);
+    }
+    
+    bool RangeEstimator() const { return rangeVolatility.Capacity() > 0; }
+    std::size_t WarmupBars() const { return RangeEstimator() ? kRangeWarmupBars : kWarmupBars; }
+    
+    static double AnnualizedVolatility(const RollingStatistics& stats) {
+        if (stats.Count() < 10) return 0.2; // Default volatility
         
         // Annualized volatility
-        return std::sqrt(variance * 252);
+        return std::sqrt(stats.Variance() * 252);
+    }
+    
+    // Engine in use; a constant under a fixed-engine policy
+    SimulationEngine Engine() const {
+        return Policy::kFixedEngine ? Policy::kEngine : simulationEngine;
     }
     
-    double BlackScholesCall(double S, double K, double T, double r, double sigma) {
-        if (T <= 0 || sigma <= 0) return std::max(S - K, 0.0);
+    simd::OptionChainMarket Market(double spot, double volatility) const {
+        simd::OptionChainMarket market;
+        market.spot = spot;
+        market.rate = riskFreeRate;
+        market.volatility = volatility;
+        return market;
+    }
+    
+    // 53 bits, so the seed survives a round trip through an EasyLanguage
+    // double (GetRandomSeed / SetRandomSeed)
+    static std::uint64_t RandomSeed() {
+        std::random_device device;
+        return ((static_cast<std::uint64_t>(device()) << 32) | device()) & ((std::uint64_t(1) << 53) - 1);
+    }
+    
+    // Per-chunk partial sums for MonteCarloSimulation, reserved whenever
+    // the path count changes so bars never allocate
+    void ReserveSimulationBuffer() {
+        std::size_t tiles = (monteCarloSimulations + simd::kGbmTilePaths - 1) / simd::kGbmTilePaths;
+        chunkSums.reserve((tiles + kParallelChunkTiles - 1) / kParallelChunkTiles);
+        barrierChunkSums.reserve((tiles + kParallelChunkTiles - 1) / kParallelChunkTiles);
+    }
+    
+    simd::GbmTileParameters PathParameters(double currentPrice, double drift, double volatility, int days,
+                                           std::uint64_t stream) {
+        double timeStep = 1.0 / 252.0; // Daily time step
         
-        double d1 = (std::log(S / K) + (r + 0.5 * sigma * sigma) * T) / (sigma * std::sqrt(T));
-        double d2 = d1 - sigma * std::sqrt(T);
+        // Geometric Brownian Motion in log space, advanced 16 paths at a time
+        // by the SIMD batch kernel
+        simd::GbmTileParameters parameters;
+        parameters.spot = currentPrice;
+        parameters.seed = simulationSeed;
+        parameters.stream = stream;
         
-        double callPrice = S * NormalCDF(d1) - K * std::exp(-r * T) * NormalCDF(d2);
-        return std::max(callPrice, 0.0);
+        if (Engine() == SimulationEngine::TerminalSampling) {
+            // GBM log-returns add up, so the terminal price has the exact
+            // closed form S*exp((mu - sigma^2/2)T + sigma*sqrt(T)*Z): one draw
+            // and one exp per path instead of one per day
+            double horizon = days * timeStep;
+            parameters.stepDrift = (drift - 0.5 * volatility * volatility) * horizon;
+            parameters.stepVolatility = volatility * std::sqrt(horizon);
+            parameters.steps = 1;
+        } else {
+            parameters.stepDrift = (drift - 0.5 * volatility * volatility) * timeStep;
+            parameters.stepVolatility = volatility * std::sqrt(timeStep);
+            parameters.steps = days;
+        }
+        parameters.antithetic = varianceReduction == VarianceReduction::Antithetic;
+        return parameters;
+    }
+    
+    // Sums over the simulated terminal prices. The kernel folds each path
+    // into register accumulators as it is generated, so no price array is
+    // written and memory traffic does not grow with the path count. Paths
+    // come in whole tiles; surplus paths are dropped (kept for antithetic
+    // runs, so every path keeps its mirror). Tiles are split across the
+    // worker pool in fixed chunks, each with its own partial sums added in
+    // chunk order, and each tile's paths depend only on (seed, stream, tile
+    // index), so the results are bit-identical for any thread count.
+    simd::TerminalPriceSums MonteCarloSimulation(const simd::GbmTileParameters& parameters,
+                                                 simd::TerminalReduction reduction) {
+        std::size_t chunks = PrepareChunks(parameters, reduction);
+        SharedThreadPool().ParallelFor(chunks, 1, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t chunk = begin; chunk < end; ++chunk) SimulateChunk(parameters, reduction, chunk);
+        });
+        return SumChunks();
+    }
+    
+    // Clear the chunk sums for a run and set its path limit; returns the
+    // chunk count
+    std::size_t PrepareChunks(const simd::GbmTileParameters& parameters, simd::TerminalReduction& reduction) {
+        std::size_t tiles = (monteCarloSimulations + simd::kGbmTilePaths - 1) / simd::kGbmTilePaths;
+        reduction.pathLimit = parameters.antithetic ? tiles * simd::kGbmTilePaths : monteCarloSimulations;
+        chunkSums.assign((tiles + kParallelChunkTiles - 1) / kParallelChunkTiles, simd::TerminalPriceSums());
+        return chunkSums.size();
+    }
+    
+    // Tiles [chunk * kParallelChunkTiles, ...) into that chunk's sums; chunks
+    // may run on any threads
+    void SimulateChunk(const simd::GbmTileParameters& parameters, const simd::TerminalReduction& reduction,
+                       std::size_t chunk) {
+        std::size_t tiles = (reduction.pathLimit + simd::kGbmTilePaths - 1) / simd::kGbmTilePaths;
+        std::size_t begin = chunk * kParallelChunkTiles;
+        std::size_t count = std::min(tiles - begin, kParallelChunkTiles);
+        if (kKernelSampling) {
+            simd::ReduceGbmTiles(parameters, reduction, begin, count, chunkSums[chunk]);
+        } else {
+            SampleTiles(parameters, reduction, begin, count, chunkSums[chunk]);
+        }
     }
     
-    double BlackScholesPut(double S, double K, double T, double r, double sigma) {
-        if (T <= 0 || sigma <= 0) return std::max(K - S, 0.0);
+    // ReduceGbmTiles on the policy's generator, sampler and arithmetic, with
+    // the kernel's layout: 16-path tiles, antithetic partners 8 paths apart,
+    // paths past the limit left out. The generator is keyed by (seed,
+    // stream, first tile), so a chunk's paths are the same on any thread.
+    static void SampleTiles(const simd::GbmTileParameters& parameters, const simd::TerminalReduction& reduction,
+                            std::size_t firstTile, std::size_t tileCount, simd::TerminalPriceSums& sums) {
+        const std::size_t half = simd::kGbmTilePaths / 2;
+        const Real stepDrift = static_cast<Real>(parameters.stepDrift);
+        const Real stepVolatility = static_cast<Real>(parameters.stepVolatility);
+        NormalSampler normal(Rng(MixKey(parameters.seed, parameters.stream, firstTile)));
         
-        double d1 = (std::log(S / K) + (r + 0.5 * sigma * sigma) * T) / (sigma * std::sqrt(T));
-        double d2 = d1 - sigma * std::sqrt(T);
+        for (std::size_t tile = firstTile; tile < firstTile + tileCount; ++tile) {
+            std::uint64_t firstPath = tile * simd::kGbmTilePaths;
+            if (firstPath >= reduction.pathLimit) break;
+            std::size_t paths = static_cast<std::size_t>(
+                std::min<std::uint64_t>(simd::kGbmTilePaths, reduction.pathLimit - firstPath));
+            
+            double prices[simd::kGbmTilePaths];
+            for (std::size_t i = 0; i < (parameters.antithetic ? half : paths); ++i) {
+                Real logReturn = 0, mirror = 0;
+                for (int step = 0; step < parameters.steps; ++step) {
+                    Real shock = stepVolatility * static_cast<Real>(normal());
+                    logReturn += stepDrift + shock;
+                    mirror += stepDrift - shock;
+                }
+                prices[i] = parameters.spot * static_cast<double>(std::exp(logReturn));
+                if (parameters.antithetic) prices[half + i] = parameters.spot * static_cast<double>(std::exp(mirror));
+            }
+            
+            for (std::size_t i = 0; i < paths; ++i) {
+                double deviation = prices[i] - parameters.spot;
+                bool isProfit = prices[i] > reduction.profitLevel;
+                bool isLoss = prices[i] < reduction.lossLevel;
+                sums.paths += 1.0;
+                sums.price += deviation;
+                sums.priceSquared += deviation * deviation;
+                sums.profit += isProfit;
+                sums.loss += isLoss;
+                sums.priceProfit += isProfit ? deviation : 0.0;
+                sums.priceLoss += isLoss ? deviation : 0.0;
+            }
+            if (parameters.antithetic) {
+                for (std::size_t i = 0; i < half; ++i) {
+                    double deviation = 0.5 * (prices[i] + prices[half + i]) - parameters.spot;
+                    double profitShare = 0.5 * ((prices[i] > reduction.profitLevel) +
+                                                (prices[half + i] > reduction.profitLevel));
+                    double lossShare = 0.5 * ((prices[i] < reduction.lossLevel) +
+                                              (prices[half + i] < reduction.lossLevel));
+                    sums.pairs += 1.0;
+                    sums.pairPrice += deviation;
+                    sums.pairPriceSquared += deviation * deviation;
+                    sums.pairProfit += profitShare;
+                    sums.pairProfitSquared += profitShare * profitShare;
+                    sums.pairLoss += lossShare;
+                    sums.pairLossSquared += lossShare * lossShare;
+                }
+            }
+        }
+    }
+    
+    simd::TerminalPriceSums SumChunks() const {
+        simd::TerminalPriceSums sums;
+        for (const simd::TerminalPriceSums& chunk : chunkSums) sums.Add(chunk);
+        return sums;
+    }
+    
+    // Sums for kSobolReplicates independent scrambles of the same point
+    // count, one per replicate. With a Brownian-bridge construction the
+    // terminal value is driven by the first coordinate alone, so stepped
+    // and terminal engines share it.
+    void SobolSimulation(const simd::GbmTileParameters& parameters, const simd::TerminalReduction& reduction,
+                         simd::TerminalPriceSums* replicates) const {
+        static const SobolSequence sequence;
         
-        double putPrice = K * std::exp(-r * T) * NormalCDF(-d2) - S * NormalCDF(-d1);
-        return std::max(putPrice, 0.0);
+        std::size_t pointsPerReplicate = (monteCarloSimulations + kSobolReplicates - 1) / kSobolReplicates;
+        double totalDrift = parameters.stepDrift * parameters.steps;
+        double totalVolatility = parameters.stepVolatility * std::sqrt(static_cast<double>(parameters.steps));
+        
+        SharedThreadPool().ParallelFor(kSobolReplicates, 1,
+            [&](std::size_t begin, std::size_t end) {
+                for (std::size_t replicate = begin; replicate < end; ++replicate) {
+                    std::uint32_t scramble = ScrambleSeed(parameters.seed, parameters.stream, replicate);
+                    simd::TerminalPriceSums sums;
+                    for (std::size_t i = 0; i < pointsPerReplicate; ++i) {
+                        double z = InverseNormalCDF(sequence.Uniform(static_cast<std::uint32_t>(i), 0, scramble));
+                        double price = parameters.spot * std::exp(totalDrift + totalVolatility * z);
+                        double deviation = price - parameters.spot;
+                        sums.price += deviation;
+                        sums.priceSquared += deviation * deviation;
+                        sums.profit += price > reduction.profitLevel;
+                        sums.loss += price < reduction.lossLevel;
+                    }
+                    sums.paths = static_cast<double>(pointsPerReplicate);
+                    replicates[replicate] = sums;
+                }
+            });
+    }
+    
+    // SplitMix64 finalizer over (seed, stream, index)
+    static std::uint64_t MixKey(std::uint64_t seed, std::uint64_t stream, std::uint64_t index) {
+        std::uint64_t z = seed ^ (stream * 0x9E3779B97F4A7C15ULL) ^ (index * 0xD1B54A32D192ED03ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+    
+    static std::uint32_t ScrambleSeed(std::uint64_t seed, std::uint64_t stream, std::uint64_t replicate) {
+        return static_cast<std::uint32_t>(MixKey(seed, stream, replicate));
     }
     
-    double NormalCDF(double x) {
-        return 0.5 * (1.0 + std::erf(x / std::sqrt(2.0)));
+    double CalculateExpectedReturn() const {
+        return AnnualizedDrift(driftStats, returns.Size());
     }
     
-    double SimulatePriceWithBrownianMotion(double currentPrice, double drift, 
-                                          double volatility, double timeStep) {
-        double randomShock = normalDist(generator);
+    static double AnnualizedDrift(const RollingStatistics& stats, std::size_t returnCount) {
+        if (returnCount < kDriftWindow) return 0.0;
         
-        // Geometric Brownian Motion
-        double logReturn = (drift - 0.5 * volatility * volatility) * timeStep + 
-                          volatility * std::sqrt(timeStep) * randomShock;
+        // Recent average return (last 21 days), maintained incrementally
+        return stats.Mean() * 252; // Annualized
+    }
+    
+    // Sample the terminal distribution with MonteCarloSimulation
+    TerminalDistribution SimulatedTerminalDistribution(double currentPrice, double drift,
+                                                       double volatility, int days, std::uint64_t stream) {
+        simd::GbmTileParameters parameters = PathParameters(currentPrice, drift, volatility, days, stream);
+        simd::TerminalReduction reduction = ThresholdReduction(currentPrice);
         
-        return currentPrice * std::exp(logReturn);
+        if (varianceReduction == VarianceReduction::Sobol) {
+            simd::TerminalPriceSums replicates[kSobolReplicates];
+            SobolSimulation(parameters, reduction, replicates);
+            TerminalDistribution distribution = ReplicatedEstimate(replicates, kSobolReplicates, currentPrice);
+            distribution.confidence = std::min(1.0, distribution.effectivePaths / 1000.0);
+            return distribution;
+        }
+        return MonteCarloEstimate(MonteCarloSimulation(parameters, reduction), currentPrice, drift, days);
     }
     
-    std::vector<double> MonteCarloSimulation(double currentPrice, double drift, 
-                                           double volatility, int days) {
-        std::vector<double> finalPrices;
-        finalPrices.reserve(monteCarloSimulations);
+    // First passage through the stop-loss and take-profit levels of a long
+    // entered at currentPrice, continuously monitored like resting exit
+    // orders. Steps are kBarrierStepDays long with the Brownian-bridge
+    // crossing test between them, and a tile stops once all its paths have
+    // exited, so a run costs well under the daily path-stepping loop.
+    // Paths are independent whatever the variance reduction, and split
+    // across the pool in the fixed chunks of MonteCarloSimulation.
+    TerminalDistribution BarrierDistribution(double currentPrice, double drift, double volatility, int days,
+                                             std::uint64_t stream) {
+        int steps = std::max((days + kBarrierStepDays - 1) / kBarrierStepDays, 1);
+        double stepTime = days / 252.0 / steps;
+        simd::GbmTileParameters parameters;
+        parameters.spot = currentPrice;
+        parameters.seed = simulationSeed;
+        parameters.stream = stream;
+        parameters.stepDrift = (drift - 0.5 * volatility * volatility) * stepTime;
+        parameters.stepVolatility = volatility * std::sqrt(stepTime);
+        parameters.steps = steps;
         
-        double timeStep = 1.0 / 252.0; // Daily time step
+        simd::TerminalReduction thresholds = ThresholdReduction(currentPrice);
+        simd::BarrierReduction reduction;
+        reduction.upperLevel = currentPrice * (1.0 + takeProfitPercent);
+        reduction.lowerLevel = currentPrice * std::max(1.0 - stopLossPercent, 0.0);
+        reduction.profitLevel = thresholds.profitLevel;
+        reduction.lossLevel = thresholds.lossLevel;
+        reduction.pathLimit = monteCarloSimulations;
         
-        for (int sim = 0; sim < monteCarloSimulations; ++sim) {
-            double price = currentPrice;
-            
-            // Simulate price path
-            for (int day = 0; day < days; ++day) {
-                price = SimulatePriceWithBrownianMotion(price, drift, volatility, timeStep);
+        std::size_t tiles = (monteCarloSimulations + simd::kGbmTilePaths - 1) / simd::kGbmTilePaths;
+        barrierChunkSums.assign((tiles + kParallelChunkTiles - 1) / kParallelChunkTiles, simd::BarrierSums());
+        SharedThreadPool().ParallelFor(barrierChunkSums.size(), 1, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t chunk = begin; chunk < end; ++chunk) {
+                std::size_t first = chunk * kParallelChunkTiles;
+                simd::ReduceBarrierTiles(parameters, reduction, first, std::min(tiles - first, kParallelChunkTiles),
+                                         barrierChunkSums[chunk]);
             }
-            
-            finalPrices.push_back(price);
+        });
+        simd::BarrierSums sums;
+        for (const simd::BarrierSums& chunk : barrierChunkSums) sums.Add(chunk);
+        return BarrierEstimate(sums, currentPrice, static_cast<double>(days) / steps);
+    }
+    
+    // Exit-price statistics as plain sample means, plus the hit rates and
+    // the holding time
+    static TerminalDistribution BarrierEstimate(const simd::BarrierSums& sums, double spot, double stepDays) {
+        TerminalDistribution distribution = IndependentEstimate(sums.exit, spot);
+        double n = sums.exit.paths;
+        distribution.stopLossHitProbability = sums.lowerHits / n;
+        distribution.takeProfitHitProbability = sums.upperHits / n;
+        distribution.expectedExitDays = sums.exitSteps / n * stepDays;
+        distribution.expectedExitDaysStdError =
+            std::sqrt(SampleVariance(n, sums.exitSteps, sums.exitStepsSquared) / n) * stepDays;
+        distribution.confidence = std::min(1.0, distribution.effectivePaths / 1000.0);
+        return distribution;
+    }
+    
+    static simd::TerminalReduction ThresholdReduction(double currentPrice) {
+        simd::TerminalReduction reduction;
+        reduction.profitLevel = currentPrice * kProfitThreshold;
+        reduction.lossLevel = currentPrice * kLossThreshold;
+        return reduction;
+    }
+    
+    // Distribution from pseudo-random path sums under the configured
+    // variance reduction
+    TerminalDistribution MonteCarloEstimate(const simd::TerminalPriceSums& sums, double currentPrice,
+                                            double drift, int days) const {
+        TerminalDistribution distribution;
+        switch (varianceReduction) {
+        case VarianceReduction::Antithetic:
+            distribution = AntitheticEstimate(sums, currentPrice);
+            break;
+        case VarianceReduction::ControlVariate:
+            distribution = ControlVariateEstimate(sums, currentPrice,
+                                                  currentPrice * std::exp(drift * days / 252.0));
+            break;
+        default:
+            distribution = IndependentEstimate(sums, currentPrice);
+            break;
         }
         
-        return finalPrices;
+        distribution.confidence = std::min(1.0, distribution.effectivePaths / 1000.0);
+        return distribution;
     }
     
-    double CalculateExpectedReturn() {
-        if (returns.size() < 21) return 0.0;
+    // Sample variance from a count, a sum and a sum of squares
+    static double SampleVariance(double n, double sum, double sumSquares) {
+        return n > 1.0 ? std::max(sumSquares - sum * sum / n, 0.0) / (n - 1.0) : 0.0;
+    }
+    
+    // Plain sample means; binomial standard errors for the probabilities
+    static TerminalDistribution IndependentEstimate(const simd::TerminalPriceSums& sums, double spot) {
+        TerminalDistribution distribution;
+        double n = sums.paths;
+        distribution.meanPrice = spot + sums.price / n;
+        distribution.meanPriceStdError = std::sqrt(SampleVariance(n, sums.price, sums.priceSquared) / n);
+        distribution.profitProbability = sums.profit / n;
+        distribution.lossProbability = sums.loss / n;
+        distribution.profitProbabilityStdError =
+            std::sqrt(distribution.profitProbability * (1.0 - distribution.profitProbability) / n);
+        distribution.lossProbabilityStdError =
+            std::sqrt(distribution.lossProbability * (1.0 - distribution.lossProbability) / n);
+        distribution.effectivePaths = n;
+        return distribution;
+    }
+    
+    // Each antithetic pair average is one independent sample
+    static TerminalDistribution AntitheticEstimate(const simd::TerminalPriceSums& sums, double spot) {
+        double n = sums.pairs;
+        TerminalDistribution distribution;
+        distribution.meanPrice = spot + sums.pairPrice / n;
+        distribution.profitProbability = sums.pairProfit / n;
+        distribution.lossProbability = sums.pairLoss / n;
+        SetStandardErrors(distribution, SampleVariance(n, sums.pairPrice, sums.pairPriceSquared),
+                          SampleVariance(n, sums.pairProfit, sums.pairProfitSquared),
+                          SampleVariance(n, sums.pairLoss, sums.pairLossSquared), n);
+        return distribution;
+    }
+    
+    // Regress each threshold indicator on S_T and correct by the known
+    // E[S_T]; the mean itself is then exact
+    static TerminalDistribution ControlVariateEstimate(const simd::TerminalPriceSums& sums, double spot,
+                                                       double expectedPrice) {
+        double n = sums.paths;
+        double priceMean = spot + sums.price / n;
+        double profitMean = sums.profit / n;
+        double lossMean = sums.loss / n;
+        
+        // Centered second moments from the raw sums (deviations from spot)
+        double priceVariance = std::max(sums.priceSquared - sums.price * sums.price / n, 0.0);
+        double profitCovariance = sums.priceProfit - sums.price * profitMean;
+        double lossCovariance = sums.priceLoss - sums.price * lossMean;
+        
+        TerminalDistribution distribution;
+        distribution.meanPrice = expectedPrice;
+        distribution.profitProbability = profitMean;
+        distribution.lossProbability = lossMean;
+        double profitResidual = profitMean * (1.0 - profitMean) * n;
+        double lossResidual = lossMean * (1.0 - lossMean) * n;
+        if (priceVariance > 0.0) {
+            double shift = priceMean - expectedPrice;
+            distribution.profitProbability -= profitCovariance / priceVariance * shift;
+            distribution.lossProbability -= lossCovariance / priceVariance * shift;
+            profitResidual -= profitCovariance * profitCovariance / priceVariance;
+            lossResidual -= lossCovariance * lossCovariance / priceVariance;
+        }
+        distribution.profitProbability = std::min(1.0, std::max(0.0, distribution.profitProbability));
+        distribution.lossProbability = std::min(1.0, std::max(0.0, distribution.lossProbability));
+        
+        // Residual variance with one degree of freedom spent on the slope
+        double dof = std::max(n - 2.0, 1.0);
+        distribution.profitProbabilityStdError = std::sqrt(std::max(profitResidual, 0.0) / dof / n);
+        distribution.lossProbabilityStdError = std::sqrt(std::max(lossResidual, 0.0) / dof / n);
+        distribution.effectivePaths = EffectivePaths(distribution);
+        return distribution;
+    }
+    
+    // Randomized QMC: the estimate averages the replicate means and their
+    // spread is the standard error
+    static TerminalDistribution ReplicatedEstimate(const simd::TerminalPriceSums* replicates, int count,
+                                                   double spot) {
+        RollingStatistics priceStats, profitStats, lossStats;
+        for (int replicate = 0; replicate < count; ++replicate) {
+            const simd::TerminalPriceSums& sums = replicates[replicate];
+            priceStats.Add(spot + sums.price / sums.paths);
+            profitStats.Add(sums.profit / sums.paths);
+            lossStats.Add(sums.loss / sums.paths);
+        }
+        
+        TerminalDistribution distribution;
+        distribution.meanPrice = priceStats.Mean();
+        distribution.profitProbability = profitStats.Mean();
+        distribution.lossProbability = lossStats.Mean();
+        SetStandardErrors(distribution, priceStats.Variance(), profitStats.Variance(), lossStats.Variance(), count);
+        return distribution;
+    }
+    
+    // Standard errors from the variances of `samples` independent estimates
+    static void SetStandardErrors(TerminalDistribution& distribution, double priceVariance,
+                                  double profitVariance, double lossVariance, double samples) {
+        distribution.meanPriceStdError = std::sqrt(priceVariance / samples);
+        distribution.profitProbabilityStdError = std::sqrt(profitVariance / samples);
+        distribution.lossProbabilityStdError = std::sqrt(lossVariance / samples);
+        distribution.effectivePaths = EffectivePaths(distribution);
+    }
+    
+    // p(1-p)/SE^2 for the less precise of the two probabilities
+    static double EffectivePaths(const TerminalDistribution& distribution) {
+        const double probabilities[] = {distribution.profitProbability, distribution.lossProbability};
+        const double errors[] = {distribution.profitProbabilityStdError, distribution.lossProbabilityStdError};
+        
+        double effective = std::numeric_limits<double>::infinity();
+        for (int i = 0; i < 2; ++i) {
+            double variance = probabilities[i] * (1.0 - probabilities[i]);
+            if (variance > 0.0 && errors[i] > 0.0) {
+                effective = std::min(effective, variance / (errors[i] * errors[i]));
+            }
+        }
+        return effective;
+    }
+    
+    // Under GBM ln(S_T/S) ~ N((mu - sigma^2/2)T, sigma^2 T), so the threshold
+    // probabilities are lognormal CDFs and the mean is S*exp(mu*T). Exact,
+    // so confidence is 1.
+    static TerminalDistribution AnalyticTerminalDistribution(double currentPrice, double drift,
+                                                             double volatility, int days) {
+        TerminalDistribution distribution;
+        double horizon = days / 252.0;
+        double meanLogReturn = (drift - 0.5 * volatility * volatility) * horizon;
+        double logReturnStdDev = volatility * std::sqrt(horizon);
         
-        // Calculate recent average return (last 21 days)
-        double totalReturn = 0.0;
-        int count = std::min(21, static_cast<int>(returns.size()));
+        distribution.meanPrice = currentPrice * std::exp(drift * horizon);
+        distribution.confidence = 1.0;
+        distribution.effectivePaths = std::numeric_limits<double>::infinity();
         
-        for (int i = returns.size() - count; i < returns.size(); ++i) {
-            totalReturn += returns[i];
+        if (logReturnStdDev <= 0.0) {
+            // Degenerate (zero volatility): the terminal price is deterministic
+            double terminalPrice = currentPrice * std::exp(meanLogReturn);
+            distribution.profitProbability = terminalPrice > currentPrice * kProfitThreshold ? 1.0 : 0.0;
+            distribution.lossProbability = terminalPrice < currentPrice * kLossThreshold ? 1.0 : 0.0;
+            return distribution;
         }
         
-        return (totalReturn / count) * 252; // Annualized
+        distribution.profitProbability =
+            NormalCDF<Policy::kCdfAccuracy>((meanLogReturn - std::log(kProfitThreshold)) / logReturnStdDev);
+        distribution.lossProbability =
+            NormalCDF<Policy::kCdfAccuracy>((std::log(kLossThreshold) - meanLogReturn) / logReturnStdDev);
+        return distribution;
     }
     
     TradingSignal GenerateTradingSignal(double currentPrice, double volatility) {
         TradingSignal signal;
         
-        if (priceHistory.size() < 30) return signal;
+        if (priceHistory.Size() < WarmupBars()) return signal;
         
         // Calculate expected drift
         double drift = CalculateExpectedReturn();
         
-        // Monte Carlo simulation for 21-day price prediction
-        auto simulatedPrices = MonteCarloSimulation(currentPrice, drift, volatility, 21);
-        
-        // Calculate statistics from simulation
-        double meanPrice = 0.0;
-        for (double price : simulatedPrices) {
-            meanPrice += price;
+        // A bar in a cached cell reuses that signal
+        SignalCacheKey cell;
+        bool cacheable = SignalCell(currentPrice, volatility, drift, cell);
+        if (cacheable) {
+            if (const TradingSignal* cached = FindCachedSignal(cell)) return *cached;
         }
-        meanPrice /= simulatedPrices.size();
-        
-        // Calculate probability of profit (5% threshold)
-        int profitableOutcomes = 0;
-        int lossOutcomes = 0;
         
-        for (double price : simulatedPrices) {
-            if (price > currentPrice * 1.05) {
-                profitableOutcomes++;
-            } else if (price < currentPrice * 0.95) {
-                lossOutcomes++;
-            }
+        // 21-day terminal price distribution (simulated or closed form)
+        TerminalDistribution distribution;
+        {
+            BSTS_PERF_SPAN(perfStats, PerfStage::Simulation);
+            distribution = HorizonDistribution(currentPrice, drift, volatility, StreamUse::BarClose);
         }
-        
-        double profitProbability = static_cast<double>(profitableOutcomes) / simulatedPrices.size();
-        double lossProbability = static_cast<double>(lossOutcomes) / simulatedPrices.size();
+        signal = SignalFromDistribution(currentPrice, volatility, distribution);
+        if (cacheable) signalCache.Insert(cell, signal);
+        return signal;
+    }
+    
+    // Signal cache cell of a bar's state; false while the cache is off
+    bool SignalCell(double price, double volatility, double drift, SignalCacheKey& cell) const {
+        return QuantizeSignalState(price, volatility, drift, kSignalHorizonDays, monteCarloSimulations,
+                                   signalCacheTolerance, cell);
+    }
+    
+    const TradingSignal* FindCachedSignal(const SignalCacheKey& cell) {
+        const TradingSignal* cached = signalCache.Find(cell);
+        if (cached) {
+            BSTS_PERF_COUNT(perfStats, PerfCounter::SignalCacheHit);
+        } else {
+            BSTS_PERF_COUNT(perfStats, PerfCounter::SignalCacheMiss);
+        }
+        return cached;
+    }
+    
+    // Drop the tick evaluation and the cached signals after a settings change
+    void InvalidateEvaluations() {
+        tickEvaluation.valid = false;
+        signalCache.Clear();
+    }
+    
+    // Signal rules on a terminal distribution plus the 5% OTM option values
+    TradingSignal SignalFromDistribution(double currentPrice, double volatility,
+                                         const TerminalDistribution& distribution) {
+        TradingSignal signal;
+        double meanPrice = distribution.meanPrice;
+        double profitProbability = distribution.profitProbability;
+        double lossProbability = distribution.lossProbability;
         
         // Calculate expected return
         double expectedReturn = (meanPrice - currentPrice) / currentPrice;
         
-        // Use Black-Scholes for additional insight
-        double timeToExpiry = 30.0 / 365.0; // 30 days
-        double callStrike = currentPrice * 1.05; // 5% OTM call
-        double putStrike = currentPrice * 0.95;  // 5% OTM put
-        
-        double callValue = BlackScholesCall(currentPrice, callStrike, timeToExpiry, riskFreeRate, volatility);
-        double putValue = BlackScholesPut(currentPrice, putStrike, timeToExpiry, riskFreeRate, volatility);
-        
-        // Normalize option values for signal strength
-        double callSignal = callValue / (currentPrice * 0.05);
-        double putSignal = putValue / (currentPrice * 0.05);
+        // Use Black-Scholes for additional insight: option values
+        // normalized for signal strength
+        double callSignal, putSignal;
+        {
+            BSTS_PERF_SPAN(perfStats, PerfStage::Pricing);
+            SignalOptionValues(currentPrice, volatility, callSignal, putSignal);
+        }
         
         // Generate signals based on multiple factors
-        signal.confidence = std::min(1.0, static_cast<double>(simulatedPrices.size()) / 1000.0);
+        signal.confidence = distribution.confidence;
         
         // Buy signal conditions
         if (expectedReturn > 0.08 && profitProbability > 0.6 && volatility < 0.4 && callSignal > 0.3) {
@@ -276,26 +1351,39 @@ private:
         return signal;
     }
     
+    // The 5% OTM call and put, each over 5% of spot: from the pricing
+    // surface when it is on and covers the volatility, else priced directly
+    void SignalOptionValues(double currentPrice, double volatility, double& callSignal, double& putSignal) const {
+        double call, put;
+        if (usePricingSurface && pricingSurface.Lookup(volatility, call, put)) {
+            callSignal = call / 0.05;
+            putSignal = put / 0.05;
+            return;
+        }
+        
+        const double strikes[2] = {currentPrice * kSignalCallMoneyness, currentPrice * kSignalPutMoneyness};
+        const double expiries[2] = {kSignalOptionYears, kSignalOptionYears};
+        double callPrices[2], putPrices[2];
+        simd::OptionChainOutputs outputs;
+        outputs.callPrice = callPrices;
+        outputs.putPrice = putPrices;
+        simd::PriceOptionChain<Policy::kCdfAccuracy>(Market(currentPrice, volatility), strikes, expiries, 2, outputs);
+        callSignal = callPrices[0] / (currentPrice * 0.05);
+        putSignal = putPrices[1] / (currentPrice * 0.05);
+    }
+    
+    void BuildPricingSurface() {
+        if (usePricingSurface) {
+            pricingSurface.Build(riskFreeRate, kSignalOptionYears, kSignalCallMoneyness, kSignalPutMoneyness);
+        }
+    }
+    
+    // Mark the position to the close; ShouldClosePosition reports the exit
+    // and the caller (ELD or backtester) closes it
     void UpdatePosition(double currentPrice) {
         if (currentPosition.quantity != 0) {
             currentPosition.unrealizedPnL = 
                 (currentPrice - currentPosition.entryPrice) * currentPosition.quantity;
-            
-            // Check stop loss and take profit
-            double pnlPercent = currentPosition.unrealizedPnL / 
-                               (currentPosition.entryPrice * std::abs(currentPosition.quantity));
-            
-            if (currentPosition.isLong) {
-                if (pnlPercent <= -stopLossPercent || pnlPercent >= takeProfitPercent) {
-                    // Signal to close position (would be handled by TradeStation)
-                    currentPosition = Position(); // Reset position
-                }
-            } else {
-                if (pnlPercent >= stopLossPercent || pnlPercent <= -takeProfitPercent) {
-                    // Signal to close position
-                    currentPosition = Position(); // Reset position
-                }
-            }
         }
     }
     
@@ -305,39 +1393,750 @@ public:
         currentPosition.entryPrice = entryPrice;
         currentPosition.quantity = quantity;
         currentPosition.isLong = quantity > 0;
+        
+        // Mark to the latest close, so the P&L never belongs to an earlier position
+        currentPosition.unrealizedPnL = quantity != 0 && markPrice > 0.0
+            ? (markPrice - entryPrice) * quantity : 0.0;
     }
     
     double GetUnrealizedPnL() const {
         return currentPosition.unrealizedPnL;
     }
     
+    // Terminal distribution over the signal horizon under the configured
+    // engine; comparing engines on the same inputs cross-checks them
+    TerminalDistribution EstimateTerminalDistribution(double currentPrice, double drift,
+                                                      double volatility) {
+        Synchronize();
+        return HorizonDistribution(currentPrice, drift, volatility, StreamUse::Diagnostic);
+    }
+    
+    // The barrier engine's distribution under any configured engine: stop-
+    // loss and take-profit hit probabilities and expected holding time for
+    // a long entered at currentPrice. A diagnostic, not part of the signal:
+    // it blocks until the async queue is drained, then runs a full barrier
+    // simulation on the calling thread. It draws from the bar's diagnostic
+    // stream, so repeated calls within a bar agree and the bar signals are
+    // unaffected.
+    TerminalDistribution EstimateExitDistribution(double currentPrice, double drift, double volatility) {
+        Synchronize();
+        return BarrierDistribution(currentPrice, drift, volatility, kSignalHorizonDays,
+                                   SimulationStream(StreamUse::Diagnostic));
+    }
+    
+    // Black-Scholes prices and Greeks for a chain of (strike, expiry in
+    // years) contracts at the given spot, using the risk-free rate and the
+    // current volatility estimate. Sort by expiry to share per-expiry terms.
+    void PriceOptionChain(double spot, const double* strikes, const double* expiries,
+                          std::size_t count, const simd::OptionChainOutputs& outputs) const {
+        Synchronize();
+        simd::PriceOptionChain<Policy::kCdfAccuracy>(Market(spot, CalculateVolatility()), strikes, expiries, count,
+                                                     outputs);
+    }
+    
+    // Implied volatilities for a chain of (strike, expiry in years) quotes
+    // at the given spot; isCall[i] != 0 marks calls. Each contract starts
+    // from its previous solution, so re-solving every bar is cheap. Returns
+    // the contracts solved; the rest get NaN.
+    int ImpliedVolatilityChain(double spot, const double* strikes, const double* expiries,
+                               const double* prices, const int* isCall, std::size_t count,
+                               double* volatilities, int* iterations = nullptr) {
+        simd::ImpliedVolMarket market;
+        market.spot = spot;
+        market.rate = riskFreeRate;
+        return impliedVolatility.Solve(market, strikes, expiries, prices, isCall, count,
+                                       volatilities, iterations);
+    }
+    
+    // Stage latencies as a PerfStats::Table (count, then mean/p50/p90/p99/max
+    // in microseconds, per PerfStage, then the PerfCounter values such as
+    // signal cache hits and misses); returns the stages written, or 0 when
+    // built without BSTS_PERF_STATS. History and volatility include warm-up
+    // closes from LoadHistory.
+    int GetPerfStats(double* stats, int capacity) const {
+#if BSTS_PERF_STATS
+        return perfStats.Table(stats, capacity);
+#else
+        (void)stats;
+        (void)capacity;
+        return 0;
+#endif
+    }
+    
+    void ResetPerfStats() {
+#if BSTS_PERF_STATS
+        perfStats.Reset();
+#endif
+    }
+    
+    // Current annualized volatility and 21-bar drift estimates
+    double GetVolatility() const {
+        Synchronize();
+        return CalculateVolatility();
+    }
+    double GetExpectedReturn() const {
+        Synchronize();
+        return CalculateExpectedReturn();
+    }
+    
     bool ShouldClosePosition() const {
         if (currentPosition.quantity == 0) return false;
         
+        // Signed quantity makes the P&L positive for a winning long or short
         double pnlPercent = currentPosition.unrealizedPnL / 
                            (currentPosition.entryPrice * std::abs(currentPosition.quantity));
         
-        return (std::abs(pnlPercent) >= stopLossPercent) || 
+        return (pnlPercent <= -stopLossPercent) || 
                (pnlPercent >= takeProfitPercent);
     }
     
     // Parameter setters for optimization
-    void SetRiskFreeRate(double rate) { riskFreeRate = rate; }
+    void SetRiskFreeRate(double rate) {
+        Synchronize();
+        riskFreeRate = rate;
+        BuildPricingSurface();
+        InvalidateEvaluations();
+    }
+    double GetRiskFreeRate() const { return riskFreeRate; }
     void SetMaxPositionSize(double size) { maxPositionSize = size; }
-    void SetStopLoss(double percent) { stopLossPercent = percent; }
-    void SetTakeProfit(double percent) { takeProfitPercent = percent; }
-    void SetLookbackPeriod(int period) { lookbackPeriod = period; }
-    void SetMonteCarloSimulations(int sims) { monteCarloSimulations = sims; }
+    // The levels also shape barrier-engine signals
+    void SetStopLoss(double percent) {
+        Synchronize();
+        stopLossPercent = percent;
+        InvalidateEvaluations();
+    }
+    void SetTakeProfit(double percent) {
+        Synchronize();
+        takeProfitPercent = percent;
+        InvalidateEvaluations();
+    }
+    void SetLookbackPeriod(int period) {
+        // Windows need at least two bars to produce a return
+        Synchronize();
+        lookbackPeriod = std::max(period, 2);
+        priceHistory.SetCapacity(lookbackPeriod);
+        volatilityHistory.SetCapacity(lookbackPeriod);
+        returns.SetCapacity(lookbackPeriod);
+        if (RangeEstimator()) rangeVolatility.SetCapacity(lookbackPeriod);
+        ResyncReturnStatistics();
+        InvalidateEvaluations();
+    }
+    
+    // Volatility from close-to-close returns (the default) or a range
+    // estimator over the bars' open, high and low (RangeVolatility.h).
+    // Coming from close-to-close, range bars are collected from the next
+    // bar on, and the close-to-close estimate stands in until two are in.
+    void SetVolatilityEstimator(VolatilityEstimator estimator) {
+        Synchronize();
+        bool ranged = estimator != VolatilityEstimator::CloseToClose;
+        rangeVolatility.SetEstimator(estimator);
+        rangeVolatility.SetCapacity(ranged ? lookbackPeriod : 0);
+        InvalidateEvaluations();
+    }
+    VolatilityEstimator GetVolatilityEstimator() const { return rangeVolatility.Estimator(); }
+    void SetMonteCarloSimulations(int sims) {
+        Synchronize();
+        monteCarloSimulations = std::max(sims, 1);
+        ReserveSimulationBuffer();
+        InvalidateEvaluations();
+    }
+    // Ignored under a fixed-engine policy
+    void SetSimulationEngine(SimulationEngine engine) {
+        Synchronize();
+        simulationEngine = engine;
+        InvalidateEvaluations();
+    }
+    void SetVarianceReduction(VarianceReduction mode) {
+        Synchronize();
+        varianceReduction = mode;
+        InvalidateEvaluations();
+#if BSTS_CHECK_ALLOCATIONS
+        signalPathWarm = false;   // The first Sobol run builds its tables
+#endif
+    }
+    
+    // Fix the simulation key (reproducible runs). The streams follow the
+    // bars ingested, so instances fed the same bars under one seed draw the
+    // same paths from here on.
+    void SetRandomSeed(std::uint64_t seed) {
+        Synchronize();
+        simulationSeed = seed;
+        InvalidateEvaluations();
+    }
+    
+    // Simulation key in use; with the same settings and bars, SetRandomSeed
+    // on a fresh instance replays this run's signals exactly
+    std::uint64_t GetRandomSeed() const { return simulationSeed; }
+    
+    // Relative tick move (0.001 = 10 bp) beyond which UpdateTick
+    // re-evaluates the terminal distribution; 0 re-evaluates every tick
+    void SetTickEpsilon(double relative) { tickEpsilon = std::max(relative, 0.0); }
+    
+    // Tabulated signal option values (PricingSurface) instead of pricing
+    // the pair every bar; values move by at most PricingSurfaceError()
+    // (~2e-9 of spot). Built now and again on every SetRiskFreeRate.
+    void SetPricingSurface(bool enabled) {
+        Synchronize();
+        usePricingSurface = enabled;
+        BuildPricingSurface();
+        InvalidateEvaluations();
+    }
+    double PricingSurfaceError() const { return usePricingSurface ? pricingSurface.MaxError() : 0.0; }
+    
+    // Width of the signal cache cells (0.002 = 20 bp of price and of
+    // volatility, 0.2% a year of drift); 0, the default, re-evaluates
+    // every bar
+    void SetSignalCacheTolerance(double tolerance) {
+        Synchronize();
+        signalCacheTolerance = std::max(tolerance, 0.0);
+        signalCache.Clear();
+    }
 };
 
+template <typename Policy> constexpr int BasicBlackScholesTradeStation<Policy>::kSignalHorizonDays;
+template <typename Policy> constexpr double BasicBlackScholesTradeStation<Policy>::kProfitThreshold;
+template <typename Policy> constexpr double BasicBlackScholesTradeStation<Policy>::kLossThreshold;
+template <typename Policy> constexpr double BasicBlackScholesTradeStation<Policy>::kSignalCallMoneyness;
+template <typename Policy> constexpr double BasicBlackScholesTradeStation<Policy>::kSignalPutMoneyness;
+template <typename Policy> constexpr double BasicBlackScholesTradeStation<Policy>::kSignalOptionYears;
+template <typename Policy> constexpr std::size_t BasicBlackScholesTradeStation<Policy>::kParallelChunkTiles;
+template <typename Policy> constexpr int BasicBlackScholesTradeStation<Policy>::kSobolReplicates;
+template <typename Policy> constexpr bool BasicBlackScholesTradeStation<Policy>::kKernelSampling;
+template <typename Policy> constexpr int BasicBlackScholesTradeStation<Policy>::kBarrierStepDays;
+template <typename Policy> constexpr std::uint64_t BasicBlackScholesTradeStation<Policy>::kSweepSeed;
+template <typename Policy> constexpr std::size_t BasicBlackScholesTradeStation<Policy>::kDriftWindow;
+template <typename Policy> constexpr std::size_t BasicBlackScholesTradeStation<Policy>::kStatisticsResyncInterval;
+template <typename Policy> constexpr std::size_t BasicBlackScholesTradeStation<Policy>::kWarmupBars;
+template <typename Policy> constexpr std::size_t BasicBlackScholesTradeStation<Policy>::kRangeWarmupBars;
+
+// The engine as configured at run time, and the compile-time presets
+using BlackScholesTradeStation = BasicBlackScholesTradeStation<DefaultSignalPolicy>;
+using TerminalSamplingTradeStation = BasicBlackScholesTradeStation<TerminalSamplingPolicy>;
+using ScreeningTradeStation = BasicBlackScholesTradeStation<ScreeningPolicy>;
+
 // TradeStation DLL Export Functions
 #ifdef TRADESTATION_DLL
+// Every chart creates its own instance and passes the handle to the
+// Instance* exports, so charts and symbols never share price history.
+// The tables are never destroyed: deleting a live instance from a static
+// destructor would join its async worker under the loader lock. Charts
+// release their handles (the ELD does so in UnInitialized).
+static InstanceTable<BlackScholesTradeStation>& Instances() {
+    static InstanceTable<BlackScholesTradeStation>* instances = new InstanceTable<BlackScholesTradeStation>;
+    return *instances;
+}
+
+// Live instances across every table. The shared pool runs only while
+// there are some: releasing the last one stops and joins its workers on
+// the caller's thread, the next Create* starts them again.
+static std::mutex liveInstancesMutex;
+static int liveInstances = 0;
+
+static int RetainWorkers(int handle) {
+    if (handle != 0) {
+        std::lock_guard<std::mutex> lock(liveInstancesMutex);
+        if (liveInstances++ == 0) SharedThreadPool().Start();
+    }
+    return handle;
+}
+
+static bool ReleaseWorkers(bool erased) {
+    if (erased) {
+        std::lock_guard<std::mutex> lock(liveInstancesMutex);
+        if (--liveInstances == 0) SharedThreadPool().Stop();
+    }
+    return erased;
+}
+
+// Instance behind the original single-algorithm exports
+static std::atomic<int> legacyHandle(0);
+
+// PortfolioAnalyzeBars state: handles resolve into `instances`, and
+// batches from different threads run one at a time
+struct PortfolioBatch {
+    std::mutex mutex;
+    std::vector<BlackScholesTradeStation*> instances;
+    PortfolioEngine<BlackScholesTradeStation> engine;
+};
+
+static PortfolioBatch& Portfolio() {
+    static PortfolioBatch portfolio;
+    return portfolio;
+}
+
+// Compile-time specializations behind the Preset* exports. Each preset has
+// its own handle table; preset 0 is the table of CreateInstance, so its
+// handles also work with the Instance* exports.
+enum SignalPreset {
+    kPresetRuntime = 0,            // BlackScholesTradeStation
+    kPresetTerminalSampling = 1,   // TerminalSamplingTradeStation
+    kPresetScreening = 2           // ScreeningTradeStation
+};
+
+template <typename Algorithm>
+static InstanceTable<Algorithm>& PresetInstances() {
+    static InstanceTable<Algorithm>* instances = new InstanceTable<Algorithm>;
+    return *instances;
+}
+
+// Runs body(table) on the preset's table; false for an unknown preset
+template <typename Body>
+static bool WithPresetInstances(int preset, Body&& body) {
+    switch (preset) {
+    case kPresetRuntime: body(Instances()); return true;
+    case kPresetTerminalSampling: body(PresetInstances<TerminalSamplingTradeStation>()); return true;
+    case kPresetScreening: body(PresetInstances<ScreeningTradeStation>()); return true;
+    default: return false;
+    }
+}
+
+template <typename Algorithm>
+static void ApplyParameters(Algorithm& instance, double riskFreeRate, double maxPositionSize,
+                            double stopLoss, double takeProfit, int lookbackPeriod, int monteCarloSims) {
+    instance.SetRiskFreeRate(riskFreeRate);
+    instance.SetMaxPositionSize(maxPositionSize);
+    instance.SetStopLoss(stopLoss);
+    instance.SetTakeProfit(takeProfit);
+    instance.SetLookbackPeriod(lookbackPeriod);
+    instance.SetMonteCarloSimulations(monteCarloSims);
+}
+
 extern "C" {
-    static BlackScholesTradeStation* algorithm = nullptr;
+    // Returns a handle (> 0) for the new instance, or 0 if the table is full
+    __declspec(dllexport) int CreateInstance() {
+        return RetainWorkers(Instances().Insert(new BlackScholesTradeStation()));
+    }
+    
+    // Releasing the last instance of any kind also stops the thread pool
+    __declspec(dllexport) int DestroyInstance(int handle) {
+        return ReleaseWorkers(Instances().Erase(handle)) ? 1 : 0;
+    }
+    
+    __declspec(dllexport) int InstanceAnalyzeBar(int handle, double open, double high, double low,
+                                                double close, double volume, int barNumber,
+                                                double* buySignal, double* sellSignal,
+                                                double* confidence) {
+        BlackScholesTradeStation* instance = Instances().Get(handle);
+        if (!instance) return 0;
+        
+        return instance->AnalyzeBar(open, high, low, close, volume, barNumber,
+                                    *buySignal, *sellSignal, *confidence);
+    }
+    
+    // As InstanceAnalyzeBar, also writing the sequence number of the
+    // returned signal (as InstancePollSignal; always 0 in synchronous mode)
+    // so an async caller sees how many bars behind it is. sequence may be null.
+    __declspec(dllexport) int InstanceAnalyzeBarAsync(int handle, double open, double high, double low,
+                                                     double close, double volume, int barNumber,
+                                                     double* buySignal, double* sellSignal,
+                                                     double* confidence, int* sequence) {
+        BlackScholesTradeStation* instance = Instances().Get(handle);
+        if (!instance) return 0;
+        
+        std::uint64_t signalSequence;
+        int action = instance->AnalyzeBar(open, high, low, close, volume, barNumber,
+                                          *buySignal, *sellSignal, *confidence, signalSequence);
+        if (sequence) *sequence = static_cast<int>(signalSequence);
+        return action;
+    }
+    
+    // enabled != 0: InstanceAnalyzeBar queues each bar for a background
+    // worker and returns the last completed signal at once
+    __declspec(dllexport) void InstanceSetAsyncMode(int handle, int enabled) {
+        if (BlackScholesTradeStation* instance = Instances().Get(handle)) {
+            instance->SetAsyncMode(enabled != 0);
+        }
+    }
+    
+    // Latest completed async signal; returns its sequence number (the count
+    // of InstanceAnalyzeBar calls up to its bar, 0 when none is ready) and
+    // writes the bar number it was computed for. Output pointers may be null.
+    __declspec(dllexport) int InstancePollSignal(int handle, int* action, double* buySignal, double* sellSignal,
+                                                double* confidence, int* barNumber) {
+        BlackScholesTradeStation* instance = Instances().Get(handle);
+        if (!instance) return 0;
+        
+        AsyncSignal signal = instance->PollSignal();
+        if (action) *action = signal.action;
+        if (buySignal) *buySignal = signal.buySignal;
+        if (sellSignal) *sellSignal = signal.sellSignal;
+        if (confidence) *confidence = signal.confidence;
+        if (barNumber) *barNumber = signal.barNumber;
+        return static_cast<int>(signal.sequence);
+    }
+    
+    // Provisional signal for the forming bar at `price` (IntrabarOrderGeneration
+    // ticks); the bar itself still goes through InstanceAnalyzeBar on close
+    __declspec(dllexport) int InstanceUpdateTick(int handle, double price, double* buySignal,
+                                                double* sellSignal, double* confidence) {
+        BlackScholesTradeStation* instance = Instances().Get(handle);
+        if (!instance) return 0;
+        
+        return instance->UpdateTick(price, *buySignal, *sellSignal, *confidence);
+    }
+    
+    __declspec(dllexport) void InstanceSetTickEpsilon(int handle, double epsilon) {
+        if (BlackScholesTradeStation* instance = Instances().Get(handle)) {
+            instance->SetTickEpsilon(epsilon);
+        }
+    }
+    
+    // enabled != 0: signal option values from a volatility table built for
+    // the current rate (see SetPricingSurface)
+    __declspec(dllexport) void InstanceSetPricingSurface(int handle, int enabled) {
+        if (BlackScholesTradeStation* instance = Instances().Get(handle)) {
+            instance->SetPricingSurface(enabled != 0);
+        }
+    }
+    
+    // Seeds are passed as doubles, exact below 2^53 (self-drawn seeds always
+    // are): log InstanceGetRandomSeed at start-up and feed it back to
+    // InstanceSetRandomSeed to replay a session's signals
+    __declspec(dllexport) void InstanceSetRandomSeed(int handle, double seed) {
+        if (BlackScholesTradeStation* instance = Instances().Get(handle)) {
+            if (seed >= 0.0 && seed < 18446744073709551616.0) instance->SetRandomSeed(static_cast<std::uint64_t>(seed));
+        }
+    }
+    
+    __declspec(dllexport) double InstanceGetRandomSeed(int handle) {
+        BlackScholesTradeStation* instance = Instances().Get(handle);
+        return instance ? static_cast<double>(instance->GetRandomSeed()) : -1.0;
+    }
+    
+    // Quantized signal reuse between quiet bars (see SetSignalCacheTolerance)
+    __declspec(dllexport) void InstanceSetSignalCacheTolerance(int handle, double tolerance) {
+        if (BlackScholesTradeStation* instance = Instances().Get(handle)) {
+            instance->SetSignalCacheTolerance(tolerance);
+        }
+    }
+    
+    // One bar close for a whole book: bar i goes to handles[i], and the
+    // output arrays (count entries, may be null) receive what
+    // InstanceAnalyzeBar would have returned for it. Invalid handles get
+    // zeros; a handle may appear only once. Returns the instances analyzed.
+    __declspec(dllexport) int PortfolioAnalyzeBarsOHLC(const int* handles, const double* opens,
+                                                      const double* highs, const double* lows,
+                                                      const double* closes, int count, int* actions,
+                                                      double* buySignals, double* sellSignals,
+                                                      double* confidences) {
+        if (!handles || !closes || count <= 0) return 0;
+        bool ranges = opens && highs && lows;
+        
+        PortfolioBatch& portfolio = Portfolio();
+        std::lock_guard<std::mutex> lock(portfolio.mutex);
+        portfolio.instances.resize(count);
+        int analyzed = 0;
+        for (int i = 0; i < count; ++i) {
+            portfolio.instances[i] = Instances().Get(handles[i]);
+            if (portfolio.instances[i] &&
+                (ranges || portfolio.instances[i]->GetVolatilityEstimator() == VolatilityEstimator::CloseToClose)) {
+                ++analyzed;
+            }
+        }
+        portfolio.engine.AnalyzeBars(portfolio.instances.data(), ranges ? opens : nullptr, highs, lows, closes,
+                                     count, actions, buySignals, sellSignals, confidences);
+        return analyzed;
+    }
     
+    // Closes only. Instances on a range estimator (SetVolatilityEstimator)
+    // refuse the bar, since a close has no range: they get zeros, are not
+    // counted and keep their windows; send them PortfolioAnalyzeBarsOHLC.
+    __declspec(dllexport) int PortfolioAnalyzeBars(const int* handles, const double* closes, int count,
+                                                  int* actions, double* buySignals,
+                                                  double* sellSignals, double* confidences) {
+        return PortfolioAnalyzeBarsOHLC(handles, nullptr, nullptr, nullptr, closes, count, actions,
+                                        buySignals, sellSignals, confidences);
+    }
+    
+    // Bulk warm-up from the chart history; signalBars > 0 also evaluates
+    // the last signalBars closes into the optional output arrays
+    __declspec(dllexport) int InstanceLoadHistory(int handle, const double* closes, int count, int signalBars,
+                                                 int* actions, double* buySignals,
+                                                 double* sellSignals, double* confidences) {
+        BlackScholesTradeStation* instance = Instances().Get(handle);
+        if (!instance) return 0;
+        
+        return instance->LoadHistory(closes, count, signalBars, actions, buySignals,
+                                     sellSignals, confidences);
+    }
+    
+    // Snapshot for a restart: the instance's windows, statistics, random
+    // stream and position go to `path`, tagged with `stamp` (the caller's
+    // mark for the last close, such as its bar date and time). Returns 1,
+    // or 0 if the handle is invalid or the file cannot be written.
+    __declspec(dllexport) int InstanceSaveState(int handle, const char* path, double stamp) {
+        BlackScholesTradeStation* instance = Instances().Get(handle);
+        if (!instance || !path) return 0;
+        
+        StateFileWriter writer;
+        instance->SaveState(writer, 0, stamp);
+        return writer.Write(path) ? 1 : 0;
+    }
+    
+    // Restore a snapshot from InstanceSaveState into a configured instance
+    // (the lookback must match). Returns the saved stamp, so the caller
+    // feeds only later bars, or -1 if nothing was restored.
+    __declspec(dllexport) double InstanceLoadState(int handle, const char* path) {
+        BlackScholesTradeStation* instance = Instances().Get(handle);
+        StateFile file;
+        if (!instance || !path || !file.Open(path)) return -1.0;
+        
+        const EngineStateView* state = file.Find(0);
+        return state && instance->LoadState(*state) ? state->record->stamp : -1.0;
+    }
+    
+    // A whole book in one file: handles[i] is saved under keys[i] (a
+    // caller-chosen id that outlives the handle, such as a symbol number)
+    // with stamps[i]. Invalid handles are skipped. Returns the instances
+    // saved, or 0 if the file cannot be written.
+    __declspec(dllexport) int PortfolioSaveState(const char* path, const int* handles, const int* keys,
+                                                const double* stamps, int count) {
+        if (!path || !handles || !keys || count <= 0) return 0;
+        
+        StateFileWriter writer;
+        for (int i = 0; i < count; ++i) {
+            if (BlackScholesTradeStation* instance = Instances().Get(handles[i])) {
+                instance->SaveState(writer, static_cast<std::uint32_t>(keys[i]), stamps ? stamps[i] : 0.0);
+            }
+        }
+        return writer.Write(path) ? static_cast<int>(writer.RecordCount()) : 0;
+    }
+    
+    // Restore handles[i] from the record saved under keys[i]; stamps (may
+    // be null) receives each saved stamp, or -1 where nothing was restored.
+    // The file is mapped once for the whole book. Returns the instances
+    // restored.
+    __declspec(dllexport) int PortfolioLoadState(const char* path, const int* handles, const int* keys,
+                                                double* stamps, int count) {
+        if (!handles || !keys || count <= 0) return 0;
+        
+        StateFile file;
+        bool open = path && file.Open(path);
+        int restored = 0;
+        for (int i = 0; i < count; ++i) {
+            BlackScholesTradeStation* instance = open ? Instances().Get(handles[i]) : nullptr;
+            const EngineStateView* state = instance ? file.Find(static_cast<std::uint32_t>(keys[i])) : nullptr;
+            bool loaded = state && instance->LoadState(*state);
+            if (loaded) ++restored;
+            if (stamps) stamps[i] = loaded ? state->record->stamp : -1.0;
+        }
+        return restored;
+    }
+    
+    // InstanceLoadHistory from full bars, for the range estimators
+    __declspec(dllexport) int InstanceLoadHistoryBars(int handle, const double* opens, const double* highs,
+                                                     const double* lows, const double* closes, int count,
+                                                     int signalBars, int* actions, double* buySignals,
+                                                     double* sellSignals, double* confidences) {
+        BlackScholesTradeStation* instance = Instances().Get(handle);
+        if (!instance || count <= 0) return 0;
+        
+        BarSeries bars;
+        bars.open = opens;
+        bars.high = highs;
+        bars.low = lows;
+        bars.close = closes;
+        bars.count = static_cast<std::size_t>(count);
+        return instance->LoadHistory(bars, signalBars, actions, buySignals, sellSignals, confidences);
+    }
+    
+    // Preset instances (see SignalPreset): the same calls as CreateInstance,
+    // InstanceSetParameters, InstanceLoadHistory, InstanceAnalyzeBar and
+    // DestroyInstance on a compile-time specialization. Unknown presets
+    // and handles do nothing and return 0.
+    __declspec(dllexport) int CreatePresetInstance(int preset) {
+        int handle = 0;
+        WithPresetInstances(preset, [&](auto& table) {
+            using Algorithm = typename std::remove_reference<decltype(table)>::type::Object;
+            handle = table.Insert(new Algorithm());
+        });
+        return RetainWorkers(handle);
+    }
+    
+    __declspec(dllexport) int DestroyPresetInstance(int preset, int handle) {
+        bool erased = false;
+        WithPresetInstances(preset, [&](auto& table) { erased = table.Erase(handle); });
+        return ReleaseWorkers(erased) ? 1 : 0;
+    }
+    
+    __declspec(dllexport) void PresetSetParameters(int preset, int handle, double riskFreeRate,
+                                                   double maxPositionSize, double stopLoss, double takeProfit,
+                                                   int lookbackPeriod, int monteCarloSims) {
+        WithPresetInstances(preset, [&](auto& table) {
+            if (auto* instance = table.Get(handle)) {
+                ApplyParameters(*instance, riskFreeRate, maxPositionSize, stopLoss, takeProfit,
+                                lookbackPeriod, monteCarloSims);
+            }
+        });
+    }
+    
+    __declspec(dllexport) int PresetLoadHistory(int preset, int handle, const double* closes, int count,
+                                               int signalBars, int* actions, double* buySignals,
+                                               double* sellSignals, double* confidences) {
+        int consumed = 0;
+        WithPresetInstances(preset, [&](auto& table) {
+            if (auto* instance = table.Get(handle)) {
+                consumed = instance->LoadHistory(closes, count, signalBars, actions, buySignals,
+                                                 sellSignals, confidences);
+            }
+        });
+        return consumed;
+    }
+    
+    __declspec(dllexport) int PresetAnalyzeBar(int preset, int handle, double open, double high, double low,
+                                              double close, double volume, int barNumber,
+                                              double* buySignal, double* sellSignal, double* confidence) {
+        int action = 0;
+        WithPresetInstances(preset, [&](auto& table) {
+            if (auto* instance = table.Get(handle)) {
+                action = instance->AnalyzeBar(open, high, low, close, volume, barNumber,
+                                              *buySignal, *sellSignal, *confidence);
+            }
+        });
+        return action;
+    }
+    
+    // Prices and Greeks for `count` contracts given as strike/expiry arrays
+    // (expiry in years). Output arrays may be null; volatility <= 0 uses the
+    // instance's current estimate. Returns the contracts priced.
+    __declspec(dllexport) int InstancePriceOptionChain(int handle, double spot, double volatility,
+                                                      const double* strikes, const double* expiries, int count,
+                                                      double* callPrices, double* putPrices,
+                                                      double* callDeltas, double* putDeltas, double* gammas,
+                                                      double* vegas, double* callThetas, double* putThetas) {
+        BlackScholesTradeStation* instance = Instances().Get(handle);
+        if (!instance || !strikes || !expiries || count <= 0) return 0;
+        
+        simd::OptionChainOutputs outputs;
+        outputs.callPrice = callPrices;
+        outputs.putPrice = putPrices;
+        outputs.callDelta = callDeltas;
+        outputs.putDelta = putDeltas;
+        outputs.gamma = gammas;
+        outputs.vega = vegas;
+        outputs.callTheta = callThetas;
+        outputs.putTheta = putThetas;
+        
+        if (volatility > 0.0) {
+            simd::OptionChainMarket market;
+            market.spot = spot;
+            market.rate = instance->GetRiskFreeRate();
+            market.volatility = volatility;
+            simd::PriceOptionChain(market, strikes, expiries, count, outputs);
+        } else {
+            instance->PriceOptionChain(spot, strikes, expiries, count, outputs);
+        }
+        return count;
+    }
+    
+    // Implied volatilities for `count` quoted contracts (expiry in years,
+    // isCall[i] != 0 for calls), warm-started from the instance's previous
+    // solutions. Unsolvable quotes get NaN; iterations may be null.
+    // Returns the contracts solved.
+    __declspec(dllexport) int InstanceImpliedVolatilityChain(int handle, double spot, const double* strikes,
+                                                            const double* expiries, const double* prices,
+                                                            const int* isCall, int count,
+                                                            double* volatilities, int* iterations) {
+        BlackScholesTradeStation* instance = Instances().Get(handle);
+        if (!instance || !strikes || !expiries || !prices || !isCall || !volatilities || count <= 0) return 0;
+        
+        return instance->ImpliedVolatilityChain(spot, strikes, expiries, prices, isCall, count,
+                                                volatilities, iterations);
+    }
+    
+    // quantity is signed: negative for a short position
+    __declspec(dllexport) void InstanceSetPosition(int handle, double entryPrice, int quantity) {
+        if (BlackScholesTradeStation* instance = Instances().Get(handle)) {
+            instance->SetPosition(entryPrice, quantity);
+        }
+    }
+    
+    __declspec(dllexport) double InstanceGetUnrealizedPnL(int handle) {
+        BlackScholesTradeStation* instance = Instances().Get(handle);
+        return instance ? instance->GetUnrealizedPnL() : 0.0;
+    }
+    
+    __declspec(dllexport) int InstanceShouldClosePosition(int handle) {
+        BlackScholesTradeStation* instance = Instances().Get(handle);
+        return instance ? (instance->ShouldClosePosition() ? 1 : 0) : 0;
+    }
+    
+    // Chances that a long entered at `price` touches the stop-loss and the
+    // take-profit within the signal horizon, and its expected holding time in
+    // days, at the instance's current drift and volatility (barrier engine).
+    // Returns 0 for a bad handle or price. Blocks the caller: it waits for
+    // queued async bars, then runs a full simulation, so call it once per
+    // entry rather than per signal or tick.
+    __declspec(dllexport) int InstanceEstimateExit(int handle, double price, double* stopLossHit,
+                                                   double* takeProfitHit, double* exitDays) {
+        BlackScholesTradeStation* instance = Instances().Get(handle);
+        if (!instance || !(price > 0.0)) return 0;
+        TerminalDistribution distribution =
+            instance->EstimateExitDistribution(price, instance->GetExpectedReturn(), instance->GetVolatility());
+        if (stopLossHit) *stopLossHit = distribution.stopLossHitProbability;
+        if (takeProfitHit) *takeProfitHit = distribution.takeProfitHitProbability;
+        if (exitDays) *exitDays = distribution.expectedExitDays;
+        return 1;
+    }
+    
+    __declspec(dllexport) void InstanceSetParameters(int handle, double riskFreeRate, double maxPositionSize,
+                                                   double stopLoss, double takeProfit,
+                                                   int lookbackPeriod, int monteCarloSims) {
+        if (BlackScholesTradeStation* instance = Instances().Get(handle)) {
+            ApplyParameters(*instance, riskFreeRate, maxPositionSize, stopLoss, takeProfit,
+                            lookbackPeriod, monteCarloSims);
+        }
+    }
+    
+    __declspec(dllexport) void InstanceSetSimulationEngine(int handle, int engine) {
+        BlackScholesTradeStation* instance = Instances().Get(handle);
+        if (instance && engine >= 0 && engine <= 3) {
+            instance->SetSimulationEngine(static_cast<SimulationEngine>(engine));
+        }
+    }
+    
+    __declspec(dllexport) void InstanceSetVarianceReduction(int handle, int mode) {
+        BlackScholesTradeStation* instance = Instances().Get(handle);
+        if (instance && mode >= 0 && mode <= 3) {
+            instance->SetVarianceReduction(static_cast<VarianceReduction>(mode));
+        }
+    }
+    
+    // 0 = close-to-close, 1 = Parkinson, 2 = Garman-Klass, 3 = Yang-Zhang
+    __declspec(dllexport) void InstanceSetVolatilityEstimator(int handle, int estimator) {
+        BlackScholesTradeStation* instance = Instances().Get(handle);
+        if (instance && estimator >= 0 && estimator <= 3) {
+            instance->SetVolatilityEstimator(static_cast<VolatilityEstimator>(estimator));
+        }
+    }
+    
+    // Per-stage latency table (see GetPerfStats in the class): capacity
+    // doubles, kPerfStatFieldCount per stage, then the kPerfCounterCount
+    // counters when capacity reaches kPerfTableSize. Returns the stages
+    // written; 0 for a DLL built without BSTS_PERF_STATS.
+    __declspec(dllexport) int InstanceGetPerfStats(int handle, double* stats, int capacity) {
+        BlackScholesTradeStation* instance = Instances().Get(handle);
+        return instance ? instance->GetPerfStats(stats, capacity) : 0;
+    }
+    
+    __declspec(dllexport) void InstanceResetPerfStats(int handle) {
+        if (BlackScholesTradeStation* instance = Instances().Get(handle)) {
+            instance->ResetPerfStats();
+        }
+    }
+    
+    // Threads used for the Monte Carlo path loop, including the chart
+    // thread (<= 0 = one per hardware thread). Shared by all instances.
+    __declspec(dllexport) void SetThreadCount(int threads) {
+        SharedThreadPool().SetThreadCount(threads);
+    }
+    
+    // Single-instance exports kept for existing strategies; they drive one
+    // shared instance, so use the handle API for more than one chart
     __declspec(dllexport) int InitializeAlgorithm() {
-        if (algorithm) delete algorithm;
-        algorithm = new BlackScholesTradeStation();
+        int handle = CreateInstance();
+        if (handle == 0) return 0;
+        DestroyInstance(legacyHandle.exchange(handle));
         return 1;
     }
     
@@ -345,49 +2144,146 @@ extern "C" {
                                         double close, double volume, int barNumber,
                                         double* buySignal, double* sellSignal, 
                                         double* confidence) {
-        if (!algorithm) return 0;
-        
-        return algorithm->AnalyzeBar(open, high, low, close, volume, barNumber,
-                                   *buySignal, *sellSignal, *confidence);
+        return InstanceAnalyzeBar(legacyHandle.load(), open, high, low, close, volume, barNumber,
+                                  buySignal, sellSignal, confidence);
+    }
+    
+    __declspec(dllexport) void SetAsyncMode(int enabled) {
+        InstanceSetAsyncMode(legacyHandle.load(), enabled);
+    }
+    
+    __declspec(dllexport) int PollSignal(int* action, double* buySignal, double* sellSignal,
+                                        double* confidence, int* barNumber) {
+        return InstancePollSignal(legacyHandle.load(), action, buySignal, sellSignal, confidence, barNumber);
+    }
+    
+    __declspec(dllexport) int UpdateTick(double price, double* buySignal, double* sellSignal,
+                                        double* confidence) {
+        return InstanceUpdateTick(legacyHandle.load(), price, buySignal, sellSignal, confidence);
+    }
+    
+    __declspec(dllexport) void SetTickEpsilon(double epsilon) {
+        InstanceSetTickEpsilon(legacyHandle.load(), epsilon);
+    }
+    
+    __declspec(dllexport) void SetSignalCacheTolerance(double tolerance) {
+        InstanceSetSignalCacheTolerance(legacyHandle.load(), tolerance);
+    }
+    
+    __declspec(dllexport) void SetPricingSurface(int enabled) {
+        InstanceSetPricingSurface(legacyHandle.load(), enabled);
+    }
+    
+    __declspec(dllexport) void SetRandomSeed(double seed) {
+        InstanceSetRandomSeed(legacyHandle.load(), seed);
+    }
+    
+    __declspec(dllexport) double GetRandomSeed() {
+        return InstanceGetRandomSeed(legacyHandle.load());
+    }
+    
+    __declspec(dllexport) int LoadHistoryBars(const double* opens, const double* highs, const double* lows,
+                                             const double* closes, int count, int signalBars, int* actions,
+                                             double* buySignals, double* sellSignals, double* confidences) {
+        return InstanceLoadHistoryBars(legacyHandle.load(), opens, highs, lows, closes, count, signalBars,
+                                       actions, buySignals, sellSignals, confidences);
+    }
+    
+    __declspec(dllexport) int SaveState(const char* path, double stamp) {
+        return InstanceSaveState(legacyHandle.load(), path, stamp);
+    }
+    
+    __declspec(dllexport) double LoadState(const char* path) {
+        return InstanceLoadState(legacyHandle.load(), path);
+    }
+    
+    __declspec(dllexport) int LoadHistory(const double* closes, int count, int signalBars,
+                                         int* actions, double* buySignals,
+                                         double* sellSignals, double* confidences) {
+        return InstanceLoadHistory(legacyHandle.load(), closes, count, signalBars, actions,
+                                   buySignals, sellSignals, confidences);
     }
     
     __declspec(dllexport) void SetPosition(double entryPrice, int quantity) {
-        if (algorithm) algorithm->SetPosition(entryPrice, quantity);
+        InstanceSetPosition(legacyHandle.load(), entryPrice, quantity);
     }
     
     __declspec(dllexport) double GetUnrealizedPnL() {
-        return algorithm ? algorithm->GetUnrealizedPnL() : 0.0;
+        return InstanceGetUnrealizedPnL(legacyHandle.load());
     }
     
     __declspec(dllexport) int ShouldClosePosition() {
-        return algorithm ? (algorithm->ShouldClosePosition() ? 1 : 0) : 0;
+        return InstanceShouldClosePosition(legacyHandle.load());
+    }
+    
+    __declspec(dllexport) int EstimateExit(double price, double* stopLossHit, double* takeProfitHit,
+                                           double* exitDays) {
+        return InstanceEstimateExit(legacyHandle.load(), price, stopLossHit, takeProfitHit, exitDays);
     }
     
     __declspec(dllexport) void SetParameters(double riskFreeRate, double maxPositionSize,
                                            double stopLoss, double takeProfit,
                                            int lookbackPeriod, int monteCarloSims) {
-        if (algorithm) {
-            algorithm->SetRiskFreeRate(riskFreeRate);
-            algorithm->SetMaxPositionSize(maxPositionSize);
-            algorithm->SetStopLoss(stopLoss);
-            algorithm->SetTakeProfit(takeProfit);
-            algorithm->SetLookbackPeriod(lookbackPeriod);
-            algorithm->SetMonteCarloSimulations(monteCarloSims);
-        }
+        InstanceSetParameters(legacyHandle.load(), riskFreeRate, maxPositionSize,
+                              stopLoss, takeProfit, lookbackPeriod, monteCarloSims);
+    }
+    
+    __declspec(dllexport) void SetSimulationEngine(int engine) {
+        InstanceSetSimulationEngine(legacyHandle.load(), engine);
+    }
+    
+    __declspec(dllexport) void SetVarianceReduction(int mode) {
+        InstanceSetVarianceReduction(legacyHandle.load(), mode);
     }
     
+    __declspec(dllexport) void SetVolatilityEstimator(int estimator) {
+        InstanceSetVolatilityEstimator(legacyHandle.load(), estimator);
+    }
+    
+    __declspec(dllexport) int GetPerfStats(double* stats, int capacity) {
+        return InstanceGetPerfStats(legacyHandle.load(), stats, capacity);
+    }
+    
+    // Releases the shared instance; the thread pool stops with the last
+    // live instance, so call this (and destroy every handle) before unload
     __declspec(dllexport) void CleanupAlgorithm() {
-        if (algorithm) {
-            delete algorithm;
-            algorithm = nullptr;
-        }
+        DestroyInstance(legacyHandle.exchange(0));
     }
 }
 #endif
 
 // Standalone testing main function
-#ifndef TRADESTATION_DLL
-int main() {
+#if !defined(TRADESTATION_DLL) && !defined(STANDALONE_TEST)
+// --backtest [bars | file.bars]: replay a seeded random walk, or a bar
+// file written by examples/convert_bars, through the backtester
+static int RunDemoBacktest(const BarSeries& bars) {
+    BlackScholesTradeStation algo;
+    algo.SetRandomSeed(42);
+    BacktestReport report = RunBacktest(algo, bars, BacktestSettings());
+    WriteBacktestReport(std::cout, report);
+    return 0;
+}
+
+static int RunDemoBacktest(int bars) {
+    ZigguratNormal<Xoshiro256> normal(Xoshiro256(42));
+    std::vector<double> closes = {100.0};
+    for (int i = 1; i < bars; ++i) closes.push_back(closes.back() * std::exp(0.0004 + 0.02 * normal()));
+    return RunDemoBacktest(BarSeries::FromCloses(closes.data(), closes.size()));
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--backtest") {
+        if (argc > 2 && std::atoi(argv[2]) == 0) {
+            BarFile file;
+            if (!file.Open(argv[2])) {
+                std::cerr << "Cannot open bar file " << argv[2] << "\n";
+                return 1;
+            }
+            return RunDemoBacktest(file.Bars());
+        }
+        return RunDemoBacktest(argc > 2 ? std::max(std::atoi(argv[2]), 2) : 2520);
+    }
+    
     BlackScholesTradeStation algo;
     
     // Test with sample data
@@ -0,0 +1,126 @@
+// ISA-generic implied volatility kernel. Included once per ISA namespace by
+// ImpliedVolatility.h, after SimdKernels.h and NormalCDF.h have defined
+// that namespace's lane primitives and vector math; do not include directly.
+//
+// Prices are normalized by spot and solved in total volatility
+// s = sigma sqrt(T), so with X = K e^{-rT} / S a call is N(d1) - X N(d2)
+// and its derivative in s is just phi(d1). Each lane solves for its
+// out-of-the-money side (the put when X < 1), whose price is all time
+// value, so in-the-money quotes do not lose digits to the intrinsic part.
+
+template <CdfAccuracy Tier>
+inline int SolveImpliedVolatilityLanes(const ImpliedVolMarket& market, const double* strikes,
+                                       const double* expiries, const double* prices,
+                                       const double* callFlags, const double* guesses,
+                                       double* volatilities, double* iterations) {
+    VecD one = Set1(1.0);
+    VecD zero = Set1(0.0);
+    VecD strike = Load(strikes);
+    VecD expiry = Load(expiries);
+    MaskD valid = Greater(expiry, zero) & Greater(strike, zero);
+    expiry = Select(valid, expiry, one);
+    strike = Select(valid, strike, Set1(market.spot));
+
+    VecD sqrtT = Sqrt(expiry);
+    VecD moneyness = strike * Exp(Set1(-market.rate) * expiry) * Set1(1.0 / market.spot);
+    VecD negLogMoneyness = -Log(moneyness);
+    VecD intrinsic = one - moneyness;
+
+    // Each lane solves its OTM side, converting the quote by parity only
+    // when it is on the other side. A converted quote must keep more time
+    // value than the rounding of the conversion, or it fixes no volatility.
+    VecD quote = Load(prices) * Set1(1.0 / market.spot);
+    VecD isPut = one - Load(callFlags);
+    MaskD solvePut = Less(moneyness, one);
+    VecD callQuote = quote + isPut * intrinsic;
+    VecD converted = isPut - Select(solvePut, one, zero);   // -1, 0 or +1
+    VecD target = quote + converted * intrinsic;
+    VecD resolution = Abs(converted) * (quote + Abs(intrinsic)) * Set1(kParityResolution);
+    valid = valid & Greater(target, resolution) & Less(target, Select(solvePut, moneyness, one));
+    VecD logTarget = Log(Select(valid, target, one));
+
+    // Start from the cached volatility, else Corrado-Miller on the call quote
+    VecD guess = Load(guesses);
+    VecD centered = callQuote - Set1(0.5) * intrinsic;
+    VecD radicand = Max(centered * centered - intrinsic * intrinsic * Set1(0.3183098861837907), zero);
+    VecD corradoMiller = Set1(2.5066282746310002) * (centered + Sqrt(radicand)) / (one + moneyness);
+    VecD s = Select(Greater(guess, zero), guess * sqrtT, corradoMiller);
+    s = Min(Max(s, Set1(kMinTotalVolatility)), Set1(kMaxTotalVolatility));
+    s = Select(valid, s, one);
+
+    // Price is increasing in s, so every evaluation tightens a bracket that
+    // catches steps that overshoot
+    VecD lower = zero;
+    VecD upper = Set1(kMaxTotalVolatility);
+    VecD steps = zero;
+    MaskD active = valid;
+    MaskD converged = Less(zero, zero);
+    for (int iteration = 0; iteration < kMaxImpliedVolIterations && CountTrue(active) > 0; ++iteration) {
+        VecD d1 = negLogMoneyness / s + Set1(0.5) * s;
+        VecD d2 = d1 - s;
+        VecD nd1, nMinusD1, nd2, nMinusD2;
+        NormalCdfPair<Tier>(d1, nd1, nMinusD1);
+        NormalCdfPair<Tier>(d2, nd2, nMinusD2);
+        VecD price = Select(solvePut, moneyness * nMinusD2 - nMinusD1, nd1 - moneyness * nd2);
+
+        // Solve ln(price) = ln(target): the relative error is what the
+        // tolerance bounds, and far OTM wings stay close to linear in s
+        VecD error = Log(price) - logTarget;
+        converged = converged | (active & Less(Abs(error), Set1(kImpliedVolPriceTolerance)));
+        active = active & Greater(Abs(error), Set1(kImpliedVolPriceTolerance));
+        MaskD above = Greater(error, zero);
+        upper = Select(above, s, upper);
+        lower = Select(above, lower, s);
+
+        // Halley on the log price, with price' = phi(d1) and
+        // price'' / price' = d1 d2 / s. The correction is clamped, and a
+        // step leaving the bracket (or a price that underflowed) bisects.
+        VecD vega = Exp(Set1(-0.5) * d1 * d1) * Set1(0.3989422804014327);
+        VecD newton = error * price / vega;
+        VecD curvature = d1 * d2 * price / (s * vega) - one;
+        VecD halley = Min(Max(one - Set1(0.5) * error * curvature, Set1(0.5)), Set1(2.0));
+        VecD next = s - newton / halley;
+        next = Select(Greater(next, lower) & Less(next, upper), next, Set1(0.5) * (lower + upper));
+
+        VecD step = next - s;
+        s = Select(active, next, s);
+        steps = steps + Select(active, one, zero);
+        active = active & Greater(Abs(step), s * Set1(kImpliedVolStepTolerance));
+    }
+
+    // Lanes out of iterations, or stopped by the step tolerance before the
+    // price matched, have no volatility to report
+    Store(volatilities, Select(converged, s / sqrtT, Set1(std::numeric_limits<double>::quiet_NaN())));
+    Store(iterations, steps);
+    return CountTrue(converged);
+}
+
+template <CdfAccuracy Tier>
+inline int SolveImpliedVolatility(const ImpliedVolMarket& market, const double* strikes,
+                                  const double* expiries, const double* prices, const int* isCall,
+                                  const double* guesses, std::size_t count,
+                                  double* volatilities, int* iterations) {
+    int converged = 0;
+    for (std::size_t first = 0; first < count; first += kLanes) {
+        std::size_t lanes = std::min<std::size_t>(kLanes, count - first);
+
+        // Gather into lane buffers; padding lanes (zero expiry) are invalid
+        double strikeLanes[kLanes], expiryLanes[kLanes], priceLanes[kLanes];
+        double flagLanes[kLanes], guessLanes[kLanes], volLanes[kLanes], stepLanes[kLanes];
+        for (std::size_t lane = 0; lane < static_cast<std::size_t>(kLanes); ++lane) {
+            bool used = lane < lanes;
+            strikeLanes[lane] = used ? strikes[first + lane] : market.spot;
+            expiryLanes[lane] = used ? expiries[first + lane] : 0.0;
+            priceLanes[lane] = used ? prices[first + lane] : 0.0;
+            flagLanes[lane] = used && isCall[first + lane] ? 1.0 : 0.0;
+            guessLanes[lane] = used && guesses ? guesses[first + lane] : 0.0;
+        }
+        converged += SolveImpliedVolatilityLanes<Tier>(market, strikeLanes, expiryLanes, priceLanes,
+                                                       flagLanes, guessLanes, volLanes, stepLanes);
+        for (std::size_t lane = 0; lane < lanes; ++lane) {
+            volatilities[first + lane] = volLanes[lane];
+            if (iterations) iterations[first + lane] = static_cast<int>(stepLanes[lane]);
+        }
+    }
+    return converged;
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "SimdKernels.h"
+#include "NormalCDF.h"
+
+// Implied volatility for whole option chains, the inverse of
+// OptionChainPricer.h. Each contract starts from a guess (a cached
+// solution or the Corrado-Miller approximation) and takes safeguarded
+// Halley steps on the vectorized Black-Scholes price until the price
+// matches within kImpliedVolPriceTolerance. ImpliedVolatilitySolver keeps
+// the previous solution for every (strike, expiry), so when quotes move a
+// little between bars most contracts converge in one or two steps.
+
+namespace simd {
+
+struct ImpliedVolMarket {
+    double spot = 0.0;
+    double rate = 0.0;   // Continuously compounded risk-free rate
+};
+
+// Relative price error accepted as converged, and the relative step below
+// which iteration stops (the price can no longer resolve the volatility)
+constexpr double kImpliedVolPriceTolerance = 1e-12;
+constexpr double kParityResolution = 1e-13;   // Relative to quote + intrinsic
+constexpr double kImpliedVolStepTolerance = 1e-14;
+constexpr int kMaxImpliedVolIterations = 64;
+
+// Bracket for total volatility sigma sqrt(T)
+constexpr double kMinTotalVolatility = 1e-4;
+constexpr double kMaxTotalVolatility = 100.0;
+
+namespace scalar {
+#include "ImpliedVolKernel.inl"
+} // namespace scalar
+
+#if BSTS_SIMD_X86
+BSTS_BEGIN_TARGET_AVX2
+namespace avx2 {
+#include "ImpliedVolKernel.inl"
+} // namespace avx2
+BSTS_END_TARGET
+
+BSTS_BEGIN_TARGET_AVX512
+namespace avx512 {
+#include "ImpliedVolKernel.inl"
+} // namespace avx512
+BSTS_END_TARGET
+#endif // BSTS_SIMD_X86
+
+// Solve `count` contracts given as strike/expiry (years)/price arrays;
+// isCall[i] != 0 marks calls. guesses[i] > 0 is a starting volatility
+// (guesses may be null). Quotes outside the no-arbitrage bounds, with no
+// time left, or whose time value is lost to rounding get NaN, as do
+// contracts whose price error never meets kImpliedVolPriceTolerance.
+// iterations (optional) receives the Halley steps per contract. Returns
+// the number of contracts that converged.
+template <CdfAccuracy Tier = kDefaultCdfAccuracy>
+inline int SolveImpliedVolatility(SimdLevel level, const ImpliedVolMarket& market, const double* strikes,
+                                  const double* expiries, const double* prices, const int* isCall,
+                                  const double* guesses, std::size_t count,
+                                  double* volatilities, int* iterations = nullptr) {
+    if (!(market.spot > 0.0)) {
+        std::fill(volatilities, volatilities + count, std::numeric_limits<double>::quiet_NaN());
+        if (iterations) std::fill(iterations, iterations + count, 0);
+        return 0;
+    }
+    switch (level) {
+#if BSTS_SIMD_X86
+    case SimdLevel::Avx512:
+        return avx512::SolveImpliedVolatility<Tier>(market, strikes, expiries, prices, isCall, guesses,
+                                                    count, volatilities, iterations);
+    case SimdLevel::Avx2:
+        return avx2::SolveImpliedVolatility<Tier>(market, strikes, expiries, prices, isCall, guesses,
+                                                  count, volatilities, iterations);
+#endif
+    default:
+        return scalar::SolveImpliedVolatility<Tier>(market, strikes, expiries, prices, isCall, guesses,
+                                                    count, volatilities, iterations);
+    }
+}
+
+template <CdfAccuracy Tier = kDefaultCdfAccuracy>
+inline int SolveImpliedVolatility(const ImpliedVolMarket& market, const double* strikes,
+                                  const double* expiries, const double* prices, const int* isCall,
+                                  const double* guesses, std::size_t count,
+                                  double* volatilities, int* iterations = nullptr) {
+    return SolveImpliedVolatility<Tier>(ActiveSimdLevel(), market, strikes, expiries, prices, isCall,
+                                        guesses, count, volatilities, iterations);
+}
+
+} // namespace simd
+
+// Chain solver with a warm-start cache keyed by (strike, expiry). The
+// cache is an open-addressing table with linear probing that only grows,
+// so once a chain has been seen, solving it again does not allocate.
+class ImpliedVolatilitySolver {
+private:
+    struct Entry {
+        double strike = 0.0;
+        double expiry = 0.0;
+        double volatility = 0.0;   // 0 marks an empty slot
+    };
+
+    std::vector<Entry> table;      // Power-of-two capacity
+    std::size_t entries = 0;
+    std::vector<double> guesses;   // Per-contract starting points, reused
+
+    static std::uint64_t Hash(double strike, double expiry) {
+        std::uint64_t a, b;
+        std::memcpy(&a, &strike, sizeof(a));
+        std::memcpy(&b, &expiry, sizeof(b));
+        std::uint64_t h = a * 0x9E3779B97F4A7C15ULL ^ (b + 0x632BE59BD9B4E019ULL);
+        h ^= h >> 31;
+        h *= 0xBF58476D1CE4E5B9ULL;
+        return h ^ (h >> 29);
+    }
+
+    std::size_t Slot(double strike, double expiry) const {
+        std::size_t mask = table.size() - 1;
+        std::size_t slot = static_cast<std::size_t>(Hash(strike, expiry)) & mask;
+        while (table[slot].volatility != 0.0 &&
+               (table[slot].strike != strike || table[slot].expiry != expiry)) {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+    double Find(double strike, double expiry) const {
+        return table.empty() ? 0.0 : table[Slot(strike, expiry)].volatility;
+    }
+
+    void Store(double strike, double expiry, double volatility) {
+        // Keep the load factor at or below one half
+        if (2 * (entries + 1) > table.size()) Grow();
+        Entry& entry = table[Slot(strike, expiry)];
+        if (entry.volatility == 0.0) ++entries;
+        entry.strike = strike;
+        entry.expiry = expiry;
+        entry.volatility = volatility;
+    }
+
+    void Grow() {
+        std::vector<Entry> old(std::max<std::size_t>(64, 2 * table.size()));
+        old.swap(table);
+        for (const Entry& entry : old) {
+            if (entry.volatility != 0.0) table[Slot(entry.strike, entry.expiry)] = entry;
+        }
+    }
+
+public:
+    // As simd::SolveImpliedVolatility, starting each contract from its
+    // cached solution when there is one. Solved contracts replace their
+    // cache entries; contracts left NaN keep theirs.
+    template <CdfAccuracy Tier = kDefaultCdfAccuracy>
+    int Solve(const simd::ImpliedVolMarket& market, const double* strikes, const double* expiries,
+              const double* prices, const int* isCall, std::size_t count,
+              double* volatilities, int* iterations = nullptr) {
+        guesses.resize(std::max(guesses.size(), count));
+        for (std::size_t i = 0; i < count; ++i) guesses[i] = Find(strikes[i], expiries[i]);
+
+        int converged = simd::SolveImpliedVolatility<Tier>(market, strikes, expiries, prices, isCall,
+                                                           guesses.data(), count, volatilities, iterations);
+        for (std::size_t i = 0; i < count; ++i) {
+            if (volatilities[i] > 0.0) Store(strikes[i], expiries[i], volatilities[i]);
+        }
+        return converged;
+    }
+
+    std::size_t CacheSize() const { return entries; }
+
+    void Clear() {
+        table.clear();
+        entries = 0;
+    }
+};
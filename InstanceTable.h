@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Lock-free table of owned objects addressed by integer handles, so every
+// chart and symbol loading the DLL gets its own algorithm instance.
+// Slots are claimed with a compare-and-swap and looked up with plain atomic
+// loads: Create/Destroy never block each other and Get never writes shared
+// memory, so charts running on separate threads do not contend.
+//
+// A handle packs the slot index with the slot's generation, which is bumped
+// on every Destroy, so a stale handle to a reused slot is rejected instead
+// of reaching the new owner. The owner of a handle must not destroy it
+// while another call using the same handle is still running.
+template <typename T>
+class InstanceTable {
+private:
+    static constexpr int kIndexBits = 16;
+    static constexpr std::uint32_t kIndexMask = (1u << kIndexBits) - 1;
+    static constexpr std::uint32_t kGenerationMask = 0x7FFF;   // Keeps handles positive
+
+    struct Slot {
+        std::atomic<T*> object{nullptr};
+        std::atomic<std::uint32_t> generation{0};
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    std::size_t capacity;
+    std::atomic<std::size_t> searchStart{0};   // Where the next free-slot scan begins
+
+public:
+    using Object = T;
+
+    // capacity < 65536 so the slot index fits the handle
+    explicit InstanceTable(std::size_t capacity = 4096)
+        : slots(new Slot[capacity]), capacity(capacity) {
+    }
+
+    ~InstanceTable() {
+        for (std::size_t i = 0; i < capacity; ++i) {
+            delete slots[i].object.load(std::memory_order_acquire);
+        }
+    }
+
+    InstanceTable(const InstanceTable&) = delete;
+    InstanceTable& operator=(const InstanceTable&) = delete;
+
+    // Takes ownership of `object`; returns its handle, or 0 (and deletes the
+    // object) when every slot is in use
+    int Insert(T* object) {
+        std::size_t start = searchStart.load(std::memory_order_relaxed);
+        for (std::size_t probe = 0; probe < capacity; ++probe) {
+            std::size_t index = (start + probe) % capacity;
+            T* expected = nullptr;
+            if (slots[index].object.load(std::memory_order_relaxed) == nullptr &&
+                slots[index].object.compare_exchange_strong(expected, object, std::memory_order_acq_rel)) {
+                searchStart.store(index + 1 < capacity ? index + 1 : 0, std::memory_order_relaxed);
+                std::uint32_t generation = slots[index].generation.load(std::memory_order_acquire);
+                return static_cast<int>(((generation & kGenerationMask) << kIndexBits) | (index + 1));
+            }
+        }
+        delete object;
+        return 0;
+    }
+
+    // nullptr for 0, foreign or stale handles
+    T* Get(int handle) const {
+        Slot* slot = Find(handle);
+        return slot ? slot->object.load(std::memory_order_acquire) : nullptr;
+    }
+
+    // Deletes the object; false if the handle was not live
+    bool Erase(int handle) {
+        Slot* slot = Find(handle);
+        if (!slot) return false;
+
+        // Retire the handle before the slot can be claimed again
+        std::uint32_t generation = static_cast<std::uint32_t>(handle) >> kIndexBits;
+        if (!slot->generation.compare_exchange_strong(generation, (generation + 1) & kGenerationMask,
+                                                     std::memory_order_acq_rel)) {
+            return false;
+        }
+        delete slot->object.exchange(nullptr, std::memory_order_acq_rel);
+        return true;
+    }
+
+private:
+    Slot* Find(int handle) const {
+        if (handle <= 0) return nullptr;
+        std::uint32_t bits = static_cast<std::uint32_t>(handle);
+        std::size_t index = (bits & kIndexMask) - 1;
+        if (index >= capacity) return nullptr;
+
+        Slot* slot = &slots[index];
+        if (slot->generation.load(std::memory_order_acquire) != (bits >> kIndexBits)) return nullptr;
+        return slot;
+    }
+};
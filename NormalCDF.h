@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+#include "SimdKernels.h"
+
+// Standard normal CDF in three accuracy tiers, chosen at compile time:
+//
+//   Libm      0.5 * erfc(-x / sqrt(2)), full libm precision (reference)
+//   Rational  Hart/West rational approximation, absolute error ~1e-15
+//   Fast      Zelen-Severo polynomial, absolute error < 7.5e-8
+//
+// Scalar code calls NormalCDF<Tier>(x); vector kernels call
+// simd::<isa>::NormalCdf<Tier> / NormalCdfPair<Tier> on VecD lanes, and
+// simd::NormalCdf<Tier>(level, x, count, out) evaluates arrays. The
+// Rational and Fast tiers use only the vector exp and FMA arithmetic, so
+// batch pricing never waits on libm. BSTS_CDF_ACCURACY picks the tier the
+// engine uses by default (Rational unless overridden).
+
+enum class CdfAccuracy {
+    Libm,
+    Rational,
+    Fast
+};
+
+template <CdfAccuracy Tier>
+using CdfTier = std::integral_constant<CdfAccuracy, Tier>;
+
+#ifndef BSTS_CDF_ACCURACY
+#define BSTS_CDF_ACCURACY Rational
+#endif
+constexpr CdfAccuracy kDefaultCdfAccuracy = CdfAccuracy::BSTS_CDF_ACCURACY;
+
+namespace simd {
+
+namespace scalar {
+#include "NormalCDF.inl"
+} // namespace scalar
+
+#if BSTS_SIMD_X86
+BSTS_BEGIN_TARGET_AVX2
+namespace avx2 {
+#include "NormalCDF.inl"
+} // namespace avx2
+BSTS_END_TARGET
+
+BSTS_BEGIN_TARGET_AVX512
+namespace avx512 {
+#include "NormalCDF.inl"
+} // namespace avx512
+BSTS_END_TARGET
+#endif // BSTS_SIMD_X86
+
+// Batch evaluation on the given ISA: out[i] = N(x[i])
+template <CdfAccuracy Tier = kDefaultCdfAccuracy>
+inline void NormalCdf(SimdLevel level, const double* x, std::size_t count, double* out) {
+    switch (level) {
+#if BSTS_SIMD_X86
+    case SimdLevel::Avx512:
+        avx512::NormalCdfArray<Tier>(x, count, out);
+        return;
+    case SimdLevel::Avx2:
+        avx2::NormalCdfArray<Tier>(x, count, out);
+        return;
+#endif
+    default:
+        scalar::NormalCdfArray<Tier>(x, count, out);
+        return;
+    }
+}
+
+} // namespace simd
+
+// Scalar entry points: the vector code on one lane (compiled to selects
+// rather than branches), or libm for the reference tier
+template <CdfAccuracy Tier = kDefaultCdfAccuracy>
+inline double NormalCDF(double x) {
+    return simd::scalar::NormalCdf<Tier>(simd::scalar::VecD{x}).v;
+}
+
+template <>
+inline double NormalCDF<CdfAccuracy::Libm>(double x) {
+    return 0.5 * std::erfc(-x * 0.70710678118654752);
+}
@@ -0,0 +1,101 @@
+// ISA-generic normal CDF tiers. Included once per ISA namespace by
+// NormalCDF.h, after SimdKernels.h has defined that namespace's lane
+// primitives and vector math; do not include directly.
+//
+// Every tier returns N(x) and N(-x) from one evaluation, so neither tail
+// loses precision to 1 - N(x). Tiers are chosen by tag, so the choice is
+// made at compile time and the lane loop stays branch-free.
+
+// Reference tier: libm erfc lane by lane
+inline void NormalCdfPair(CdfTier<CdfAccuracy::Libm>, VecD x, VecD& lower, VecD& upper) {
+    double lanes[kLanes], lowerLanes[kLanes], upperLanes[kLanes];
+    Store(lanes, x);
+    for (int i = 0; i < kLanes; ++i) {
+        lowerLanes[i] = 0.5 * std::erfc(-lanes[i] * 0.70710678118654752);
+        upperLanes[i] = 0.5 * std::erfc(lanes[i] * 0.70710678118654752);
+    }
+    lower = Load(lowerLanes);
+    upper = Load(upperLanes);
+}
+
+// Hart (1968) algorithm 5666 in the form given by West, "Better
+// approximations to cumulative normal functions": absolute error ~1e-15
+inline void NormalCdfPair(CdfTier<CdfAccuracy::Rational>, VecD x, VecD& lower, VecD& upper) {
+    VecD ax = Abs(x);
+    VecD e = Exp(Set1(-0.5) * ax * ax);
+
+    VecD num = Set1(3.52624965998911e-02);
+    num = Fma(num, ax, Set1(0.700383064443688));
+    num = Fma(num, ax, Set1(6.37396220353165));
+    num = Fma(num, ax, Set1(33.912866078383));
+    num = Fma(num, ax, Set1(112.079291497871));
+    num = Fma(num, ax, Set1(221.213596169931));
+    num = Fma(num, ax, Set1(220.206867912376));
+    VecD den = Set1(8.83883476483184e-02);
+    den = Fma(den, ax, Set1(1.75566716318264));
+    den = Fma(den, ax, Set1(16.064177579207));
+    den = Fma(den, ax, Set1(86.7807322029461));
+    den = Fma(den, ax, Set1(296.564248779674));
+    den = Fma(den, ax, Set1(637.333633378831));
+    den = Fma(den, ax, Set1(793.826512519948));
+    den = Fma(den, ax, Set1(440.413735824752));
+    VecD central = e * num / den;
+
+    // Continued fraction for the far tail
+    VecD fraction = ax + Set1(0.65);
+    fraction = ax + Set1(4.0) / fraction;
+    fraction = ax + Set1(3.0) / fraction;
+    fraction = ax + Set1(2.0) / fraction;
+    fraction = ax + Set1(1.0) / fraction;
+    VecD far = e / (fraction * Set1(2.506628274631));
+
+    VecD tail = Select(Less(ax, Set1(7.07106781186547)), central, far);
+    tail = Select(Greater(ax, Set1(37.0)), Set1(0.0), tail);
+    MaskD positive = Greater(x, Set1(0.0));
+    lower = Select(positive, Set1(1.0) - tail, tail);
+    upper = Select(positive, tail, Set1(1.0) - tail);
+}
+
+// Zelen & Severo (Abramowitz & Stegun 26.2.17): one division and a
+// degree-5 polynomial, absolute error < 7.5e-8
+inline void NormalCdfPair(CdfTier<CdfAccuracy::Fast>, VecD x, VecD& lower, VecD& upper) {
+    VecD ax = Min(Abs(x), Set1(38.0));
+    VecD t = Set1(1.0) / Fma(ax, Set1(0.2316419), Set1(1.0));
+    VecD p = Set1(1.330274429);
+    p = Fma(p, t, Set1(-1.821255978));
+    p = Fma(p, t, Set1(1.781477937));
+    p = Fma(p, t, Set1(-0.356563782));
+    p = Fma(p, t, Set1(0.319381530));
+    VecD tail = Exp(Set1(-0.5) * ax * ax) * Set1(0.3989422804014327) * p * t;
+
+    MaskD positive = Greater(x, Set1(0.0));
+    lower = Select(positive, Set1(1.0) - tail, tail);
+    upper = Select(positive, tail, Set1(1.0) - tail);
+}
+
+template <CdfAccuracy Tier>
+inline void NormalCdfPair(VecD x, VecD& lower, VecD& upper) {
+    NormalCdfPair(CdfTier<Tier>(), x, lower, upper);
+}
+
+template <CdfAccuracy Tier>
+inline VecD NormalCdf(VecD x) {
+    VecD lower, upper;
+    NormalCdfPair(CdfTier<Tier>(), x, lower, upper);
+    return lower;
+}
+
+// out[i] = N(x[i]); the tail is padded with zeros
+template <CdfAccuracy Tier>
+inline void NormalCdfArray(const double* x, std::size_t count, double* out) {
+    std::size_t i = 0;
+    for (; i + kLanes <= count; i += kLanes) {
+        Store(out + i, NormalCdf<Tier>(Load(x + i)));
+    }
+    if (i < count) {
+        double padded[kLanes] = {};
+        for (std::size_t lane = 0; i + lane < count; ++lane) padded[lane] = x[i + lane];
+        Store(padded, NormalCdf<Tier>(Load(padded)));
+        for (std::size_t lane = 0; i + lane < count; ++lane) out[i + lane] = padded[lane];
+    }
+}
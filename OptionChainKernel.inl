@@ -0,0 +1,114 @@
+// ISA-generic option chain kernel. Included once per ISA namespace by
+// OptionChainPricer.h, after SimdKernels.h and NormalCDF.h have defined
+// that namespace's lane primitives and vector math; do not include directly.
+// Tier selects the normal CDF accuracy (see NormalCDF.h).
+
+// Terms shared by every strike of one expiry
+struct ExpiryTerms {
+    VecD spot;
+    VecD logSpotDrift;   // ln(S) + (r + sigma^2/2) T
+    VecD volSqrtT;       // sigma sqrt(T)
+    VecD invVolSqrtT;
+    VecD discount;       // e^{-rT}
+    VecD rate;
+    VecD gammaScale;     // 1 / (S sigma sqrt(T))
+    VecD vegaScale;      // S sqrt(T)
+    VecD thetaScale;     // -S sigma / (2 sqrt(T))
+};
+
+struct OptionLanes {
+    VecD callPrice, putPrice, callDelta, putDelta, gamma, vega, callTheta, putTheta;
+};
+
+template <CdfAccuracy Tier>
+inline OptionLanes EvaluateOptions(const ExpiryTerms& terms, VecD strike) {
+    VecD d1 = (terms.logSpotDrift - Log(strike)) * terms.invVolSqrtT;
+    VecD d2 = d1 - terms.volSqrtT;
+    VecD nd1, nMinusD1, nd2, nMinusD2;
+    NormalCdfPair<Tier>(d1, nd1, nMinusD1);
+    NormalCdfPair<Tier>(d2, nd2, nMinusD2);
+    VecD density = Exp(Set1(-0.5) * d1 * d1) * Set1(0.3989422804014327);
+    VecD discountedStrike = strike * terms.discount;
+    VecD carry = terms.rate * discountedStrike;
+    VecD decay = density * terms.thetaScale;
+
+    OptionLanes lanes;
+    lanes.callPrice = Max(terms.spot * nd1 - discountedStrike * nd2, Set1(0.0));
+    lanes.putPrice = Max(discountedStrike * nMinusD2 - terms.spot * nMinusD1, Set1(0.0));
+    lanes.callDelta = nd1;
+    lanes.putDelta = -nMinusD1;
+    lanes.gamma = density * terms.gammaScale;
+    lanes.vega = density * terms.vegaScale;
+    lanes.callTheta = decay - carry * nd2;
+    lanes.putTheta = decay + carry * nMinusD2;
+    return lanes;
+}
+
+inline void StoreOptions(const OptionLanes& lanes, const OptionChainOutputs& out,
+                         std::size_t index, std::size_t count) {
+    VecD const* values[8] = {&lanes.callPrice, &lanes.putPrice, &lanes.callDelta, &lanes.putDelta,
+                             &lanes.gamma, &lanes.vega, &lanes.callTheta, &lanes.putTheta};
+    double* targets[8] = {out.callPrice, out.putPrice, out.callDelta, out.putDelta,
+                          out.gamma, out.vega, out.callTheta, out.putTheta};
+    for (int i = 0; i < 8; ++i) {
+        if (!targets[i]) continue;
+        if (count == static_cast<std::size_t>(kLanes)) {
+            Store(targets[i] + index, *values[i]);
+        } else {
+            double buffer[kLanes];
+            Store(buffer, *values[i]);
+            for (std::size_t lane = 0; lane < count; ++lane) targets[i][index + lane] = buffer[lane];
+        }
+    }
+}
+
+// Contracts [first, first + count) all expire at `expiry`
+template <CdfAccuracy Tier>
+inline void PriceExpiryRun(const OptionChainMarket& market, double expiry, const double* strikes,
+                           std::size_t first, std::size_t count, const OptionChainOutputs& out) {
+    if (!(expiry > 0.0) || !(market.volatility > 0.0)) {
+        PriceExpiredRun(market, expiry, strikes, first, count, out);
+        return;
+    }
+
+    double sqrtT = std::sqrt(expiry);
+    double volSqrtT = market.volatility * sqrtT;
+    ExpiryTerms terms;
+    terms.spot = Set1(market.spot);
+    terms.logSpotDrift = Set1(std::log(market.spot) +
+                              (market.rate + 0.5 * market.volatility * market.volatility) * expiry);
+    terms.volSqrtT = Set1(volSqrtT);
+    terms.invVolSqrtT = Set1(1.0 / volSqrtT);
+    terms.discount = Set1(std::exp(-market.rate * expiry));
+    terms.rate = Set1(market.rate);
+    terms.gammaScale = Set1(1.0 / (market.spot * volSqrtT));
+    terms.vegaScale = Set1(market.spot * sqrtT);
+    terms.thetaScale = Set1(-0.5 * market.spot * market.volatility / sqrtT);
+
+    std::size_t i = 0;
+    for (; i + kLanes <= count; i += kLanes) {
+        StoreOptions(EvaluateOptions<Tier>(terms, Load(strikes + first + i)), out, first + i, kLanes);
+    }
+    if (i < count) {
+        // Pad the tail with at-the-money strikes (always finite)
+        double padded[kLanes];
+        for (int lane = 0; lane < kLanes; ++lane) {
+            padded[lane] = i + lane < count ? strikes[first + i + lane] : market.spot;
+        }
+        StoreOptions(EvaluateOptions<Tier>(terms, Load(padded)), out, first + i, count - i);
+    }
+}
+
+// Maximal runs of equal expiry share their expiry terms, so chains sorted
+// by expiry get the full benefit; any order gives the same results
+template <CdfAccuracy Tier>
+inline void PriceOptionChain(const OptionChainMarket& market, const double* strikes,
+                             const double* expiries, std::size_t count, const OptionChainOutputs& out) {
+    std::size_t first = 0;
+    while (first < count) {
+        std::size_t end = first + 1;
+        while (end < count && expiries[end] == expiries[first]) ++end;
+        PriceExpiryRun<Tier>(market, expiries[first], strikes, first, end - first, out);
+        first = end;
+    }
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+#include "SimdKernels.h"
+#include "NormalCDF.h"
+
+// Batch Black-Scholes pricing for option chains.
+// Contracts are given as structure-of-arrays (strike, expiry) pairs. Terms
+// that depend only on the expiry (sqrt(T), discount factor, drift) are
+// computed once per run of equal expiries, and the strike loop runs on the
+// SIMD lane primitives of SimdKernels.h with vector log, exp and normal
+// CDF. One pass yields call and put prices and their Greeks. The CDF tier
+// is a template argument (default kDefaultCdfAccuracy); CdfAccuracy::Fast
+// trades accuracy (~1e-7 in N) for throughput.
+
+namespace simd {
+
+struct OptionChainMarket {
+    double spot = 0.0;
+    double rate = 0.0;         // Continuously compounded risk-free rate
+    double volatility = 0.0;   // Annualized
+};
+
+// Output arrays, one entry per contract; any pointer may be null to skip
+// that output. Vega is per unit of volatility and theta per year, as in
+// the closed-form derivatives; gamma and vega are shared by calls and puts.
+struct OptionChainOutputs {
+    double* callPrice = nullptr;
+    double* putPrice = nullptr;
+    double* callDelta = nullptr;
+    double* putDelta = nullptr;
+    double* gamma = nullptr;
+    double* vega = nullptr;
+    double* callTheta = nullptr;
+    double* putTheta = nullptr;
+};
+
+// Expired contracts (T <= 0) or zero volatility: the sigma -> 0 limit of
+// Black-Scholes. The spot grows at the rate, so a live contract is worth
+// its intrinsic value against the discounted strike, max(S - K e^{-rT}, 0)
+// for calls; expired contracts get the plain intrinsic value. Deltas are
+// steps, there is no curvature, and theta is the carry of the discounted
+// strike on contracts in the money.
+inline void PriceExpiredRun(const OptionChainMarket& market, double expiry, const double* strikes,
+                            std::size_t first, std::size_t count, const OptionChainOutputs& out) {
+    bool live = expiry > 0.0;
+    double discount = live ? std::exp(-market.rate * expiry) : 1.0;
+    double rate = live ? market.rate : 0.0;
+    for (std::size_t i = first; i < first + count; ++i) {
+        double discountedStrike = strikes[i] * discount;
+        bool inTheMoney = market.spot > discountedStrike;
+        if (out.callPrice) out.callPrice[i] = inTheMoney ? market.spot - discountedStrike : 0.0;
+        if (out.putPrice) out.putPrice[i] = inTheMoney ? 0.0 : discountedStrike - market.spot;
+        if (out.callDelta) out.callDelta[i] = inTheMoney ? 1.0 : 0.0;
+        if (out.putDelta) out.putDelta[i] = inTheMoney ? 0.0 : -1.0;
+        if (out.gamma) out.gamma[i] = 0.0;
+        if (out.vega) out.vega[i] = 0.0;
+        if (out.callTheta) out.callTheta[i] = inTheMoney ? -rate * discountedStrike : 0.0;
+        if (out.putTheta) out.putTheta[i] = inTheMoney ? 0.0 : rate * discountedStrike;
+    }
+}
+
+namespace scalar {
+#include "OptionChainKernel.inl"
+} // namespace scalar
+
+#if BSTS_SIMD_X86
+BSTS_BEGIN_TARGET_AVX2
+namespace avx2 {
+#include "OptionChainKernel.inl"
+} // namespace avx2
+BSTS_END_TARGET
+
+BSTS_BEGIN_TARGET_AVX512
+namespace avx512 {
+#include "OptionChainKernel.inl"
+} // namespace avx512
+BSTS_END_TARGET
+#endif // BSTS_SIMD_X86
+
+template <CdfAccuracy Tier = kDefaultCdfAccuracy>
+inline void PriceOptionChain(SimdLevel level, const OptionChainMarket& market, const double* strikes,
+                             const double* expiries, std::size_t count, const OptionChainOutputs& out) {
+    switch (level) {
+#if BSTS_SIMD_X86
+    case SimdLevel::Avx512:
+        avx512::PriceOptionChain<Tier>(market, strikes, expiries, count, out);
+        return;
+    case SimdLevel::Avx2:
+        avx2::PriceOptionChain<Tier>(market, strikes, expiries, count, out);
+        return;
+#endif
+    default:
+        scalar::PriceOptionChain<Tier>(market, strikes, expiries, count, out);
+        return;
+    }
+}
+
+template <CdfAccuracy Tier = kDefaultCdfAccuracy>
+inline void PriceOptionChain(const OptionChainMarket& market, const double* strikes,
+                             const double* expiries, std::size_t count, const OptionChainOutputs& out) {
+    PriceOptionChain<Tier>(ActiveSimdLevel(), market, strikes, expiries, count, out);
+}
+
+} // namespace simd
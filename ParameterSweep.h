@@ -0,0 +1,289 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#include "Backtester.h"
+#include "ThreadPool.h"
+
+// Grid search and walk-forward reoptimization over strategy parameters.
+// The bar series is passed once as a read-only view that every worker
+// reads in place. Each (parameters, window) evaluation is independent and
+// runs on the shared ThreadPool; workers start on equal slices of the task
+// list and steal half of a busy worker's remainder when they run out, so a
+// few slow combinations (long lookbacks, many simulations) do not leave the
+// other cores idle. Results are stored by task index, and evaluations seed
+// their own random streams, so the tables do not depend on thread count or
+// scheduling.
+
+struct SweepParameters {
+    double riskFreeRate = 0.02;
+    double maxPositionSize = 0.1;
+    double stopLossPercent = 0.05;
+    double takeProfitPercent = 0.15;
+    int lookbackPeriod = 252;
+    int monteCarloSimulations = 1000;
+    double minConfidence = 0.5;       // Entry gates, as in the ELD strategy
+    double minSignalStrength = 0.3;
+};
+
+struct SweepResult {
+    SweepParameters parameters;
+    BacktestMetrics metrics;
+};
+
+// Every listed value of every parameter is combined with every other
+struct ParameterGrid {
+    std::vector<double> riskFreeRates = {0.02};
+    std::vector<double> maxPositionSizes = {0.1};
+    std::vector<double> stopLossPercents = {0.05};
+    std::vector<double> takeProfitPercents = {0.15};
+    std::vector<int> lookbackPeriods = {252};
+    std::vector<int> monteCarloSimulations = {1000};
+    std::vector<double> minConfidences = {0.5};
+    std::vector<double> minSignalStrengths = {0.3};
+
+    std::vector<SweepParameters> Combinations() const {
+        std::vector<SweepParameters> combinations;
+        SweepParameters p;
+        for (double rate : riskFreeRates) {
+            p.riskFreeRate = rate;
+            for (double size : maxPositionSizes) {
+                p.maxPositionSize = size;
+                for (double stop : stopLossPercents) {
+                    p.stopLossPercent = stop;
+                    for (double target : takeProfitPercents) {
+                        p.takeProfitPercent = target;
+                        for (int lookback : lookbackPeriods) {
+                            p.lookbackPeriod = lookback;
+                            for (int sims : monteCarloSimulations) {
+                                p.monteCarloSimulations = sims;
+                                for (double confidence : minConfidences) {
+                                    p.minConfidence = confidence;
+                                    for (double strength : minSignalStrengths) {
+                                        p.minSignalStrength = strength;
+                                        combinations.push_back(p);
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        return combinations;
+    }
+};
+
+// Bar ranges [begin, end) of one walk-forward step
+struct WalkForwardWindow {
+    std::size_t trainBegin = 0;
+    std::size_t trainEnd = 0;
+    std::size_t testBegin = 0;
+    std::size_t testEnd = 0;
+};
+
+// Training and test lengths and the roll between windows, in bars. The
+// defaults are the guide's 2 years / 6 months / 3 months of daily bars.
+struct WalkForwardSchedule {
+    std::size_t trainBars = 504;
+    std::size_t testBars = 126;
+    std::size_t stepBars = 63;
+};
+
+// Every window whose test range fits inside barCount bars
+inline std::vector<WalkForwardWindow> WalkForwardWindows(std::size_t barCount,
+                                                         const WalkForwardSchedule& schedule) {
+    std::vector<WalkForwardWindow> windows;
+    std::size_t step = std::max<std::size_t>(schedule.stepBars, 1);
+    for (std::size_t begin = 0; begin + schedule.trainBars + schedule.testBars <= barCount; begin += step) {
+        WalkForwardWindow window;
+        window.trainBegin = begin;
+        window.trainEnd = begin + schedule.trainBars;
+        window.testBegin = window.trainEnd;
+        window.testEnd = window.trainEnd + schedule.testBars;
+        windows.push_back(window);
+    }
+    return windows;
+}
+
+// Task indices [0, count) split into one range per worker. A worker takes
+// from the front of its own range; once that is empty it takes the back
+// half of another worker's range. Ranges are guarded by their own mutex and
+// no thread ever holds two, so stealing cannot deadlock.
+class WorkStealingRanges {
+private:
+    // Padded so neighbouring ranges do not share a cache line (plain
+    // padding rather than alignas, which C++14 new[] cannot honour)
+    struct Range {
+        std::mutex mutex;
+        std::size_t begin = 0;
+        std::size_t end = 0;
+        char padding[64];
+    };
+
+    std::unique_ptr<Range[]> ranges;
+    int workers;
+
+public:
+    WorkStealingRanges(std::size_t count, int workerCount)
+        : ranges(new Range[std::max(workerCount, 1)]), workers(std::max(workerCount, 1)) {
+        for (int w = 0; w < workers; ++w) {
+            ranges[w].begin = count * w / workers;
+            ranges[w].end = count * (w + 1) / workers;
+        }
+    }
+
+    // Next task for `worker`; false once every range is empty
+    bool Next(int worker, std::size_t& task) {
+        {
+            Range& own = ranges[worker];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (own.begin < own.end) {
+                task = own.begin++;
+                return true;
+            }
+        }
+        for (int offset = 1; offset < workers; ++offset) {
+            Range& victim = ranges[(worker + offset) % workers];
+            std::size_t begin, end;
+            {
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if (victim.begin >= victim.end) continue;
+                begin = victim.begin + (victim.end - victim.begin) / 2;
+                end = victim.end;
+                victim.end = begin;
+            }
+            // Run the first stolen task now and keep the rest stealable
+            Range& own = ranges[worker];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            own.begin = begin + 1;
+            own.end = end;
+            task = begin;
+            return true;
+        }
+        return false;
+    }
+};
+
+// Run task(i) for every i in [0, count) across the pool with work stealing
+template <typename Task>
+void RunWorkStealing(ThreadPool& pool, std::size_t count, const Task& task) {
+    int workers = static_cast<int>(std::min<std::size_t>(pool.ThreadCount(), std::max<std::size_t>(count, 1)));
+    WorkStealingRanges ranges(count, workers);
+    pool.ParallelFor(workers, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t worker = begin; worker < end; ++worker) {
+            std::size_t index;
+            while (ranges.Next(static_cast<int>(worker), index)) task(index);
+        }
+    });
+}
+
+// Best first: Sharpe ratio, then total return; equal results keep grid order
+inline void RankResults(std::vector<SweepResult>& results) {
+    std::stable_sort(results.begin(), results.end(), [](const SweepResult& a, const SweepResult& b) {
+        if (a.metrics.sharpeRatio != b.metrics.sharpeRatio) return a.metrics.sharpeRatio > b.metrics.sharpeRatio;
+        return a.metrics.totalReturn > b.metrics.totalReturn;
+    });
+}
+
+// Evaluate every combination over bars [begin, end). evaluate(parameters,
+// bars, begin, end) returns BacktestMetrics and must be thread-safe; bars
+// before `begin` are available to it for warm-up. Results come back ranked.
+template <typename Evaluate>
+std::vector<SweepResult> RunParameterSweep(const BarSeries& bars, std::size_t begin, std::size_t end,
+                                           const std::vector<SweepParameters>& combinations,
+                                           const Evaluate& evaluate, ThreadPool& pool = SharedThreadPool()) {
+    std::vector<SweepResult> results(combinations.size());
+    RunWorkStealing(pool, combinations.size(), [&](std::size_t i) {
+        results[i].parameters = combinations[i];
+        results[i].metrics = evaluate(combinations[i], bars, begin, end);
+    });
+    RankResults(results);
+    return results;
+}
+
+struct WalkForwardReport {
+    WalkForwardWindow window;
+    std::vector<SweepResult> ranked;   // Every combination on the training range, best first
+    BacktestMetrics outOfSample;          // The best combination on the test range
+};
+
+// Optimize on each training range and score the winner on the test range
+// that follows it. All training evaluations of all windows are scheduled
+// as one job, then all test evaluations as a second, to keep every core busy.
+template <typename Evaluate>
+std::vector<WalkForwardReport> RunWalkForward(const BarSeries& bars,
+                                              const std::vector<SweepParameters>& combinations,
+                                              const WalkForwardSchedule& schedule, const Evaluate& evaluate,
+                                              ThreadPool& pool = SharedThreadPool()) {
+    std::vector<WalkForwardWindow> windows = WalkForwardWindows(bars.count, schedule);
+    std::vector<WalkForwardReport> reports(windows.size());
+    if (combinations.empty()) return reports;
+
+    std::size_t perWindow = combinations.size();
+    for (std::size_t w = 0; w < windows.size(); ++w) {
+        reports[w].window = windows[w];
+        reports[w].ranked.resize(perWindow);
+    }
+    RunWorkStealing(pool, windows.size() * perWindow, [&](std::size_t task) {
+        WalkForwardReport& report = reports[task / perWindow];
+        SweepResult& result = report.ranked[task % perWindow];
+        result.parameters = combinations[task % perWindow];
+        result.metrics = evaluate(result.parameters, bars, report.window.trainBegin, report.window.trainEnd);
+    });
+    for (WalkForwardReport& report : reports) RankResults(report.ranked);
+
+    RunWorkStealing(pool, reports.size(), [&](std::size_t w) {
+        WalkForwardReport& report = reports[w];
+        report.outOfSample = evaluate(report.ranked.front().parameters, bars, report.window.testBegin,
+                                      report.window.testEnd);
+    });
+    return reports;
+}
+
+// Fixed-width table of the top `rows` results
+inline void WriteRankedTable(std::ostream& out, const std::vector<SweepResult>& ranked, std::size_t rows) {
+    out << " Rank    Rate   Size   Stop   Take  Look   Sims   Conf  Strength   Sharpe   Return    MaxDD  Trades    Win\n";
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed;
+    for (std::size_t i = 0; i < std::min(rows, ranked.size()); ++i) {
+        const SweepParameters& p = ranked[i].parameters;
+        const BacktestMetrics& m = ranked[i].metrics;
+        out << std::setw(5) << i + 1 << std::setprecision(3)
+            << std::setw(8) << p.riskFreeRate << std::setw(7) << p.maxPositionSize
+            << std::setw(7) << p.stopLossPercent << std::setw(7) << p.takeProfitPercent
+            << std::setw(6) << p.lookbackPeriod << std::setw(7) << p.monteCarloSimulations
+            << std::setprecision(2) << std::setw(7) << p.minConfidence << std::setw(10) << p.minSignalStrength
+            << std::setprecision(3) << std::setw(9) << m.sharpeRatio << std::setw(9) << m.totalReturn
+            << std::setw(9) << m.maxDrawdown << std::setw(8) << m.trades
+            << std::setprecision(2) << std::setw(7) << m.winRate << "\n";
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
+
+// One ranked table per window, each followed by the out-of-sample result
+inline void WriteWalkForwardReport(std::ostream& out, const std::vector<WalkForwardReport>& reports,
+                                   std::size_t rowsPerWindow = 10) {
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    for (std::size_t w = 0; w < reports.size(); ++w) {
+        const WalkForwardReport& report = reports[w];
+        out << "Window " << w + 1 << ": train bars [" << report.window.trainBegin << ", "
+            << report.window.trainEnd << "), test bars [" << report.window.testBegin << ", "
+            << report.window.testEnd << ")\n";
+        WriteRankedTable(out, report.ranked, rowsPerWindow);
+        out << std::fixed << std::setprecision(3) << "Out of sample: Sharpe " << report.outOfSample.sharpeRatio
+            << ", return " << report.outOfSample.totalReturn << ", max drawdown "
+            << report.outOfSample.maxDrawdown << ", trades " << report.outOfSample.trades << "\n\n";
+        out.flags(flags);
+        out.precision(precision);
+    }
+}
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Optional per-stage latency instrumentation. Build with BSTS_PERF_STATS=1
+// to time the stages of every AnalyzeBar and UpdateTick call into fixed-size histograms;
+// by default the spans expand to nothing and the instance carries no
+// histograms, so the disabled build is unchanged.
+//
+// Histograms are log-linear: eight buckets per power of two nanoseconds,
+// so a percentile is accurate to within 1/16 of its value. Buckets are
+// relaxed atomics, so stats can be read (GetPerfStats) from any thread
+// while the chart thread records, without locks or allocation.
+#ifndef BSTS_PERF_STATS
+#define BSTS_PERF_STATS 0
+#endif
+
+enum class PerfStage {
+    History = 0,      // Price window and return statistics update
+    Volatility = 1,   // Volatility estimate and its history
+    Simulation = 2,   // Terminal distribution (Monte Carlo or analytic)
+    Pricing = 3,      // Black-Scholes call/put valuation
+    Position = 4,     // Position mark-to-market
+    Bar = 5,          // Whole AnalyzeBar call
+    Tick = 6          // Whole UpdateTick call (its evaluations also count as Simulation/Pricing)
+};
+constexpr int kPerfStageCount = 7;
+
+// Event counters, reported after the stage rows of PerfStats::Table
+enum class PerfCounter {
+    SignalCacheHit = 0,    // Bar signals served from the signal cache
+    SignalCacheMiss = 1    // Cacheable bar signals that had to be computed
+};
+constexpr int kPerfCounterCount = 2;
+
+// Fields reported per stage by PerfStats::Table, in this order; times in
+// microseconds
+enum PerfStatField {
+    kPerfCount,
+    kPerfMean,
+    kPerfP50,
+    kPerfP90,
+    kPerfP99,
+    kPerfMax,
+    kPerfStatFieldCount
+};
+
+// Full PerfStats::Table: every stage row, then every counter
+constexpr int kPerfTableSize = kPerfStageCount * kPerfStatFieldCount + kPerfCounterCount;
+
+class LatencyHistogram {
+private:
+    static constexpr int kSubBucketBits = 3;
+    static constexpr int kSubBuckets = 1 << kSubBucketBits;
+    static constexpr int kOctaves = 40;   // Up to 2^42 ns (over an hour)
+    static constexpr int kBuckets = kSubBuckets * kOctaves;
+
+    std::atomic<std::uint64_t> buckets[kBuckets];
+    std::atomic<std::uint64_t> count;
+    std::atomic<std::uint64_t> sum;
+    std::atomic<std::uint64_t> max;
+
+    static int Bucket(std::uint64_t nanoseconds) {
+        if (nanoseconds < kSubBuckets) return static_cast<int>(nanoseconds);
+        int octave = 63 - LeadingZeros(nanoseconds);   // >= kSubBucketBits
+        int sub = static_cast<int>(nanoseconds >> (octave - kSubBucketBits)) & (kSubBuckets - 1);
+        return std::min((octave - kSubBucketBits + 1) * kSubBuckets + sub, kBuckets - 1);
+    }
+
+    // Midpoint of a bucket's range
+    static double BucketValue(int bucket) {
+        if (bucket < kSubBuckets) return bucket;
+        int octave = bucket / kSubBuckets + kSubBucketBits - 1;
+        double width = static_cast<double>(std::uint64_t(1) << (octave - kSubBucketBits));
+        return (kSubBuckets + bucket % kSubBuckets + 0.5) * width;
+    }
+
+    static int LeadingZeros(std::uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_clzll(value);
+#else
+        int zeros = 0;
+        for (std::uint64_t bit = std::uint64_t(1) << 63; !(value & bit); bit >>= 1) ++zeros;
+        return zeros;
+#endif
+    }
+
+public:
+    LatencyHistogram() { Reset(); }
+
+    void Record(std::uint64_t nanoseconds) {
+        buckets[Bucket(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(nanoseconds, std::memory_order_relaxed);
+        std::uint64_t previous = max.load(std::memory_order_relaxed);
+        while (nanoseconds > previous &&
+               !max.compare_exchange_weak(previous, nanoseconds, std::memory_order_relaxed)) {
+        }
+    }
+
+    std::uint64_t Count() const { return count.load(std::memory_order_relaxed); }
+    double MaxNanoseconds() const { return static_cast<double>(max.load(std::memory_order_relaxed)); }
+
+    double MeanNanoseconds() const {
+        std::uint64_t n = Count();
+        return n > 0 ? static_cast<double>(sum.load(std::memory_order_relaxed)) / n : 0.0;
+    }
+
+    // Value below which `quantile` (0..1) of the samples fall; 0 when empty.
+    // A read racing with Record may see slightly inconsistent totals, which
+    // only moves the result by a bucket.
+    double PercentileNanoseconds(double quantile) const {
+        std::uint64_t counts[kBuckets];
+        std::uint64_t total = 0;
+        for (int b = 0; b < kBuckets; ++b) total += counts[b] = buckets[b].load(std::memory_order_relaxed);
+        if (total == 0) return 0.0;
+        std::uint64_t rank = static_cast<std::uint64_t>(std::max(quantile, 0.0) * (total - 1));
+        std::uint64_t seen = 0;
+        for (int b = 0; b < kBuckets; ++b) {
+            seen += counts[b];
+            if (seen > rank) return std::min(BucketValue(b), MaxNanoseconds());
+        }
+        return MaxNanoseconds();
+    }
+
+    void Reset() {
+        for (std::atomic<std::uint64_t>& bucket : buckets) bucket.store(0, std::memory_order_relaxed);
+        count.store(0, std::memory_order_relaxed);
+        sum.store(0, std::memory_order_relaxed);
+        max.store(0, std::memory_order_relaxed);
+    }
+};
+
+// One histogram per stage, plus the event counters
+class PerfStats {
+private:
+    LatencyHistogram stages[kPerfStageCount];
+    std::atomic<std::uint64_t> counters[kPerfCounterCount];
+
+public:
+    PerfStats() { ResetCounters(); }
+
+    LatencyHistogram& operator[](PerfStage stage) { return stages[static_cast<int>(stage)]; }
+    const LatencyHistogram& operator[](PerfStage stage) const { return stages[static_cast<int>(stage)]; }
+
+    void Increment(PerfCounter counter) {
+        counters[static_cast<int>(counter)].fetch_add(1, std::memory_order_relaxed);
+    }
+    std::uint64_t Count(PerfCounter counter) const {
+        return counters[static_cast<int>(counter)].load(std::memory_order_relaxed);
+    }
+
+    // Stage-major table of kPerfStatFieldCount values per stage, for up to
+    // capacity / kPerfStatFieldCount stages, followed by the counters when
+    // capacity reaches kPerfTableSize; returns the stages written
+    int Table(double* out, int capacity) const {
+        int rows = out ? std::min(kPerfStageCount, capacity / kPerfStatFieldCount) : 0;
+        for (int s = 0; s < rows; ++s) {
+            const LatencyHistogram& histogram = stages[s];
+            double* row = out + s * kPerfStatFieldCount;
+            row[kPerfCount] = static_cast<double>(histogram.Count());
+            row[kPerfMean] = histogram.MeanNanoseconds() * 1e-3;
+            row[kPerfP50] = histogram.PercentileNanoseconds(0.50) * 1e-3;
+            row[kPerfP90] = histogram.PercentileNanoseconds(0.90) * 1e-3;
+            row[kPerfP99] = histogram.PercentileNanoseconds(0.99) * 1e-3;
+            row[kPerfMax] = histogram.MaxNanoseconds() * 1e-3;
+        }
+        if (out && capacity >= kPerfTableSize) {
+            double* values = out + kPerfStageCount * kPerfStatFieldCount;
+            for (int c = 0; c < kPerfCounterCount; ++c) {
+                values[c] = static_cast<double>(counters[c].load(std::memory_order_relaxed));
+            }
+        }
+        return rows;
+    }
+
+    void Reset() {
+        for (LatencyHistogram& histogram : stages) histogram.Reset();
+        ResetCounters();
+    }
+
+private:
+    void ResetCounters() {
+        for (std::atomic<std::uint64_t>& counter : counters) counter.store(0, std::memory_order_relaxed);
+    }
+};
+
+// Records the time from construction to the end of the scope
+class PerfSpan {
+private:
+    LatencyHistogram& histogram;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    explicit PerfSpan(LatencyHistogram& target) : histogram(target), start(std::chrono::steady_clock::now()) {}
+    ~PerfSpan() {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        histogram.Record(static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+
+    PerfSpan(const PerfSpan&) = delete;
+    PerfSpan& operator=(const PerfSpan&) = delete;
+};
+
+#define BSTS_PERF_CONCAT_INNER(a, b) a##b
+#define BSTS_PERF_CONCAT(a, b) BSTS_PERF_CONCAT_INNER(a, b)
+
+// Time the rest of the enclosing scope into stats[stage]; count one event
+#if BSTS_PERF_STATS
+#define BSTS_PERF_SPAN(stats, stage) PerfSpan BSTS_PERF_CONCAT(perfSpan, __LINE__)((stats)[stage])
+#define BSTS_PERF_COUNT(stats, counter) (stats).Increment(counter)
+#else
+#define BSTS_PERF_SPAN(stats, stage) ((void)0)
+#define BSTS_PERF_COUNT(stats, counter) ((void)0)
+#endif
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "ThreadPool.h"
+
+// Portfolio-wide bar close: one batch of bars (one per instance, SoA)
+// through every instance at once. A book of symbols calling AnalyzeBar one
+// after another runs hundreds of small simulations back to back, each too
+// small to spread across the pool; here the bar runs as three pool jobs:
+//
+//   1. Ingest: every instance takes its bar and prepares its simulation
+//      (BeginBatchBar), in chunks of symbols.
+//   2. Simulate: the Monte Carlo chunks of all symbols form one job, so a
+//      book of 1000-path symbols keeps every core busy on SIMD tiles.
+//   3. Finish: every instance reduces its chunks and emits its signal
+//      (FinishBatchBar).
+//
+// Each instance's paths still depend only on its own seed and stream, and
+// its chunk sums are added in chunk order, so every signal is bit-identical
+// to the same bar through AnalyzeBar, for any thread count. Buffers
+// grow to the largest book seen, so warm batches never allocate.
+template <typename Algorithm>
+class PortfolioEngine {
+private:
+    static constexpr std::size_t kSymbolsPerChunk = 8;
+
+    std::vector<std::size_t> chunkEnds;   // Running total of Monte Carlo chunks per symbol
+
+public:
+    // Full bars, as the range volatility estimators need. outputs (count
+    // entries each) may be null. Null instances are skipped and get zero
+    // outputs; an instance must not appear twice in a batch. opens, highs
+    // and lows may be null together for a close-only batch, which instances
+    // on a range estimator refuse: they skip the bar and get zero outputs.
+    void AnalyzeBars(Algorithm* const* instances, const double* opens, const double* highs,
+                     const double* lows, const double* closes, std::size_t count,
+                     int* actions, double* buySignals, double* sellSignals, double* confidences,
+                     ThreadPool& pool = SharedThreadPool()) {
+        chunkEnds.resize(std::max(chunkEnds.size(), count));
+
+        bool ranges = opens && highs && lows;
+        pool.ParallelFor(count, kSymbolsPerChunk, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                if (!instances[i]) {
+                    chunkEnds[i] = 0;
+                } else if (ranges) {
+                    chunkEnds[i] = instances[i]->BeginBatchBar(opens[i], highs[i], lows[i], closes[i]);
+                } else {
+                    chunkEnds[i] = instances[i]->BeginBatchBar(closes[i]);
+                }
+            }
+        });
+        for (std::size_t i = 1; i < count; ++i) chunkEnds[i] += chunkEnds[i - 1];
+
+        std::size_t totalChunks = count > 0 ? chunkEnds[count - 1] : 0;
+        const std::size_t* ends = chunkEnds.data();
+        pool.ParallelFor(totalChunks, 1, [&](std::size_t begin, std::size_t end) {
+            std::size_t symbol = std::upper_bound(ends, ends + count, begin) - ends;
+            for (std::size_t chunk = begin; chunk < end; ++chunk) {
+                while (ends[symbol] <= chunk) ++symbol;
+                instances[symbol]->RunBatchChunk(chunk - (symbol > 0 ? ends[symbol - 1] : 0));
+            }
+        });
+
+        pool.ParallelFor(count, kSymbolsPerChunk, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                double buySignal = 0.0, sellSignal = 0.0, confidence = 0.0;
+                int action = instances[i] ? instances[i]->FinishBatchBar(buySignal, sellSignal, confidence) : 0;
+                if (actions) actions[i] = action;
+                if (buySignals) buySignals[i] = buySignal;
+                if (sellSignals) sellSignals[i] = sellSignal;
+                if (confidences) confidences[i] = confidence;
+            }
+        });
+    }
+
+    // Close-only batch (see above)
+    void AnalyzeBars(Algorithm* const* instances, const double* closes, std::size_t count,
+                     int* actions, double* buySignals, double* sellSignals, double* confidences,
+                     ThreadPool& pool = SharedThreadPool()) {
+        AnalyzeBars(instances, nullptr, nullptr, nullptr, closes, count, actions, buySignals, sellSignals,
+                    confidences, pool);
+    }
+};
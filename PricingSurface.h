@@ -0,0 +1,120 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#include "OptionChainPricer.h"
+
+// Black-Scholes values of one call and one put at fixed moneyness (strike
+// as a multiple of spot) and a fixed expiry, tabulated over volatility.
+// Prices are homogeneous in (spot, strike), so per unit of spot they depend
+// only on volatility once the rate is fixed: a table built for the current
+// rate answers every bar without log, exp or the normal CDF.
+//
+// Nodes are kIntervals + 1 equally spaced volatilities on [0, kMaxVolatility]
+// holding the value and the vega. Lookups are cubic Hermite interpolation
+// on those, whose error on an interval of width h is at most
+// h^4 / 384 * max |d^4 V / d sigma^4|. Build checks the quarter points
+// of every interval against the pricer and keeps the worst error as
+// MaxError(). For the signal's 30-day 5% OTM pair that is about 2e-9 of
+// spot at typical rates and below 1e-8 up to 20%. The table is
+// 4 * (kIntervals + 1) doubles, about 16 KB.
+class PricingSurface {
+public:
+    static constexpr int kIntervals = 512;
+    static constexpr double kMaxVolatility = 2.5;
+
+private:
+    static constexpr int kNodes = kIntervals + 1;
+    static constexpr double kStep = kMaxVolatility / kIntervals;
+
+    // Node values per unit of spot, node-major so a lookup touches at most
+    // two cache lines
+    struct Node {
+        double call;
+        double callVega;
+        double put;
+        double putVega;
+    };
+
+    Node nodes[kNodes];
+    bool built = false;
+    double rate = 0.0;
+    double expiry = 0.0;
+    double callMoneyness = 0.0;
+    double putMoneyness = 0.0;
+    double maxError = 0.0;
+
+    // Exact values per unit of spot (Libm CDF, scalar)
+    void Price(double volatility, double& call, double& callVega, double& put, double& putVega) const {
+        simd::OptionChainMarket market;
+        market.spot = 1.0;
+        market.rate = rate;
+        market.volatility = volatility;
+        const double strikes[2] = {callMoneyness, putMoneyness};
+        const double expiries[2] = {expiry, expiry};
+        double calls[2], puts[2], vegas[2];
+        simd::OptionChainOutputs outputs;
+        outputs.callPrice = calls;
+        outputs.putPrice = puts;
+        outputs.vega = vegas;
+        simd::PriceOptionChain<CdfAccuracy::Libm>(SimdLevel::Scalar, market, strikes, expiries, 2, outputs);
+        call = calls[0];
+        callVega = vegas[0];
+        put = puts[1];
+        putVega = vegas[1];
+    }
+
+    static double Hermite(double t, double h, double v0, double d0, double v1, double d1) {
+        double t2 = t * t;
+        double t3 = t2 * t;
+        return (2.0 * t3 - 3.0 * t2 + 1.0) * v0 + (t3 - 2.0 * t2 + t) * h * d0 +
+               (3.0 * t2 - 2.0 * t3) * v1 + (t3 - t2) * h * d1;
+    }
+
+public:
+    // Tabulate the call at callStrike * spot and the put at putStrike *
+    // spot, both expiring in `years`, under the continuously compounded
+    // rate
+    void Build(double riskFreeRate, double years, double callStrike, double putStrike) {
+        rate = riskFreeRate;
+        expiry = years;
+        callMoneyness = callStrike;
+        putMoneyness = putStrike;
+        for (int i = 0; i < kNodes; ++i) {
+            Node& node = nodes[i];
+            Price(i * kStep, node.call, node.callVega, node.put, node.putVega);
+        }
+        built = true;
+
+        maxError = 0.0;
+        for (int i = 0; i < kIntervals; ++i) {
+            for (double t : {0.25, 0.5, 0.75}) {
+                double volatility = (i + t) * kStep;
+                double call, callVega, put, putVega, callLookup = 0.0, putLookup = 0.0;
+                Price(volatility, call, callVega, put, putVega);
+                Lookup(volatility, callLookup, putLookup);
+                maxError = std::max({maxError, std::abs(callLookup - call), std::abs(putLookup - put)});
+            }
+        }
+    }
+
+    bool Built() const { return built; }
+    double Rate() const { return rate; }
+    double MaxError() const { return maxError; }
+
+    // Call and put values per unit of spot; false (outputs untouched) when
+    // not built or the volatility is outside [0, kMaxVolatility]
+    bool Lookup(double volatility, double& call, double& put) const {
+        if (!built || !(volatility >= 0.0 && volatility <= kMaxVolatility)) return false;
+        double position = volatility / kStep;
+        int i = std::min(static_cast<int>(position), kIntervals - 1);
+        double t = position - i;
+        const Node& a = nodes[i];
+        const Node& b = nodes[i + 1];
+        call = Hermite(t, kStep, a.call, a.callVega, b.call, b.callVega);
+        put = Hermite(t, kStep, a.put, a.putVega, b.put, b.putVega);
+        return true;
+    }
+};
@@ -0,0 +1,244 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+// Scalar random number layer for everything outside the SIMD path kernels
+// (which generate Philox/Box-Muller in registers): small-state generators
+// and normal samplers with a block Fill(double*, n). Every generator is a
+// pure function of its seed, so runs replay exactly, and each fits in 32
+// bytes, so hundreds of instances cost nothing in cache.
+//
+// A generator is any type with std::uint64_t Next(). Samplers are
+// templates over the generator (constructed from a copy of it), so the two
+// plug together freely:
+//
+//   ZigguratNormal<Xoshiro256> normal(Xoshiro256(seed));
+//   normal.Fill(shocks, count);
+
+// SplitMix64 (Steele, Lea and Flood): seeds the other generators, so that
+// nearby seeds still give unrelated states
+class SplitMix64 {
+private:
+    std::uint64_t state;
+
+public:
+    explicit SplitMix64(std::uint64_t seed) : state(seed) {}
+
+    std::uint64_t Next() {
+        std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+};
+
+// xoshiro256++ (Blackman and Vigna): 256-bit state, period 2^256 - 1. Jump()
+// advances 2^128 draws, giving non-overlapping streams from one seed.
+class Xoshiro256 {
+private:
+    std::uint64_t s[4];
+
+    static std::uint64_t Rotl(std::uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+public:
+    explicit Xoshiro256(std::uint64_t seed) {
+        SplitMix64 mix(seed);
+        for (std::uint64_t& word : s) word = mix.Next();
+    }
+
+    // Exact state (must not be all zero)
+    Xoshiro256(std::uint64_t s0, std::uint64_t s1, std::uint64_t s2, std::uint64_t s3) : s{s0, s1, s2, s3} {}
+
+    std::uint64_t Next() {
+        std::uint64_t result = Rotl(s[0] + s[3], 23) + s[0];
+        std::uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = Rotl(s[3], 45);
+        return result;
+    }
+
+    void Jump() {
+        static const std::uint64_t kJump[4] = {0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL,
+                                               0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL};
+        std::uint64_t jumped[4] = {0, 0, 0, 0};
+        for (std::uint64_t word : kJump) {
+            for (int bit = 0; bit < 64; ++bit) {
+                if (word & (std::uint64_t(1) << bit)) {
+                    for (int i = 0; i < 4; ++i) jumped[i] ^= s[i];
+                }
+                Next();
+            }
+        }
+        for (int i = 0; i < 4; ++i) s[i] = jumped[i];
+    }
+};
+
+// Philox4x32-10 (Salmon et al.), counter-based: block i of (key, stream) is
+// a pure function of i, so any draw can be reached without running the
+// ones before it. Same rounds as the path kernels' lanes.
+class Philox4x32 {
+private:
+    std::uint32_t key[2];
+    std::uint64_t stream;
+    std::uint64_t block = 0;
+    std::uint32_t words[4] = {0, 0, 0, 0};
+    int used = 4;
+
+public:
+    Philox4x32(std::uint64_t seed, std::uint64_t streamId = 0)
+        : key{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)}, stream(streamId) {}
+
+    // One 4x32 block: counter in place becomes the output
+    static void Block(std::uint32_t counter[4], std::uint32_t key0, std::uint32_t key1) {
+        for (int round = 0; round < 10; ++round) {
+            std::uint64_t product0 = static_cast<std::uint64_t>(0xD2511F53u) * counter[0];
+            std::uint64_t product1 = static_cast<std::uint64_t>(0xCD9E8D57u) * counter[2];
+            std::uint32_t next0 = static_cast<std::uint32_t>(product1 >> 32) ^ counter[1] ^ key0;
+            std::uint32_t next2 = static_cast<std::uint32_t>(product0 >> 32) ^ counter[3] ^ key1;
+            counter[0] = next0;
+            counter[1] = static_cast<std::uint32_t>(product1);
+            counter[2] = next2;
+            counter[3] = static_cast<std::uint32_t>(product0);
+            key0 += 0x9E3779B9u;
+            key1 += 0xBB67AE85u;
+        }
+    }
+
+    // Continue from block `index` of the stream
+    void Seek(std::uint64_t index) {
+        block = index;
+        used = 4;
+    }
+
+    std::uint64_t Next() {
+        if (used >= 4) {
+            words[0] = static_cast<std::uint32_t>(block);
+            words[1] = static_cast<std::uint32_t>(block >> 32);
+            words[2] = static_cast<std::uint32_t>(stream);
+            words[3] = static_cast<std::uint32_t>(stream >> 32);
+            Block(words, key[0], key[1]);
+            ++block;
+            used = 0;
+        }
+        std::uint64_t value = (static_cast<std::uint64_t>(words[used + 1]) << 32) | words[used];
+        used += 2;
+        return value;
+    }
+};
+
+// Uniform in (0, 1) from the top 53 bits, never 0 (safe for log)
+inline double OpenUnitInterval(std::uint64_t bits) {
+    return (static_cast<double>(bits >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+// Ziggurat standard normal sampler (Marsaglia and Tsang, in Doornik's
+// 128-layer form): one 64-bit draw and a multiply for ~98.8% of samples,
+// an exp pair for the wedges, and an exact exponential tail beyond
+// R = 3.4426. The layer tables are shared and built on first use.
+template <typename Generator>
+class ZigguratNormal {
+private:
+    static constexpr int kLayers = 128;
+
+    struct Tables {
+        double x[kLayers + 1];   // Layer edges; x[0] is the base strip's pseudo-width
+        double ratio[kLayers];   // x[i + 1] / x[i]: fraction of layer i inside the curve
+
+        Tables() {
+            const double r = 3.442619855899;
+            const double area = 9.91256303526217e-3;
+            double f = std::exp(-0.5 * r * r);
+            x[0] = area / f;
+            x[1] = r;
+            x[kLayers] = 0.0;
+            for (int i = 2; i < kLayers; ++i) {
+                x[i] = std::sqrt(-2.0 * std::log(area / x[i - 1] + f));
+                f = std::exp(-0.5 * x[i] * x[i]);
+            }
+            for (int i = 0; i < kLayers; ++i) ratio[i] = x[i + 1] / x[i];
+        }
+    };
+
+    static const Tables& Layers() {
+        static const Tables tables;
+        return tables;
+    }
+
+    Generator source;
+    const Tables& tables;
+
+    // |z| beyond r: exponential proposals accepted against the Gaussian
+    double Tail(bool negative) {
+        const double r = tables.x[1];
+        double x, y;
+        do {
+            x = std::log(OpenUnitInterval(source.Next())) / r;
+            y = std::log(OpenUnitInterval(source.Next()));
+        } while (-2.0 * y < x * x);
+        return negative ? x - r : r - x;
+    }
+
+public:
+    explicit ZigguratNormal(const Generator& generator) : source(generator), tables(Layers()) {}
+
+    double operator()() {
+        for (;;) {
+            std::uint64_t bits = source.Next();
+            int layer = static_cast<int>(bits & (kLayers - 1));
+            double u = 2.0 * OpenUnitInterval(bits) - 1.0;   // Top 53 bits, disjoint from the layer bits
+            if (std::abs(u) < tables.ratio[layer]) return u * tables.x[layer];
+            if (layer == 0) return Tail(u < 0.0);
+
+            double x = u * tables.x[layer];
+            double f0 = std::exp(-0.5 * (tables.x[layer] * tables.x[layer] - x * x));
+            double f1 = std::exp(-0.5 * (tables.x[layer + 1] * tables.x[layer + 1] - x * x));
+            if (f1 + OpenUnitInterval(source.Next()) * (f0 - f1) < 1.0) return x;
+        }
+    }
+
+    // n draws in order; the same stream as n calls of operator()
+    void Fill(double* out, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) out[i] = (*this)();
+    }
+
+    Generator& Source() { return source; }
+};
+
+// Box-Muller standard normal sampler: two uniforms give a cosine/sine pair,
+// the sine half kept for the next call. The transform the path kernels run
+// in registers, for scalar code that wants the same method.
+template <typename Generator>
+class BoxMullerNormal {
+private:
+    Generator source;
+    double spare = 0.0;
+    bool hasSpare = false;
+
+public:
+    explicit BoxMullerNormal(const Generator& generator) : source(generator) {}
+
+    double operator()() {
+        if (hasSpare) {
+            hasSpare = false;
+            return spare;
+        }
+        double radius = std::sqrt(-2.0 * std::log(OpenUnitInterval(source.Next())));
+        double angle = 6.283185307179586 * OpenUnitInterval(source.Next());
+        spare = radius * std::sin(angle);
+        hasSpare = true;
+        return radius * std::cos(angle);
+    }
+
+    // n draws in order; the same stream as n calls of operator()
+    void Fill(double* out, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) out[i] = (*this)();
+    }
+
+    Generator& Source() { return source; }
+};
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+#include "RingBuffer.h"
+#include "RollingStatistics.h"
+
+// Range-based volatility over a sliding window of OHLC bars. Using the
+// open, high and low as well as the close, these estimators need far fewer
+// bars than close-to-close returns for the same estimator variance. In
+// relative efficiency (variance of the close-to-close estimator over theirs,
+// driftless Brownian bars) Parkinson is ~5.2, Garman-Klass ~7.4, and
+// Yang-Zhang ~8 and also unbiased across opening gaps and drift:
+//
+//   Parkinson      mean of ln(H/L)^2 / (4 ln 2)
+//   Garman-Klass   mean of ln(H/L)^2 / 2 - (2 ln 2 - 1) ln(C/O)^2
+//   Yang-Zhang     Var(ln(O/C_prev)) + k Var(ln(C/O)) + (1 - k) RS,
+//                  k = 0.34 / (1.34 + (n + 1) / (n - 1)),
+//                  RS the mean Rogers-Satchell term
+//                  ln(H/C) ln(H/O) + ln(L/C) ln(L/O)
+//
+// Parkinson and Garman-Klass see only the intrabar range and miss
+// overnight gaps. Close-only bars (open = high = low = close, as in
+// BarSeries::FromCloses) have no range. There they fall back to the squared
+// close-to-close return, which has the same expectation, and Yang-Zhang
+// reduces to the close-to-close variance on its own. Every update is O(1)
+// on rolling accumulators, rebuilt from the window every
+// kResyncInterval updates like the return statistics.
+
+// Values are shared with the SetVolatilityEstimator DLL export
+enum class VolatilityEstimator {
+    CloseToClose = 0,   // Sample variance of the close-to-close log returns
+    Parkinson = 1,
+    GarmanKlass = 2,
+    YangZhang = 3
+};
+
+// Log-space terms of one bar
+struct BarRange {
+    double overnight = 0.0;        // ln(O / previous C)
+    double body = 0.0;             // ln(C / O)
+    double highLow = 0.0;          // ln(H / L)
+    double rogersSatchell = 0.0;   // ln(H/C) ln(H/O) + ln(L/C) ln(L/O)
+};
+
+// The bar after previousClose. Opens, highs and lows that are not
+// positive, or a high and low that do not bracket the open and close, make
+// it a close-only bar.
+inline BarRange MakeBarRange(double previousClose, double open, double high, double low, double close) {
+    BarRange bar;
+    if (!(open > 0.0 && low > 0.0 && high >= low && high >= open && high >= close && low <= open && low <= close)) {
+        open = high = low = close;
+    }
+    bar.overnight = std::log(open / previousClose);
+    bar.body = std::log(close / open);
+    bar.highLow = std::log(high / low);
+    double highClose = std::log(high / close), highOpen = std::log(high / open);
+    double lowClose = std::log(low / close), lowOpen = std::log(low / open);
+    bar.rogersSatchell = highClose * highOpen + lowClose * lowOpen;
+    return bar;
+}
+
+class RangeVolatility {
+public:
+    static constexpr std::size_t kResyncInterval = 1024;
+
+private:
+    VolatilityEstimator estimator = VolatilityEstimator::CloseToClose;
+    RingBuffer<BarRange> bars;
+    RollingStatistics overnightStats;
+    RollingStatistics bodyStats;
+    RollingStatistics termStats;   // The estimator's per-bar term (Parkinson, Garman-Klass, Rogers-Satchell)
+
+    // One column of the window, for RollingStatistics::Rebuild
+    template <double (*Column)(VolatilityEstimator, const BarRange&)>
+    struct ColumnView {
+        const RangeVolatility& owner;
+        double operator[](std::size_t i) const { return Column(owner.estimator, owner.bars[i]); }
+    };
+
+    static double Overnight(VolatilityEstimator, const BarRange& bar) { return bar.overnight; }
+    static double Body(VolatilityEstimator, const BarRange& bar) { return bar.body; }
+
+    static double Term(VolatilityEstimator estimator, const BarRange& bar) {
+        static const double kLog2 = std::log(2.0);
+        bool ranged = bar.highLow > 0.0;
+        double closeToClose = bar.overnight + bar.body;
+        switch (estimator) {
+        case VolatilityEstimator::Parkinson:
+            return ranged ? bar.highLow * bar.highLow / (4.0 * kLog2) : closeToClose * closeToClose;
+        case VolatilityEstimator::GarmanKlass:
+            return ranged ? 0.5 * bar.highLow * bar.highLow - (2.0 * kLog2 - 1.0) * bar.body * bar.body
+                          : closeToClose * closeToClose;
+        default:
+            return bar.rogersSatchell;
+        }
+    }
+
+public:
+    VolatilityEstimator Estimator() const { return estimator; }
+
+    // Switch estimators, keeping the window
+    void SetEstimator(VolatilityEstimator value) {
+        estimator = value;
+        Resync();
+    }
+
+    // Window length in bars, keeping the most recent bars that fit
+    void SetCapacity(std::size_t capacity) {
+        bars.SetCapacity(capacity);
+        Resync();
+    }
+
+    void Clear() {
+        bars.Clear();
+        Resync();
+    }
+
+    void Push(const BarRange& bar) {
+        if (bars.Capacity() == 0) return;
+        double term = Term(estimator, bar);
+        if (bars.Full()) {
+            const BarRange& oldest = bars.Front();
+            overnightStats.Replace(oldest.overnight, bar.overnight);
+            bodyStats.Replace(oldest.body, bar.body);
+            termStats.Replace(Term(estimator, oldest), term);
+        } else {
+            overnightStats.Add(bar.overnight);
+            bodyStats.Add(bar.body);
+            termStats.Add(term);
+        }
+        bars.Push(bar);
+        if (termStats.UpdatesSinceRebuild() >= kResyncInterval) Resync();
+    }
+
+    // Rebuild the accumulators exactly from the window
+    void Resync() {
+        overnightStats.Rebuild(ColumnView<&RangeVolatility::Overnight>{*this}, 0, bars.Size());
+        bodyStats.Rebuild(ColumnView<&RangeVolatility::Body>{*this}, 0, bars.Size());
+        termStats.Rebuild(ColumnView<&RangeVolatility::Term>{*this}, 0, bars.Size());
+    }
+
+    std::size_t Size() const { return bars.Size(); }
+    std::size_t Capacity() const { return bars.Capacity(); }
+    const RingBuffer<BarRange>& Bars() const { return bars; }
+
+    // Per-bar variance; false below two bars
+    bool DailyVariance(double& variance) const {
+        std::size_t n = bars.Size();
+        if (n < 2) return false;
+        if (estimator == VolatilityEstimator::YangZhang) {
+            double k = 0.34 / (1.34 + static_cast<double>(n + 1) / (n - 1));
+            variance = overnightStats.Variance() + k * bodyStats.Variance() + (1.0 - k) * termStats.Mean();
+        } else {
+            variance = termStats.Mean();
+        }
+        if (!(variance > 0.0)) variance = 0.0;
+        return true;
+    }
+
+    // Snapshots (StateFile.h): the raw accumulators and the window, oldest
+    // first. Restore takes the accumulators as saved; ResyncAfterRestore
+    // rebuilds them instead (a snapshot from another estimator).
+    void Save(RollingStatistics::State& overnight, RollingStatistics::State& body,
+              RollingStatistics::State& term) const {
+        overnight = overnightStats.Save();
+        body = bodyStats.Save();
+        term = termStats.Save();
+    }
+
+    void Restore(const BarRange* window, std::size_t count, const RollingStatistics::State& overnight,
+                 const RollingStatistics::State& body, const RollingStatistics::State& term) {
+        bars.Clear();
+        for (std::size_t i = 0; i < count; ++i) bars.Push(window[i]);
+        overnightStats.Restore(overnight);
+        bodyStats.Restore(body);
+        termStats.Restore(term);
+    }
+
+    void ResyncAfterRestore(const BarRange* window, std::size_t count) {
+        bars.Clear();
+        for (std::size_t i = 0; i < count; ++i) bars.Push(window[i]);
+        Resync();
+    }
+};
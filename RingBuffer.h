@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Fixed-capacity circular buffer for the rolling bar windows.
+// Storage is allocated once when the capacity is set; Push() overwrites the
+// oldest element once the buffer is full, so a warm window costs O(1) per
+// bar and never touches the allocator. Indexing is oldest-first, matching
+// the std::vector windows it replaces (buffer[Size() - 1] is the newest).
+template <typename T>
+class RingBuffer {
+private:
+    std::vector<T> storage;
+    std::size_t head = 0;   // Index of the oldest element
+    std::size_t count = 0;
+
+public:
+    RingBuffer() = default;
+    explicit RingBuffer(std::size_t capacity) { SetCapacity(capacity); }
+
+    // Resize the window, keeping the most recent elements that still fit
+    void SetCapacity(std::size_t capacity) {
+        if (capacity == storage.size()) return;
+
+        std::size_t keep = count < capacity ? count : capacity;
+        std::vector<T> resized(capacity);
+        for (std::size_t i = 0; i < keep; ++i) {
+            resized[i] = (*this)[count - keep + i];
+        }
+
+        storage.swap(resized);
+        head = 0;
+        count = keep;
+    }
+
+    void Clear() {
+        head = 0;
+        count = 0;
+    }
+
+    void Push(const T& value) {
+        if (storage.empty()) return;
+
+        if (count < storage.size()) {
+            storage[Wrap(head + count)] = value;
+            ++count;
+        } else {
+            // Full: overwrite the oldest slot and advance the head
+            storage[head] = value;
+            head = Wrap(head + 1);
+        }
+    }
+
+    const T& operator[](std::size_t index) const { return storage[Wrap(head + index)]; }
+    T& operator[](std::size_t index) { return storage[Wrap(head + index)]; }
+
+    const T& Front() const { return storage[head]; }
+    const T& Back() const { return (*this)[count - 1]; }
+
+    std::size_t Size() const { return count; }
+    std::size_t Capacity() const { return storage.size(); }
+    bool Empty() const { return count == 0; }
+    bool Full() const { return count == storage.size(); }
+
+private:
+    // Positions are always < 2 * capacity, so one conditional subtract
+    // replaces the modulo
+    std::size_t Wrap(std::size_t position) const {
+        return position >= storage.size() ? position - storage.size() : position;
+    }
+};
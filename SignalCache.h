@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+// Memo of recent bar signals keyed on the quantized market state. On a
+// quiet, range-bound name consecutive bars land in the same cell and reuse
+// the last signal instead of re-running the simulation and the pricing.
+//
+// Each continuous input is cut into cells `tolerance` wide (log price and
+// log volatility, so relative; drift absolute, per year), and the horizon
+// and path count must match exactly. The signal's strikes sit at fixed
+// moneyness, so the log price cell stands in for log-moneyness. A
+// tolerance of 0 disables the cache.
+
+// Cell of one market state
+struct SignalCacheKey {
+    std::int64_t logPrice = 0;
+    std::int64_t logVolatility = 0;
+    std::int64_t drift = 0;
+    int horizonDays = 0;
+    int simulations = 0;
+
+    bool operator==(const SignalCacheKey& other) const {
+        return logPrice == other.logPrice && logVolatility == other.logVolatility &&
+               drift == other.drift && horizonDays == other.horizonDays &&
+               simulations == other.simulations;
+    }
+};
+
+// False (no cell) when the tolerance is 0 or an input is out of range
+inline bool QuantizeSignalState(double price, double volatility, double drift, int horizonDays,
+                                int simulations, double tolerance, SignalCacheKey& key) {
+    if (!(tolerance > 0.0) || !(price > 0.0) || !(volatility > 0.0) || !std::isfinite(drift)) return false;
+    const double limit = static_cast<double>(std::numeric_limits<std::int64_t>::max() / 2);
+    double cells[3] = {std::floor(std::log(price) / tolerance), std::floor(std::log(volatility) / tolerance),
+                       std::floor(drift / tolerance)};
+    for (double cell : cells) {
+        if (!(std::abs(cell) < limit)) return false;
+    }
+    key.logPrice = static_cast<std::int64_t>(cells[0]);
+    key.logVolatility = static_cast<std::int64_t>(cells[1]);
+    key.drift = static_cast<std::int64_t>(cells[2]);
+    key.horizonDays = horizonDays;
+    key.simulations = simulations;
+    return true;
+}
+
+// Fixed number of slots with least-recently-used replacement; a linear
+// scan over a handful of slots beats hashing at this size and never
+// allocates
+template <typename Value, std::size_t Slots = 8>
+class SignalCache {
+private:
+    struct Slot {
+        bool valid = false;
+        std::uint64_t lastUse = 0;
+        SignalCacheKey key;
+        Value value;
+    };
+
+    Slot slots[Slots];
+    std::uint64_t clock = 0;
+
+public:
+    // Cached value for the cell, or null
+    const Value* Find(const SignalCacheKey& key) {
+        for (Slot& slot : slots) {
+            if (slot.valid && slot.key == key) {
+                slot.lastUse = ++clock;
+                return &slot.value;
+            }
+        }
+        return nullptr;
+    }
+
+    void Insert(const SignalCacheKey& key, const Value& value) {
+        Slot* target = &slots[0];
+        for (Slot& slot : slots) {
+            if (!slot.valid || slot.key == key) {
+                target = &slot;
+                break;
+            }
+            if (slot.lastUse < target->lastUse) target = &slot;
+        }
+        target->valid = true;
+        target->lastUse = ++clock;
+        target->key = key;
+        target->value = value;
+    }
+
+    void Clear() {
+        for (Slot& slot : slots) slot.valid = false;
+    }
+};
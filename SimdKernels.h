@@ -0,0 +1,404 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "SimdSupport.h"
+
+#if BSTS_SIMD_X86
+#include <immintrin.h>
+#endif
+
+// Vectorized kernels shared by the engine.
+//
+// Each ISA namespace below (simd::scalar, simd::avx2, simd::avx512) defines
+// the same small set of lane primitives, VecD (double lanes), VecU (one
+// 32-bit lane per double lane) and MaskD, and then includes SimdKernels.inl,
+// which writes every kernel once in terms of those primitives. AVX2 and
+// AVX-512 copies are compiled inside target regions, so the translation unit
+// keeps the baseline ISA and the dispatchers at the bottom pick a copy at
+// run time.
+
+namespace simd {
+
+// Paths are simulated in tiles of 16: eight Philox counters per step, each
+// yielding a Box-Muller pair. Tile t, step s uses counters 8t..8t+7, so a
+// tile's paths depend only on (seed, stream, t) and never on how tiles are
+// split across calls or threads.
+constexpr int kGbmTilePaths = 16;
+
+struct GbmTileParameters {
+    double spot = 0.0;
+    double stepDrift = 0.0;       // (mu - sigma^2/2) * dt
+    double stepVolatility = 0.0;  // sigma * sqrt(dt)
+    int steps = 1;
+    std::uint64_t seed = 0;       // Philox key
+    std::uint64_t stream = 0;     // Distinguishes successive simulations under one key
+    bool antithetic = false;      // Paths 8..15 of a tile mirror the shocks of paths 0..7
+};
+
+// Thresholds for ReduceGbmTiles. Path p is tile p / 16, lane p % 16;
+// paths at or past pathLimit are left out (the tail of the last tile).
+struct TerminalReduction {
+    double profitLevel = 0.0;
+    double lossLevel = 0.0;
+    std::uint64_t pathLimit = ~std::uint64_t(0);
+};
+
+// Running sums over terminal prices S. Prices enter as deviations
+// x = S - spot, which keeps the squared sums from cancelling; profit and
+// loss count the paths beyond each threshold. With antithetic tiles each
+// (path, mirrored path) pair also contributes one sample of its average
+// deviation and its average profit and loss indicators.
+struct TerminalPriceSums {
+    double paths = 0.0;
+    double price = 0.0;           // Sum of x
+    double priceSquared = 0.0;    // Sum of x^2
+    double profit = 0.0;          // Paths with S > profitLevel
+    double loss = 0.0;            // Paths with S < lossLevel
+    double priceProfit = 0.0;     // Sum of x over profitable paths
+    double priceLoss = 0.0;       // Sum of x over losing paths
+    double pairs = 0.0;           // Antithetic pairs, then sums of their samples
+    double pairPrice = 0.0;
+    double pairPriceSquared = 0.0;
+    double pairProfit = 0.0;
+    double pairProfitSquared = 0.0;
+    double pairLoss = 0.0;
+    double pairLossSquared = 0.0;
+
+    void Add(const TerminalPriceSums& other) {
+        paths += other.paths;
+        price += other.price;
+        priceSquared += other.priceSquared;
+        profit += other.profit;
+        loss += other.loss;
+        priceProfit += other.priceProfit;
+        priceLoss += other.priceLoss;
+        pairs += other.pairs;
+        pairPrice += other.pairPrice;
+        pairPriceSquared += other.pairPriceSquared;
+        pairProfit += other.pairProfit;
+        pairProfitSquared += other.pairProfitSquared;
+        pairLoss += other.pairLoss;
+        pairLossSquared += other.pairLossSquared;
+    }
+};
+
+// Levels for ReduceBarrierTiles. A path is absorbed at the first touch of
+// lowerLevel (stop-loss) or upperLevel (take-profit); 0 and HUGE_VAL turn
+// a level off. Profit and loss count the paths absorbed at upperLevel and
+// lowerLevel, plus the surviving paths beyond each threshold at the horizon.
+struct BarrierReduction {
+    double upperLevel = HUGE_VAL;
+    double lowerLevel = 0.0;
+    double profitLevel = 0.0;
+    double lossLevel = 0.0;
+    std::uint64_t pathLimit = ~std::uint64_t(0);
+};
+
+// Running sums over barrier paths. `exit` holds the exit prices (the level
+// for absorbed paths, S_T for the rest) as TerminalPriceSums deviations;
+// exit times are in steps, half a step in for an absorbed path.
+struct BarrierSums {
+    TerminalPriceSums exit;
+    double upperHits = 0.0;
+    double lowerHits = 0.0;
+    double exitSteps = 0.0;
+    double exitStepsSquared = 0.0;
+
+    void Add(const BarrierSums& other) {
+        exit.Add(other.exit);
+        upperHits += other.upperHits;
+        lowerHits += other.lowerHits;
+        exitSteps += other.exitSteps;
+        exitStepsSquared += other.exitStepsSquared;
+    }
+};
+
+namespace scalar {
+
+constexpr int kLanes = 1;
+
+struct VecD { double v; };
+struct VecU { std::uint32_t v; };
+struct MaskD { bool v; };
+
+inline VecD Set1(double x) { return {x}; }
+inline VecD Load(const double* p) { return {*p}; }
+inline void Store(double* p, VecD a) { *p = a.v; }
+inline VecD operator+(VecD a, VecD b) { return {a.v + b.v}; }
+inline VecD operator-(VecD a, VecD b) { return {a.v - b.v}; }
+inline VecD operator*(VecD a, VecD b) { return {a.v * b.v}; }
+inline VecD operator/(VecD a, VecD b) { return {a.v / b.v}; }
+inline VecD operator-(VecD a) { return {-a.v}; }
+inline VecD Fma(VecD a, VecD b, VecD c) { return {a.v * b.v + c.v}; }
+inline VecD Sqrt(VecD a) { return {std::sqrt(a.v)}; }
+inline VecD Min(VecD a, VecD b) { return {a.v < b.v ? a.v : b.v}; }
+inline VecD Max(VecD a, VecD b) { return {a.v > b.v ? a.v : b.v}; }
+inline VecD Abs(VecD a) { return {std::fabs(a.v)}; }
+inline VecD Round(VecD a) { return {std::nearbyint(a.v)}; }
+inline MaskD Less(VecD a, VecD b) { return {a.v < b.v}; }
+inline MaskD Greater(VecD a, VecD b) { return {a.v > b.v}; }
+inline MaskD operator|(MaskD a, MaskD b) { return {a.v || b.v}; }
+inline MaskD operator&(MaskD a, MaskD b) { return {a.v && b.v}; }
+inline VecD Select(MaskD m, VecD a, VecD b) { return {m.v ? a.v : b.v}; }
+inline int CountTrue(MaskD m) { return m.v ? 1 : 0; }
+inline double ReduceAdd(VecD a) { return a.v; }
+
+inline std::uint64_t Bits(double x) { std::uint64_t b; std::memcpy(&b, &x, sizeof(b)); return b; }
+inline double FromBits(std::uint64_t b) { double x; std::memcpy(&x, &b, sizeof(x)); return x; }
+
+// Reinterpret as integer, shift left 52, reinterpret back (builds 2^n)
+inline VecD ShiftLeft52(VecD a) { return {FromBits(Bits(a.v) << 52)}; }
+// Biased exponent field as a double, and the mantissa rescaled to [1, 2)
+inline VecD ExponentField(VecD a) { return {static_cast<double>(Bits(a.v) >> 52)}; }
+inline VecD MantissaOne(VecD a) {
+    return {FromBits((Bits(a.v) & 0x000FFFFFFFFFFFFFull) | 0x3FF0000000000000ull)};
+}
+
+inline VecU SetU(std::uint32_t x) { return {x}; }
+inline VecU LaneIndexU() { return {0}; }
+inline VecU AddU(VecU a, VecU b) { return {a.v + b.v}; }
+inline VecU XorU(VecU a, VecU b) { return {a.v ^ b.v}; }
+inline void MulHiLo(VecU a, std::uint32_t m, VecU& hi, VecU& lo) {
+    std::uint64_t product = static_cast<std::uint64_t>(a.v) * m;
+    hi.v = static_cast<std::uint32_t>(product >> 32);
+    lo.v = static_cast<std::uint32_t>(product);
+}
+// Uniform in [0, 1) from the top 52 bits of (hi:lo)
+inline VecD UnitFromBits(VecU lo, VecU hi) {
+    std::uint64_t bits = (static_cast<std::uint64_t>(hi.v) << 32) | lo.v;
+    return {FromBits((bits >> 12) | 0x3FF0000000000000ull) - 1.0};
+}
+
+#include "SimdKernels.inl"
+
+} // namespace scalar
+
+#if BSTS_SIMD_X86
+
+BSTS_BEGIN_TARGET_AVX2
+namespace avx2 {
+
+constexpr int kLanes = 4;
+
+struct VecD { __m256d v; };
+struct VecU { __m128i v; };
+struct MaskD { __m256d v; };
+
+inline VecD Set1(double x) { return {_mm256_set1_pd(x)}; }
+inline VecD Load(const double* p) { return {_mm256_loadu_pd(p)}; }
+inline void Store(double* p, VecD a) { _mm256_storeu_pd(p, a.v); }
+inline VecD operator+(VecD a, VecD b) { return {_mm256_add_pd(a.v, b.v)}; }
+inline VecD operator-(VecD a, VecD b) { return {_mm256_sub_pd(a.v, b.v)}; }
+inline VecD operator*(VecD a, VecD b) { return {_mm256_mul_pd(a.v, b.v)}; }
+inline VecD operator/(VecD a, VecD b) { return {_mm256_div_pd(a.v, b.v)}; }
+inline VecD operator-(VecD a) { return {_mm256_xor_pd(a.v, _mm256_set1_pd(-0.0))}; }
+inline VecD Fma(VecD a, VecD b, VecD c) { return {_mm256_fmadd_pd(a.v, b.v, c.v)}; }
+inline VecD Sqrt(VecD a) { return {_mm256_sqrt_pd(a.v)}; }
+inline VecD Min(VecD a, VecD b) { return {_mm256_min_pd(a.v, b.v)}; }
+inline VecD Max(VecD a, VecD b) { return {_mm256_max_pd(a.v, b.v)}; }
+inline VecD Abs(VecD a) { return {_mm256_andnot_pd(_mm256_set1_pd(-0.0), a.v)}; }
+inline VecD Round(VecD a) { return {_mm256_round_pd(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)}; }
+inline MaskD Less(VecD a, VecD b) { return {_mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ)}; }
+inline MaskD Greater(VecD a, VecD b) { return {_mm256_cmp_pd(a.v, b.v, _CMP_GT_OQ)}; }
+inline MaskD operator|(MaskD a, MaskD b) { return {_mm256_or_pd(a.v, b.v)}; }
+inline MaskD operator&(MaskD a, MaskD b) { return {_mm256_and_pd(a.v, b.v)}; }
+inline VecD Select(MaskD m, VecD a, VecD b) { return {_mm256_blendv_pd(b.v, a.v, m.v)}; }
+inline int CountTrue(MaskD m) { return PopCount(static_cast<unsigned int>(_mm256_movemask_pd(m.v))); }
+inline double ReduceAdd(VecD a) {
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, a.v);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+inline VecD ShiftLeft52(VecD a) {
+    return {_mm256_castsi256_pd(_mm256_slli_epi64(_mm256_castpd_si256(a.v), 52))};
+}
+inline VecD ExponentField(VecD a) {
+    // (bits >> 52) lands in the mantissa of 2^52; subtracting 2^52 yields it as a double
+    __m256i exponent = _mm256_srli_epi64(_mm256_castpd_si256(a.v), 52);
+    __m256i biased = _mm256_or_si256(exponent, _mm256_set1_epi64x(0x4330000000000000ll));
+    return {_mm256_sub_pd(_mm256_castsi256_pd(biased), _mm256_set1_pd(4503599627370496.0))};
+}
+inline VecD MantissaOne(VecD a) {
+    __m256i bits = _mm256_and_si256(_mm256_castpd_si256(a.v), _mm256_set1_epi64x(0x000FFFFFFFFFFFFFll));
+    return {_mm256_castsi256_pd(_mm256_or_si256(bits, _mm256_set1_epi64x(0x3FF0000000000000ll)))};
+}
+
+inline VecU SetU(std::uint32_t x) { return {_mm_set1_epi32(static_cast<int>(x))}; }
+inline VecU LaneIndexU() { return {_mm_setr_epi32(0, 1, 2, 3)}; }
+inline VecU AddU(VecU a, VecU b) { return {_mm_add_epi32(a.v, b.v)}; }
+inline VecU XorU(VecU a, VecU b) { return {_mm_xor_si128(a.v, b.v)}; }
+inline void MulHiLo(VecU a, std::uint32_t m, VecU& hi, VecU& lo) {
+    // _mm_mul_epu32 multiplies the even lanes; shift the odd lanes down for a second pass
+    __m128i multiplier = _mm_set1_epi32(static_cast<int>(m));
+    __m128i even = _mm_mul_epu32(a.v, multiplier);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a.v, 32), multiplier);
+    lo.v = _mm_blend_epi32(even, _mm_slli_epi64(odd, 32), 0xA);
+    hi.v = _mm_blend_epi32(_mm_srli_epi64(even, 32), odd, 0xA);
+}
+inline VecD UnitFromBits(VecU lo, VecU hi) {
+    __m256i bits = _mm256_or_si256(_mm256_slli_epi64(_mm256_cvtepu32_epi64(hi.v), 32),
+                                   _mm256_cvtepu32_epi64(lo.v));
+    bits = _mm256_or_si256(_mm256_srli_epi64(bits, 12), _mm256_set1_epi64x(0x3FF0000000000000ll));
+    return {_mm256_sub_pd(_mm256_castsi256_pd(bits), _mm256_set1_pd(1.0))};
+}
+
+#include "SimdKernels.inl"
+
+} // namespace avx2
+BSTS_END_TARGET
+
+BSTS_BEGIN_TARGET_AVX512
+namespace avx512 {
+
+constexpr int kLanes = 8;
+
+struct VecD { __m512d v; };
+struct VecU { __m256i v; };
+struct MaskD { __mmask8 v; };
+
+inline VecD Set1(double x) { return {_mm512_set1_pd(x)}; }
+inline VecD Load(const double* p) { return {_mm512_loadu_pd(p)}; }
+inline void Store(double* p, VecD a) { _mm512_storeu_pd(p, a.v); }
+inline VecD operator+(VecD a, VecD b) { return {_mm512_add_pd(a.v, b.v)}; }
+inline VecD operator-(VecD a, VecD b) { return {_mm512_sub_pd(a.v, b.v)}; }
+inline VecD operator*(VecD a, VecD b) { return {_mm512_mul_pd(a.v, b.v)}; }
+inline VecD operator/(VecD a, VecD b) { return {_mm512_div_pd(a.v, b.v)}; }
+inline VecD operator-(VecD a) { return {_mm512_xor_pd(a.v, _mm512_set1_pd(-0.0))}; }
+inline VecD Fma(VecD a, VecD b, VecD c) { return {_mm512_fmadd_pd(a.v, b.v, c.v)}; }
+inline VecD Sqrt(VecD a) { return {_mm512_sqrt_pd(a.v)}; }
+inline VecD Min(VecD a, VecD b) { return {_mm512_min_pd(a.v, b.v)}; }
+inline VecD Max(VecD a, VecD b) { return {_mm512_max_pd(a.v, b.v)}; }
+inline VecD Abs(VecD a) { return {_mm512_abs_pd(a.v)}; }
+inline VecD Round(VecD a) { return {_mm512_roundscale_pd(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)}; }
+inline MaskD Less(VecD a, VecD b) { return {_mm512_cmp_pd_mask(a.v, b.v, _CMP_LT_OQ)}; }
+inline MaskD Greater(VecD a, VecD b) { return {_mm512_cmp_pd_mask(a.v, b.v, _CMP_GT_OQ)}; }
+inline MaskD operator|(MaskD a, MaskD b) { return {static_cast<__mmask8>(a.v | b.v)}; }
+inline MaskD operator&(MaskD a, MaskD b) { return {static_cast<__mmask8>(a.v & b.v)}; }
+inline VecD Select(MaskD m, VecD a, VecD b) { return {_mm512_mask_blend_pd(m.v, b.v, a.v)}; }
+inline int CountTrue(MaskD m) { return PopCount(m.v); }
+inline double ReduceAdd(VecD a) {
+    alignas(64) double lanes[8];
+    _mm512_store_pd(lanes, a.v);
+    return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) +
+           ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+}
+
+inline VecD ShiftLeft52(VecD a) {
+    return {_mm512_castsi512_pd(_mm512_slli_epi64(_mm512_castpd_si512(a.v), 52))};
+}
+inline VecD ExponentField(VecD a) {
+    __m512i exponent = _mm512_srli_epi64(_mm512_castpd_si512(a.v), 52);
+    __m512i biased = _mm512_or_si512(exponent, _mm512_set1_epi64(0x4330000000000000ll));
+    return {_mm512_sub_pd(_mm512_castsi512_pd(biased), _mm512_set1_pd(4503599627370496.0))};
+}
+inline VecD MantissaOne(VecD a) {
+    __m512i bits = _mm512_and_si512(_mm512_castpd_si512(a.v), _mm512_set1_epi64(0x000FFFFFFFFFFFFFll));
+    return {_mm512_castsi512_pd(_mm512_or_si512(bits, _mm512_set1_epi64(0x3FF0000000000000ll)))};
+}
+
+inline VecU SetU(std::uint32_t x) { return {_mm256_set1_epi32(static_cast<int>(x))}; }
+inline VecU LaneIndexU() { return {_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)}; }
+inline VecU AddU(VecU a, VecU b) { return {_mm256_add_epi32(a.v, b.v)}; }
+inline VecU XorU(VecU a, VecU b) { return {_mm256_xor_si256(a.v, b.v)}; }
+inline void MulHiLo(VecU a, std::uint32_t m, VecU& hi, VecU& lo) {
+    __m256i multiplier = _mm256_set1_epi32(static_cast<int>(m));
+    __m256i even = _mm256_mul_epu32(a.v, multiplier);
+    __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(a.v, 32), multiplier);
+    lo.v = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+    hi.v = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+}
+inline VecD UnitFromBits(VecU lo, VecU hi) {
+    __m512i bits = _mm512_or_si512(_mm512_slli_epi64(_mm512_cvtepu32_epi64(hi.v), 32),
+                                   _mm512_cvtepu32_epi64(lo.v));
+    bits = _mm512_or_si512(_mm512_srli_epi64(bits, 12), _mm512_set1_epi64(0x3FF0000000000000ll));
+    return {_mm512_sub_pd(_mm512_castsi512_pd(bits), _mm512_set1_pd(1.0))};
+}
+
+#include "SimdKernels.inl"
+
+} // namespace avx512
+BSTS_END_TARGET
+
+#endif // BSTS_SIMD_X86
+
+// Runtime dispatch ---------------------------------------------------------
+
+// Terminal prices for tiles [firstTile, firstTile + tileCount); writes
+// tileCount * kGbmTilePaths prices to out
+inline void SimulateGbmTiles(SimdLevel level, const GbmTileParameters& parameters,
+                             std::uint64_t firstTile, std::uint64_t tileCount, double* out) {
+    switch (level) {
+#if BSTS_SIMD_X86
+    case SimdLevel::Avx512:
+        avx512::SimulateGbmTiles(parameters, firstTile, tileCount, out);
+        return;
+    case SimdLevel::Avx2:
+        avx2::SimulateGbmTiles(parameters, firstTile, tileCount, out);
+        return;
+#endif
+    default:
+        scalar::SimulateGbmTiles(parameters, firstTile, tileCount, out);
+        return;
+    }
+}
+
+inline void SimulateGbmTiles(const GbmTileParameters& parameters, std::uint64_t firstTile,
+                             std::uint64_t tileCount, double* out) {
+    SimulateGbmTiles(ActiveSimdLevel(), parameters, firstTile, tileCount, out);
+}
+
+// Fold the terminal prices of the same tiles into `sums` without storing
+// them; the prices match SimulateGbmTiles path for path
+inline void ReduceGbmTiles(SimdLevel level, const GbmTileParameters& parameters,
+                           const TerminalReduction& reduction, std::uint64_t firstTile,
+                           std::uint64_t tileCount, TerminalPriceSums& sums) {
+    switch (level) {
+#if BSTS_SIMD_X86
+    case SimdLevel::Avx512:
+        avx512::ReduceGbmTiles(parameters, reduction, firstTile, tileCount, sums);
+        return;
+    case SimdLevel::Avx2:
+        avx2::ReduceGbmTiles(parameters, reduction, firstTile, tileCount, sums);
+        return;
+#endif
+    default:
+        scalar::ReduceGbmTiles(parameters, reduction, firstTile, tileCount, sums);
+        return;
+    }
+}
+
+inline void ReduceGbmTiles(const GbmTileParameters& parameters, const TerminalReduction& reduction,
+                           std::uint64_t firstTile, std::uint64_t tileCount, TerminalPriceSums& sums) {
+    ReduceGbmTiles(ActiveSimdLevel(), parameters, reduction, firstTile, tileCount, sums);
+}
+
+// First passage through the reduction's levels for the same tiles; a
+// path's shocks match SimulateGbmTiles for every step it survives
+inline void ReduceBarrierTiles(SimdLevel level, const GbmTileParameters& parameters,
+                               const BarrierReduction& reduction, std::uint64_t firstTile,
+                               std::uint64_t tileCount, BarrierSums& sums) {
+    switch (level) {
+#if BSTS_SIMD_X86
+    case SimdLevel::Avx512:
+        avx512::ReduceBarrierTiles(parameters, reduction, firstTile, tileCount, sums);
+        return;
+    case SimdLevel::Avx2:
+        avx2::ReduceBarrierTiles(parameters, reduction, firstTile, tileCount, sums);
+        return;
+#endif
+    default:
+        scalar::ReduceBarrierTiles(parameters, reduction, firstTile, tileCount, sums);
+        return;
+    }
+}
+
+inline void ReduceBarrierTiles(const GbmTileParameters& parameters, const BarrierReduction& reduction,
+                               std::uint64_t firstTile, std::uint64_t tileCount, BarrierSums& sums) {
+    ReduceBarrierTiles(ActiveSimdLevel(), parameters, reduction, firstTile, tileCount, sums);
+}
+
+} // namespace simd
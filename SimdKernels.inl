@@ -0,0 +1,458 @@
+// ISA-generic kernel bodies. Included once per ISA namespace by
+// SimdKernels.h after that namespace's lane primitives are defined; do not
+// include directly and do not add #include directives here.
+
+// Vector math -------------------------------------------------------------
+
+// e^x: x = n*ln2 + r with |r| <= ln2/2, degree-13 Taylor series for e^r,
+// 2^n assembled in the exponent field. Relative error ~2e-16 over
+// [-708, 709], with inputs clamped to that range.
+inline VecD Exp(VecD x) {
+    x = Min(Max(x, Set1(-708.0)), Set1(709.0));
+    VecD n = Round(x * Set1(1.4426950408889634));
+    VecD r = Fma(n, Set1(-6.93147180369123816490e-01), x);
+    r = Fma(n, Set1(-1.90821492927058770002e-10), r);
+
+    VecD p = Set1(1.0 / 6227020800.0);
+    p = Fma(p, r, Set1(1.0 / 479001600.0));
+    p = Fma(p, r, Set1(1.0 / 39916800.0));
+    p = Fma(p, r, Set1(1.0 / 3628800.0));
+    p = Fma(p, r, Set1(1.0 / 362880.0));
+    p = Fma(p, r, Set1(1.0 / 40320.0));
+    p = Fma(p, r, Set1(1.0 / 5040.0));
+    p = Fma(p, r, Set1(1.0 / 720.0));
+    p = Fma(p, r, Set1(1.0 / 120.0));
+    p = Fma(p, r, Set1(1.0 / 24.0));
+    p = Fma(p, r, Set1(1.0 / 6.0));
+    p = Fma(p, r, Set1(0.5));
+    p = Fma(p, r, Set1(1.0));
+    p = Fma(p, r, Set1(1.0));
+
+    // (2^52 + n + 1023) carries n + 1023 in its low mantissa bits
+    VecD scale = ShiftLeft52(n + Set1(4503599627370496.0 + 1023.0));
+    return p * scale;
+}
+
+// ln(x) for positive normal x: x = 2^e * m with m in [sqrt(1/2), sqrt(2)),
+// ln(m) = 2*atanh(f) for f = (m - 1)/(m + 1), |f| <= 0.172
+inline VecD Log(VecD x) {
+    VecD e = ExponentField(x) - Set1(1023.0);
+    VecD m = MantissaOne(x);
+    MaskD high = Greater(m, Set1(1.4142135623730951));
+    m = Select(high, m * Set1(0.5), m);
+    e = Select(high, e + Set1(1.0), e);
+
+    VecD f = (m - Set1(1.0)) / (m + Set1(1.0));
+    VecD s = f * f;
+    VecD p = Set1(2.0 / 21.0);
+    p = Fma(p, s, Set1(2.0 / 19.0));
+    p = Fma(p, s, Set1(2.0 / 17.0));
+    p = Fma(p, s, Set1(2.0 / 15.0));
+    p = Fma(p, s, Set1(2.0 / 13.0));
+    p = Fma(p, s, Set1(2.0 / 11.0));
+    p = Fma(p, s, Set1(2.0 / 9.0));
+    p = Fma(p, s, Set1(2.0 / 7.0));
+    p = Fma(p, s, Set1(2.0 / 5.0));
+    p = Fma(p, s, Set1(2.0 / 3.0));
+    p = Fma(p, s, Set1(2.0));
+
+    VecD logMantissa = f * p;
+    return Fma(e, Set1(6.93147180369123816490e-01), Fma(e, Set1(1.90821492927058770002e-10), logMantissa));
+}
+
+// sin(2*pi*u) and cos(2*pi*u). The reduction happens in turns (exact in
+// binary), leaving |r| <= pi/4 for the Taylor polynomials.
+inline void SinCos2Pi(VecD u, VecD& sine, VecD& cosine) {
+    VecD t = u - Round(u);                // [-1/2, 1/2] turns
+    VecD quadrant = Round(t * Set1(4.0)); // -2..2
+    VecD r = (t - quadrant * Set1(0.25)) * Set1(6.283185307179586);
+    VecD r2 = r * r;
+
+    VecD sp = Set1(-1.0 / 1307674368000.0);
+    sp = Fma(sp, r2, Set1(1.0 / 6227020800.0));
+    sp = Fma(sp, r2, Set1(-1.0 / 39916800.0));
+    sp = Fma(sp, r2, Set1(1.0 / 362880.0));
+    sp = Fma(sp, r2, Set1(-1.0 / 5040.0));
+    sp = Fma(sp, r2, Set1(1.0 / 120.0));
+    sp = Fma(sp, r2, Set1(-1.0 / 6.0));
+    sp = Fma(sp, r2, Set1(1.0));
+    VecD sinR = sp * r;
+
+    VecD cp = Set1(1.0 / 20922789888000.0);
+    cp = Fma(cp, r2, Set1(-1.0 / 87178291200.0));
+    cp = Fma(cp, r2, Set1(1.0 / 479001600.0));
+    cp = Fma(cp, r2, Set1(-1.0 / 3628800.0));
+    cp = Fma(cp, r2, Set1(1.0 / 40320.0));
+    cp = Fma(cp, r2, Set1(-1.0 / 720.0));
+    cp = Fma(cp, r2, Set1(1.0 / 24.0));
+    cp = Fma(cp, r2, Set1(-0.5));
+    VecD cosR = Fma(cp, r2, Set1(1.0));
+
+    // sin(r + q*pi/2): q = +-1 swaps sin and cos, signs follow the quadrant
+    MaskD swap = Less(Abs(quadrant * quadrant - Set1(1.0)), Set1(0.5));
+    MaskD negateSine = Less(quadrant, Set1(-0.5)) | Greater(quadrant, Set1(1.5));
+    MaskD negateCosine = Greater(quadrant, Set1(0.5)) | Less(quadrant, Set1(-1.5));
+    VecD s = Select(swap, cosR, sinR);
+    VecD c = Select(swap, sinR, cosR);
+    sine = Select(negateSine, -s, s);
+    cosine = Select(negateCosine, -c, c);
+}
+
+// Random numbers ----------------------------------------------------------
+
+// Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as
+// 1, 2, 3"), one independent counter per lane
+inline void Philox4x32(VecU& c0, VecU& c1, VecU& c2, VecU& c3,
+                       std::uint32_t key0, std::uint32_t key1) {
+    for (int round = 0; round < 10; ++round) {
+        VecU hi0, lo0, hi1, lo1;
+        MulHiLo(c0, 0xD2511F53u, hi0, lo0);
+        MulHiLo(c2, 0xCD9E8D57u, hi1, lo1);
+        VecU next0 = XorU(XorU(hi1, c1), SetU(key0));
+        VecU next2 = XorU(XorU(hi0, c3), SetU(key1));
+        c0 = next0;
+        c1 = lo1;
+        c2 = next2;
+        c3 = lo0;
+        key0 += 0x9E3779B9u;
+        key1 += 0xBB67AE85u;
+    }
+}
+
+// Two standard normals per lane (Box-Muller) from one Philox block
+inline void BoxMuller(VecU w0, VecU w1, VecU w2, VecU w3, VecD& z0, VecD& z1) {
+    VecD u1 = Set1(1.0) - UnitFromBits(w0, w1); // (0, 1]
+    VecD u2 = UnitFromBits(w2, w3);
+    VecD radius = Sqrt(Set1(-2.0) * Log(u1));
+    VecD sine, cosine;
+    SinCos2Pi(u2, sine, cosine);
+    z0 = radius * cosine;
+    z1 = radius * sine;
+}
+
+// GBM paths ---------------------------------------------------------------
+
+// Structure-of-arrays path kernel: every lane is one path. The log price is
+// accumulated as a sum of shocks with the per-step drift and sigma*sqrt(dt)
+// applied once at the end, so the step loop is RNG plus one add.
+constexpr int kGbmGroups = 8 / kLanes;  // Philox lane groups per tile
+
+// Summed shocks of tile `tile`: shocks[i] holds paths i*kLanes.. of the tile
+inline void SimulateTileShocks(const GbmTileParameters& parameters, std::uint64_t tile, VecD* shocks) {
+    const std::uint32_t key0 = static_cast<std::uint32_t>(parameters.seed);
+    const std::uint32_t key1 = static_cast<std::uint32_t>(parameters.seed >> 32);
+    const VecU streamLow = SetU(static_cast<std::uint32_t>(parameters.stream));
+    const VecU streamHigh = SetU(static_cast<std::uint32_t>(parameters.stream >> 32));
+    const bool antithetic = parameters.antithetic;
+    for (int i = 0; i < 2 * kGbmGroups; ++i) shocks[i] = Set1(0.0);
+
+    std::uint32_t counterBase = static_cast<std::uint32_t>(tile * 8);
+    for (int step = 0; step < parameters.steps; ++step) {
+        VecU stepCounter = SetU(static_cast<std::uint32_t>(step));
+        for (int group = 0; group < kGbmGroups; ++group) {
+            VecU c0 = AddU(SetU(counterBase + group * kLanes), LaneIndexU());
+            VecU c1 = stepCounter;
+            VecU c2 = streamLow;
+            VecU c3 = streamHigh;
+            Philox4x32(c0, c1, c2, c3, key0, key1);
+
+            VecD z0, z1;
+            BoxMuller(c0, c1, c2, c3, z0, z1);
+            shocks[group] = shocks[group] + z0;
+            shocks[kGbmGroups + group] = shocks[kGbmGroups + group] + (antithetic ? -z0 : z1);
+        }
+    }
+}
+
+inline void SimulateGbmTiles(const GbmTileParameters& parameters, std::uint64_t firstTile,
+                             std::uint64_t tileCount, double* out) {
+    const VecD totalDrift = Set1(parameters.stepDrift * parameters.steps);
+    const VecD stepVolatility = Set1(parameters.stepVolatility);
+    const VecD spot = Set1(parameters.spot);
+
+    for (std::uint64_t tile = 0; tile < tileCount; ++tile) {
+        VecD shocks[2 * kGbmGroups];
+        SimulateTileShocks(parameters, firstTile + tile, shocks);
+
+        double* tileOut = out + tile * kGbmTilePaths;
+        for (int i = 0; i < 2 * kGbmGroups; ++i) {
+            Store(tileOut + i * kLanes, spot * Exp(Fma(shocks[i], stepVolatility, totalDrift)));
+        }
+    }
+}
+
+// The same paths folded straight into TerminalPriceSums: the accumulators
+// stay in registers for the whole tile range and are added to `sums` once.
+// Only a partial last tile (paths at or past reduction.pathLimit dropped)
+// goes through memory, as one tile-sized stack buffer.
+inline void ReduceGbmTiles(const GbmTileParameters& parameters, const TerminalReduction& reduction,
+                           std::uint64_t firstTile, std::uint64_t tileCount, TerminalPriceSums& sums) {
+    const VecD totalDrift = Set1(parameters.stepDrift * parameters.steps);
+    const VecD stepVolatility = Set1(parameters.stepVolatility);
+    const VecD spot = Set1(parameters.spot);
+    const VecD profitLevel = Set1(reduction.profitLevel);
+    const VecD lossLevel = Set1(reduction.lossLevel);
+    const VecD zero = Set1(0.0);
+    const VecD one = Set1(1.0);
+    const VecD half = Set1(0.5);
+
+    VecD price = zero, priceSquared = zero, profit = zero, loss = zero, priceProfit = zero, priceLoss = zero;
+    VecD pairPrice = zero, pairPriceSquared = zero, pairProfit = zero, pairProfitSquared = zero;
+    VecD pairLoss = zero, pairLossSquared = zero;
+    std::uint64_t fullTiles = 0;
+    TerminalPriceSums tail;
+
+    for (std::uint64_t tile = firstTile; tile < firstTile + tileCount; ++tile) {
+        std::uint64_t firstPath = tile * kGbmTilePaths;
+        if (firstPath >= reduction.pathLimit) break;
+
+        VecD shocks[2 * kGbmGroups];
+        SimulateTileShocks(parameters, tile, shocks);
+        VecD terminal[2 * kGbmGroups];
+        for (int i = 0; i < 2 * kGbmGroups; ++i) terminal[i] = spot * Exp(Fma(shocks[i], stepVolatility, totalDrift));
+
+        if (firstPath + kGbmTilePaths > reduction.pathLimit) {
+            double prices[kGbmTilePaths];
+            for (int i = 0; i < 2 * kGbmGroups; ++i) Store(prices + i * kLanes, terminal[i]);
+            for (std::uint64_t i = 0; i < reduction.pathLimit - firstPath; ++i) {
+                double deviation = prices[i] - parameters.spot;
+                bool isProfit = prices[i] > reduction.profitLevel;
+                bool isLoss = prices[i] < reduction.lossLevel;
+                tail.paths += 1.0;
+                tail.price += deviation;
+                tail.priceSquared += deviation * deviation;
+                tail.profit += isProfit;
+                tail.loss += isLoss;
+                tail.priceProfit += isProfit ? deviation : 0.0;
+                tail.priceLoss += isLoss ? deviation : 0.0;
+            }
+            break;
+        }
+
+        ++fullTiles;
+        VecD isProfit[2 * kGbmGroups], isLoss[2 * kGbmGroups];
+        for (int i = 0; i < 2 * kGbmGroups; ++i) {
+            VecD deviation = terminal[i] - spot;
+            isProfit[i] = Select(Greater(terminal[i], profitLevel), one, zero);
+            isLoss[i] = Select(Less(terminal[i], lossLevel), one, zero);
+            price = price + deviation;
+            priceSquared = Fma(deviation, deviation, priceSquared);
+            profit = profit + isProfit[i];
+            loss = loss + isLoss[i];
+            priceProfit = Fma(deviation, isProfit[i], priceProfit);
+            priceLoss = Fma(deviation, isLoss[i], priceLoss);
+        }
+        if (parameters.antithetic) {
+            // Partners sit kGbmGroups vectors (8 paths) apart
+            for (int group = 0; group < kGbmGroups; ++group) {
+                VecD deviation = half * (terminal[group] + terminal[kGbmGroups + group]) - spot;
+                VecD profitShare = half * (isProfit[group] + isProfit[kGbmGroups + group]);
+                VecD lossShare = half * (isLoss[group] + isLoss[kGbmGroups + group]);
+                pairPrice = pairPrice + deviation;
+                pairPriceSquared = Fma(deviation, deviation, pairPriceSquared);
+                pairProfit = pairProfit + profitShare;
+                pairProfitSquared = Fma(profitShare, profitShare, pairProfitSquared);
+                pairLoss = pairLoss + lossShare;
+                pairLossSquared = Fma(lossShare, lossShare, pairLossSquared);
+            }
+        }
+    }
+
+    sums.paths += static_cast<double>(fullTiles * kGbmTilePaths) + tail.paths;
+    sums.price += ReduceAdd(price) + tail.price;
+    sums.priceSquared += ReduceAdd(priceSquared) + tail.priceSquared;
+    sums.profit += ReduceAdd(profit) + tail.profit;
+    sums.loss += ReduceAdd(loss) + tail.loss;
+    sums.priceProfit += ReduceAdd(priceProfit) + tail.priceProfit;
+    sums.priceLoss += ReduceAdd(priceLoss) + tail.priceLoss;
+    if (parameters.antithetic) {
+        sums.pairs += static_cast<double>(fullTiles * (kGbmTilePaths / 2));
+        sums.pairPrice += ReduceAdd(pairPrice);
+        sums.pairPriceSquared += ReduceAdd(pairPriceSquared);
+        sums.pairProfit += ReduceAdd(pairProfit);
+        sums.pairProfitSquared += ReduceAdd(pairProfitSquared);
+        sums.pairLoss += ReduceAdd(pairLoss);
+        sums.pairLossSquared += ReduceAdd(pairLossSquared);
+    }
+}
+
+// Barrier paths -----------------------------------------------------------
+
+// Stop-loss / take-profit first passage on the GBM log paths in coarse
+// steps. Between two steps the log price is a Brownian bridge, and a bridge
+// from x0 to x1 touches a level b beyond both with probability
+// exp(-2 (b - x0)(b - x1) / (sigma^2 dt)), whatever the drift. One uniform
+// per step tests both levels, so coarse steps only miss a path that
+// crosses both within one step. Absorbed lanes stay frozen at their level,
+// and a tile stops stepping once all its paths are absorbed.
+struct BarrierStepConstants {
+    VecD drift;
+    VecD volatility;
+    VecD bridgeScale;   // -2 / (sigma^2 dt)
+    VecD upper;         // Log levels relative to spot
+    VecD lower;
+};
+
+inline void BarrierStep(const BarrierStepConstants& constants, VecD z, VecD u, VecD exitTime,
+                        VecD& x, VecD& alive, VecD& upperHit, VecD& lowerHit, VecD& exitStep) {
+    const VecD zero = Set1(0.0);
+    const VecD one = Set1(1.0);
+    VecD next = Fma(z, constants.volatility, x + constants.drift);
+    VecD upperExponent = Min((constants.upper - x) * (constants.upper - next) * constants.bridgeScale, zero);
+    VecD lowerExponent = Min((x - constants.lower) * (next - constants.lower) * constants.bridgeScale, zero);
+
+    // Below e^-40 a crossing probability is under any uniform of (0, 1]
+    // (>= 2^-52), so a level out of reach of every lane skips its exp
+    const VecD negligible = Set1(-40.0);
+    VecD upperCross = CountTrue(Greater(upperExponent, negligible)) ? Exp(upperExponent) : zero;
+    VecD lowerCross = CountTrue(Greater(lowerExponent, negligible)) ? Exp(lowerExponent) : zero;
+
+    // An endpoint past a level is a hit; otherwise u in [0, pL) touches the
+    // lower level and [pL, pL + pU) the upper one
+    MaskD live = Greater(alive, Set1(0.5));
+    MaskD hitLower = live & (Less(next, constants.lower) | (Less(u, lowerCross) & Less(next, constants.upper)));
+    MaskD hitUpper = live & (Greater(next, constants.upper) |
+                             (Greater(u, lowerCross) & Less(u, lowerCross + upperCross) & Greater(next, constants.lower)));
+    MaskD hit = hitLower | hitUpper;
+
+    x = Select(hitUpper, constants.upper, Select(hitLower, constants.lower, Select(live, next, x)));
+    upperHit = Select(hitUpper, one, upperHit);
+    lowerHit = Select(hitLower, one, lowerHit);
+    exitStep = Select(hit, exitTime, exitStep);
+    alive = Select(hit, zero, alive);
+}
+
+// Normals use the counters of SimulateTileShocks; the bridge uniforms come
+// from a second block per group with the top bit of the step counter set
+inline void ReduceBarrierTiles(const GbmTileParameters& parameters, const BarrierReduction& reduction,
+                               std::uint64_t firstTile, std::uint64_t tileCount, BarrierSums& sums) {
+    const std::uint32_t key0 = static_cast<std::uint32_t>(parameters.seed);
+    const std::uint32_t key1 = static_cast<std::uint32_t>(parameters.seed >> 32);
+    const VecU streamLow = SetU(static_cast<std::uint32_t>(parameters.stream));
+    const VecU streamHigh = SetU(static_cast<std::uint32_t>(parameters.stream >> 32));
+    const double stepVariance = std::fmax(parameters.stepVolatility * parameters.stepVolatility, 1e-300);
+
+    BarrierStepConstants constants;
+    constants.drift = Set1(parameters.stepDrift);
+    constants.volatility = Set1(parameters.stepVolatility);
+    constants.bridgeScale = Set1(-2.0 / stepVariance);
+    constants.upper = Set1(std::log(reduction.upperLevel / parameters.spot));
+    constants.lower = Set1(reduction.lowerLevel > 0.0 ? std::log(reduction.lowerLevel / parameters.spot) : -HUGE_VAL);
+    const double profitLog = std::log(reduction.profitLevel / parameters.spot);
+    const double lossLog = std::log(reduction.lossLevel / parameters.spot);
+    const VecD spot = Set1(parameters.spot);
+    const VecD zero = Set1(0.0);
+    const VecD one = Set1(1.0);
+    const VecD half = Set1(0.5);
+
+    VecD price = zero, priceSquared = zero, profit = zero, loss = zero, priceProfit = zero, priceLoss = zero;
+    VecD upperHits = zero, lowerHits = zero, exitSteps = zero, exitStepsSquared = zero;
+    std::uint64_t fullTiles = 0;
+    BarrierSums tail;
+
+    for (std::uint64_t tile = firstTile; tile < firstTile + tileCount; ++tile) {
+        std::uint64_t firstPath = tile * kGbmTilePaths;
+        if (firstPath >= reduction.pathLimit) break;
+
+        VecD x[2 * kGbmGroups], alive[2 * kGbmGroups], upperHit[2 * kGbmGroups], lowerHit[2 * kGbmGroups];
+        VecD exitStep[2 * kGbmGroups];
+        for (int i = 0; i < 2 * kGbmGroups; ++i) {
+            x[i] = zero;
+            alive[i] = one;
+            upperHit[i] = zero;
+            lowerHit[i] = zero;
+            exitStep[i] = Set1(static_cast<double>(parameters.steps));
+        }
+
+        std::uint32_t counterBase = static_cast<std::uint32_t>(tile * 8);
+        for (int step = 0; step < parameters.steps; ++step) {
+            VecU stepCounter = SetU(static_cast<std::uint32_t>(step));
+            VecU uniformCounter = SetU(static_cast<std::uint32_t>(step) | 0x80000000u);
+            VecD exitTime = Set1(step + 0.5);
+            VecD remaining = zero;
+            for (int group = 0; group < kGbmGroups; ++group) {
+                VecU lane = AddU(SetU(counterBase + group * kLanes), LaneIndexU());
+                VecU c0 = lane, c1 = stepCounter, c2 = streamLow, c3 = streamHigh;
+                Philox4x32(c0, c1, c2, c3, key0, key1);
+                VecD z0, z1;
+                BoxMuller(c0, c1, c2, c3, z0, z1);
+
+                VecU d0 = lane, d1 = uniformCounter, d2 = streamLow, d3 = streamHigh;
+                Philox4x32(d0, d1, d2, d3, key0, key1);
+                VecD u0 = one - UnitFromBits(d0, d1);   // (0, 1], so a zero crossing probability never hits
+                VecD u1 = one - UnitFromBits(d2, d3);
+
+                BarrierStep(constants, z0, u0, exitTime, x[group], alive[group], upperHit[group], lowerHit[group],
+                            exitStep[group]);
+                int partner = kGbmGroups + group;
+                BarrierStep(constants, z1, u1, exitTime, x[partner], alive[partner], upperHit[partner],
+                            lowerHit[partner], exitStep[partner]);
+                remaining = remaining + alive[group] + alive[partner];
+            }
+            if (ReduceAdd(remaining) == 0.0) break;
+        }
+
+        VecD terminal[2 * kGbmGroups], isProfit[2 * kGbmGroups], isLoss[2 * kGbmGroups];
+        for (int i = 0; i < 2 * kGbmGroups; ++i) {
+            MaskD survived = Greater(alive[i], half);
+            terminal[i] = spot * Exp(x[i]);
+            isProfit[i] = Select(Greater(upperHit[i], half) | (survived & Greater(x[i], Set1(profitLog))), one, zero);
+            isLoss[i] = Select(Greater(lowerHit[i], half) | (survived & Less(x[i], Set1(lossLog))), one, zero);
+        }
+
+        if (firstPath + kGbmTilePaths > reduction.pathLimit) {
+            double prices[kGbmTilePaths], profits[kGbmTilePaths], losses[kGbmTilePaths];
+            double uppers[kGbmTilePaths], lowers[kGbmTilePaths], steps[kGbmTilePaths];
+            for (int i = 0; i < 2 * kGbmGroups; ++i) {
+                Store(prices + i * kLanes, terminal[i]);
+                Store(profits + i * kLanes, isProfit[i]);
+                Store(losses + i * kLanes, isLoss[i]);
+                Store(uppers + i * kLanes, upperHit[i]);
+                Store(lowers + i * kLanes, lowerHit[i]);
+                Store(steps + i * kLanes, exitStep[i]);
+            }
+            for (std::uint64_t i = 0; i < reduction.pathLimit - firstPath; ++i) {
+                double deviation = prices[i] - parameters.spot;
+                tail.exit.paths += 1.0;
+                tail.exit.price += deviation;
+                tail.exit.priceSquared += deviation * deviation;
+                tail.exit.profit += profits[i];
+                tail.exit.loss += losses[i];
+                tail.exit.priceProfit += profits[i] * deviation;
+                tail.exit.priceLoss += losses[i] * deviation;
+                tail.upperHits += uppers[i];
+                tail.lowerHits += lowers[i];
+                tail.exitSteps += steps[i];
+                tail.exitStepsSquared += steps[i] * steps[i];
+            }
+            break;
+        }
+
+        ++fullTiles;
+        for (int i = 0; i < 2 * kGbmGroups; ++i) {
+            VecD deviation = terminal[i] - spot;
+            price = price + deviation;
+            priceSquared = Fma(deviation, deviation, priceSquared);
+            profit = profit + isProfit[i];
+            loss = loss + isLoss[i];
+            priceProfit = Fma(deviation, isProfit[i], priceProfit);
+            priceLoss = Fma(deviation, isLoss[i], priceLoss);
+            upperHits = upperHits + upperHit[i];
+            lowerHits = lowerHits + lowerHit[i];
+            exitSteps = exitSteps + exitStep[i];
+            exitStepsSquared = Fma(exitStep[i], exitStep[i], exitStepsSquared);
+        }
+    }
+
+    sums.exit.paths += static_cast<double>(fullTiles * kGbmTilePaths) + tail.exit.paths;
+    sums.exit.price += ReduceAdd(price) + tail.exit.price;
+    sums.exit.priceSquared += ReduceAdd(priceSquared) + tail.exit.priceSquared;
+    sums.exit.profit += ReduceAdd(profit) + tail.exit.profit;
+    sums.exit.loss += ReduceAdd(loss) + tail.exit.loss;
+    sums.exit.priceProfit += ReduceAdd(priceProfit) + tail.exit.priceProfit;
+    sums.exit.priceLoss += ReduceAdd(priceLoss) + tail.exit.priceLoss;
+    sums.upperHits += ReduceAdd(upperHits) + tail.upperHits;
+    sums.lowerHits += ReduceAdd(lowerHits) + tail.lowerHits;
+    sums.exitSteps += ReduceAdd(exitSteps) + tail.exitSteps;
+    sums.exitStepsSquared += ReduceAdd(exitStepsSquared) + tail.exitStepsSquared;
+}
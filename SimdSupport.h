@@ -0,0 +1,126 @@
+#pragma once
+
+#include <atomic>
+
+// Runtime instruction-set selection for the vectorized kernels.
+// Kernels for every ISA are compiled into the same binary (see SimdKernels.h)
+// and the widest one the CPU and OS support is picked at run time, so one
+// DLL runs on every workstation.
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define BSTS_SIMD_X86 1
+#else
+#define BSTS_SIMD_X86 0
+#endif
+
+#if BSTS_SIMD_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// Compile a region of functions for a specific ISA without raising the
+// baseline of the whole translation unit. MSVC accepts any intrinsic in any
+// function, so the regions are empty there.
+#if defined(__clang__)
+#define BSTS_BEGIN_TARGET_AVX2 \
+    _Pragma("clang attribute push(__attribute__((target(\"avx2,fma\"))), apply_to = function)")
+#define BSTS_BEGIN_TARGET_AVX512 \
+    _Pragma("clang attribute push(__attribute__((target(\"avx512f,avx512dq,avx2,fma\"))), apply_to = function)")
+#define BSTS_END_TARGET _Pragma("clang attribute pop")
+#elif defined(__GNUC__)
+// GCC's AVX-512 headers seed results with a self-initialized _mm512_undefined_*
+// value, which trips -W(maybe-)uninitialized once inlined; silence it in the regions
+#define BSTS_BEGIN_TARGET_AVX2 \
+    _Pragma("GCC push_options") _Pragma("GCC target(\"avx2,fma\")") \
+    _Pragma("GCC diagnostic push") _Pragma("GCC diagnostic ignored \"-Wmaybe-uninitialized\"") \
+    _Pragma("GCC diagnostic ignored \"-Wuninitialized\"")
+#define BSTS_BEGIN_TARGET_AVX512 \
+    _Pragma("GCC push_options") _Pragma("GCC target(\"avx512f,avx512dq,avx2,fma\")") \
+    _Pragma("GCC diagnostic push") _Pragma("GCC diagnostic ignored \"-Wmaybe-uninitialized\"") \
+    _Pragma("GCC diagnostic ignored \"-Wuninitialized\"")
+#define BSTS_END_TARGET _Pragma("GCC diagnostic pop") _Pragma("GCC pop_options")
+#else
+#define BSTS_BEGIN_TARGET_AVX2
+#define BSTS_BEGIN_TARGET_AVX512
+#define BSTS_END_TARGET
+#endif
+
+enum class SimdLevel {
+    Scalar = 0,
+    Avx2 = 1,    // AVX2 + FMA, 4 doubles per vector
+    Avx512 = 2   // AVX-512F/DQ, 8 doubles per vector
+};
+
+inline SimdLevel DetectSimdLevel() {
+#if BSTS_SIMD_X86
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    unsigned int maxLeaf = static_cast<unsigned int>(info[0]);
+    __cpuid(info, 1);
+    ecx = static_cast<unsigned int>(info[2]);
+#else
+    unsigned int maxLeaf = __get_cpuid_max(0, nullptr);
+    __cpuid(1, eax, ebx, ecx, edx);
+#endif
+    bool osxsave = (ecx & (1u << 27)) != 0;
+    bool avx = (ecx & (1u << 28)) != 0;
+    bool fma = (ecx & (1u << 12)) != 0;
+    if (!osxsave || !avx || maxLeaf < 7) return SimdLevel::Scalar;
+
+    // The OS must save the YMM (and for AVX-512, opmask/ZMM) state
+#if defined(_MSC_VER)
+    unsigned long long xcr0 = _xgetbv(0);
+    __cpuidex(info, 7, 0);
+    ebx = static_cast<unsigned int>(info[1]);
+#else
+    unsigned int xcr0Low = 0, xcr0High = 0;
+    __asm__ volatile("xgetbv" : "=a"(xcr0Low), "=d"(xcr0High) : "c"(0));
+    unsigned long long xcr0 = (static_cast<unsigned long long>(xcr0High) << 32) | xcr0Low;
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+#endif
+    bool ymmState = (xcr0 & 0x6) == 0x6;
+    bool zmmState = (xcr0 & 0xE6) == 0xE6;
+    bool avx2 = (ebx & (1u << 5)) != 0;
+    bool avx512f = (ebx & (1u << 16)) != 0;
+    bool avx512dq = (ebx & (1u << 17)) != 0;
+
+    if (ymmState && zmmState && avx512f && avx512dq && avx2 && fma) return SimdLevel::Avx512;
+    if (ymmState && avx2 && fma) return SimdLevel::Avx2;
+#endif
+    return SimdLevel::Scalar;
+}
+
+// Highest level the dispatchers pick by default. Per-ISA builds (the CMake
+// _avx2 variants) set it to their own level, so a binary tuned for one desk
+// runs the kernels it was benchmarked with.
+#ifndef BSTS_SIMD_MAX_LEVEL
+#define BSTS_SIMD_MAX_LEVEL 2
+#endif
+
+// Upper bound on the level the dispatchers may pick (benchmarks and tests
+// use it to compare ISAs on one machine)
+inline std::atomic<int>& SimdLevelLimit() {
+    static std::atomic<int> limit(BSTS_SIMD_MAX_LEVEL);
+    return limit;
+}
+
+inline void SetSimdLevelLimit(SimdLevel level) {
+    SimdLevelLimit().store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+inline SimdLevel ActiveSimdLevel() {
+    static const SimdLevel detected = DetectSimdLevel();
+    int limit = SimdLevelLimit().load(std::memory_order_relaxed);
+    return static_cast<int>(detected) < limit ? detected : static_cast<SimdLevel>(limit);
+}
+
+inline int PopCount(unsigned int bits) {
+    int count = 0;
+    for (; bits != 0; bits &= bits - 1) ++count;
+    return count;
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+// Owen-scrambled Sobol points for quasi-Monte Carlo.
+// Points are computed directly from their index (no generator state), so
+// any index range can be produced independently on any thread. Direction
+// numbers for the first dimensions follow Joe & Kuo (new-joe-kuo-6.21201);
+// dimension 0 is the base-2 van der Corput sequence.
+//
+// Scrambling uses the hash-based nested uniform permutation of Laine &
+// Karras / Burley ("Practical Hash-based Owen Scrambling", 2020). Each
+// scramble seed gives an independent randomization of the same point set,
+// so the spread across a few seeds is an honest error estimate.
+constexpr int kSobolMaxDimensions = 8;
+
+inline std::uint32_t ReverseBits(std::uint32_t x) {
+    x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+    x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+    x = ((x >> 4) & 0x0F0F0F0Fu) | ((x & 0x0F0F0F0Fu) << 4);
+    x = ((x >> 8) & 0x00FF00FFu) | ((x & 0x00FF00FFu) << 8);
+    return (x >> 16) | (x << 16);
+}
+
+// Nested uniform (Owen) scramble of a 32-bit fixed-point coordinate: every
+// bit is flipped by a hash of the bits above it
+inline std::uint32_t OwenScramble(std::uint32_t x, std::uint32_t seed) {
+    x = ReverseBits(x);
+    x ^= x * 0x3D20ADEAu;
+    x += seed;
+    x *= (seed >> 16) | 1u;
+    x ^= x * 0x05526C56u;
+    x ^= x * 0x53A22864u;
+    return ReverseBits(x);
+}
+
+class SobolSequence {
+private:
+    std::uint32_t directions[kSobolMaxDimensions][32];
+
+public:
+    SobolSequence() {
+        // Degree s, interior polynomial coefficients a, initial m_1..m_s
+        struct Primitive { int degree; std::uint32_t coefficients; std::uint32_t m[5]; };
+        static const Primitive kPrimitives[kSobolMaxDimensions - 1] = {
+            {1, 0, {1}},
+            {2, 1, {1, 3}},
+            {3, 1, {1, 3, 1}},
+            {3, 2, {1, 1, 1}},
+            {4, 1, {1, 1, 3, 3}},
+            {4, 4, {1, 3, 5, 13}},
+            {5, 2, {1, 1, 5, 5, 17}},
+        };
+
+        for (int bit = 0; bit < 32; ++bit) {
+            directions[0][bit] = 1u << (31 - bit);
+        }
+        for (int dimension = 1; dimension < kSobolMaxDimensions; ++dimension) {
+            const Primitive& primitive = kPrimitives[dimension - 1];
+            int s = primitive.degree;
+            std::uint32_t* v = directions[dimension];
+            for (int bit = 0; bit < s; ++bit) {
+                v[bit] = primitive.m[bit] << (31 - bit);
+            }
+            for (int bit = s; bit < 32; ++bit) {
+                std::uint32_t value = v[bit - s] ^ (v[bit - s] >> s);
+                for (int j = 1; j < s; ++j) {
+                    if ((primitive.coefficients >> (s - 1 - j)) & 1u) value ^= v[bit - j];
+                }
+                v[bit] = value;
+            }
+        }
+    }
+
+    // Coordinate `dimension` of point `index` as 32-bit fixed point
+    std::uint32_t Point(std::uint32_t index, int dimension) const {
+        std::uint32_t x = 0;
+        const std::uint32_t* v = directions[dimension];
+        for (int bit = 0; index != 0; ++bit, index >>= 1) {
+            if (index & 1u) x ^= v[bit];
+        }
+        return x;
+    }
+
+    // Scrambled coordinate mapped to the open interval (0, 1)
+    double Uniform(std::uint32_t index, int dimension, std::uint32_t seed) const {
+        return (OwenScramble(Point(index, dimension), seed) + 0.5) * (1.0 / 4294967296.0);
+    }
+};
+
+// Inverse standard normal CDF: Acklam's rational approximation (relative
+// error 1.15e-9) polished by one Halley step against erfc
+inline double InverseNormalCDF(double p) {
+    static const double a[6] = {-3.969683028665376e+01, 2.209460984245205e+02,
+                                -2.759285104469687e+02, 1.383577518672690e+02,
+                                -3.066479806614716e+01, 2.506628277459239e+00};
+    static const double b[5] = {-5.447609879822406e+01, 1.615858368580409e+02,
+                                -1.556989798598866e+02, 6.680131188771972e+01,
+                                -1.328068155288572e+01};
+    static const double c[6] = {-7.784894002430293e-03, -3.223964580411365e-01,
+                                -2.400758277161838e+00, -2.549732539343734e+00,
+                                4.374664141464968e+00, 2.938163982698783e+00};
+    static const double d[4] = {7.784695709041462e-03, 3.224671290700398e-01,
+                                2.445134137142996e+00, 3.754408661907416e+00};
+    const double lowTail = 0.02425;
+
+    double x;
+    if (p < lowTail) {
+        double q = std::sqrt(-2.0 * std::log(p));
+        x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+            ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+    } else if (p <= 1.0 - lowTail) {
+        double q = p - 0.5;
+        double r = q * q;
+        x = (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+            (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+    } else {
+        double q = std::sqrt(-2.0 * std::log(1.0 - p));
+        x = -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+             ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+    }
+
+    double error = 0.5 * std::erfc(-x / std::sqrt(2.0)) - p;
+    double u = error * std::sqrt(2.0 * 3.14159265358979323846) * std::exp(0.5 * x * x);
+    return x - u / (1.0 + 0.5 * x * u);
+}
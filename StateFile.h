@@ -0,0 +1,211 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+#include "RangeVolatility.h"
+#include "RollingStatistics.h"
+
+// Versioned binary snapshots of engine state, so a restarted DLL picks up
+// its instances where they stopped instead of replaying the chart. A
+// 64-byte header is followed by one record per instance:
+//
+//   EngineStateRecord   fixed fields (below)
+//   prices, volatilities, returns   double windows, oldest first
+//   ranges              BarRange window of the range estimator, oldest first
+//
+// Records are multiples of 8 bytes, so every window is aligned in the
+// mapping. Files are little-endian and native layout, like bar files,
+// and are replaced atomically (written beside the target, then renamed),
+// so a crash mid-save leaves the previous snapshot. Settings are not state:
+// the restoring instance keeps its own, except that the lookback must match
+// the windows.
+
+struct StateFileHeader {
+    char magic[8];                 // "BSTSSTAT"
+    std::uint32_t version;
+    std::uint32_t recordCount;
+    std::uint64_t fileBytes;       // Whole file, as a truncation check
+    std::uint8_t reserved[40];
+};
+static_assert(sizeof(StateFileHeader) == 64, "state file header layout");
+
+constexpr char kStateFileMagic[8] = {'B', 'S', 'T', 'S', 'S', 'T', 'A', 'T'};
+constexpr std::uint32_t kStateFileVersion = 2;
+
+struct EngineStateRecord {
+    std::uint64_t key;             // Caller's id for the instance (0 for single-instance files)
+    std::uint64_t recordBytes;     // This header plus the windows
+    double stamp;                  // Caller's mark of the last close (e.g. its bar date and time)
+    std::uint32_t lookbackPeriod;
+    std::uint32_t priceCount;
+    std::uint32_t volatilityCount;
+    std::uint32_t returnCount;
+    RollingStatistics::State returnStats;
+    RollingStatistics::State driftStats;
+    std::uint64_t seed;            // Simulation key and bars ingested (the stream block)
+    std::uint64_t stream;
+    double markPrice;
+    double entryPrice;
+    double unrealizedPnL;
+    std::int32_t quantity;
+    std::uint32_t isLong;
+    std::uint32_t rangeCount;
+    std::uint32_t volatilityEstimator;   // Estimator behind the range accumulators
+    RollingStatistics::State overnightStats;
+    RollingStatistics::State bodyStats;
+    RollingStatistics::State rangeTermStats;
+};
+static_assert(sizeof(EngineStateRecord) == 256, "engine state record layout");
+static_assert(sizeof(BarRange) == 4 * sizeof(double), "bar range layout");
+
+// A record inside a mapped file; valid while the file stays open
+struct EngineStateView {
+    const EngineStateRecord* record = nullptr;
+    const double* prices = nullptr;
+    const double* volatilities = nullptr;
+    const double* returns = nullptr;
+    const BarRange* ranges = nullptr;
+};
+
+// Builds a state file in memory; Write publishes it
+class StateFileWriter {
+private:
+    std::vector<unsigned char> bytes;
+    std::uint32_t recordCount = 0;
+
+    void Append(const void* source, std::size_t count) {
+        const unsigned char* first = static_cast<const unsigned char*>(source);
+        bytes.insert(bytes.end(), first, first + count);
+    }
+
+    template <typename Window>
+    void AppendWindow(const Window& window) {
+        for (std::size_t i = 0; i < window.Size(); ++i) Append(&window[i], sizeof(window[i]));
+    }
+
+public:
+    StateFileWriter() : bytes(sizeof(StateFileHeader)) {}
+
+    // One instance; the window counts and record size are filled in here
+    template <typename Window, typename RangeWindow>
+    void Add(EngineStateRecord record, const Window& prices, const Window& volatilities, const Window& returns,
+             const RangeWindow& ranges) {
+        record.priceCount = static_cast<std::uint32_t>(prices.Size());
+        record.volatilityCount = static_cast<std::uint32_t>(volatilities.Size());
+        record.returnCount = static_cast<std::uint32_t>(returns.Size());
+        record.rangeCount = static_cast<std::uint32_t>(ranges.Size());
+        record.recordBytes = sizeof(EngineStateRecord) +
+                             sizeof(double) * (std::uint64_t(record.priceCount) + record.volatilityCount + record.returnCount) +
+                             sizeof(BarRange) * std::uint64_t(record.rangeCount);
+        Append(&record, sizeof(record));
+        AppendWindow(prices);
+        AppendWindow(volatilities);
+        AppendWindow(returns);
+        AppendWindow(ranges);
+        ++recordCount;
+    }
+
+    std::uint32_t RecordCount() const { return recordCount; }
+
+    // Replace `path` with the records added so far; false on I/O failure
+    bool Write(const char* path) {
+        StateFileHeader header = {};
+        std::memcpy(header.magic, kStateFileMagic, sizeof(header.magic));
+        header.version = kStateFileVersion;
+        header.recordCount = recordCount;
+        header.fileBytes = bytes.size();
+        std::memcpy(bytes.data(), &header, sizeof(header));
+
+        std::string temporary = std::string(path) + ".tmp";
+        std::FILE* file = std::fopen(temporary.c_str(), "wb");
+        if (!file) return false;
+        bool ok = std::fwrite(bytes.data(), bytes.size(), 1, file) == 1;
+        ok = std::fclose(file) == 0 && ok;
+#ifdef _WIN32
+        ok = ok && MoveFileExA(temporary.c_str(), path, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+        ok = ok && std::rename(temporary.c_str(), path) == 0;
+#endif
+        if (!ok) std::remove(temporary.c_str());
+        return ok;
+    }
+};
+
+// Read-only mapping of a state file. Open checks the header and every
+// record's bounds, so views never point outside the mapping.
+class StateFile {
+private:
+    MappedFile mapped;
+    std::vector<EngineStateView> records;
+
+public:
+    // False (and nothing mapped) if the file is missing, from another
+    // version, or truncated
+    bool Open(const char* path) {
+        Close();
+        if (!mapped.Open(path) || mapped.Size() < sizeof(StateFileHeader)) {
+            Close();
+            return false;
+        }
+        const unsigned char* data = mapped.Data();
+        const StateFileHeader* header = reinterpret_cast<const StateFileHeader*>(data);
+        if (std::memcmp(header->magic, kStateFileMagic, sizeof(kStateFileMagic)) != 0 ||
+            header->version != kStateFileVersion || header->fileBytes != mapped.Size()) {
+            Close();
+            return false;
+        }
+
+        std::size_t offset = sizeof(StateFileHeader);
+        records.reserve(header->recordCount);
+        for (std::uint32_t i = 0; i < header->recordCount; ++i) {
+            if (mapped.Size() - offset < sizeof(EngineStateRecord)) {
+                Close();
+                return false;
+            }
+            EngineStateView view;
+            view.record = reinterpret_cast<const EngineStateRecord*>(data + offset);
+            std::uint64_t windows = std::uint64_t(view.record->priceCount) + view.record->volatilityCount +
+                                    view.record->returnCount;
+            if (view.record->recordBytes != sizeof(EngineStateRecord) + windows * sizeof(double) +
+                                                std::uint64_t(view.record->rangeCount) * sizeof(BarRange) ||
+                view.record->recordBytes > mapped.Size() - offset) {
+                Close();
+                return false;
+            }
+            view.prices = reinterpret_cast<const double*>(data + offset + sizeof(EngineStateRecord));
+            view.volatilities = view.prices + view.record->priceCount;
+            view.returns = view.volatilities + view.record->volatilityCount;
+            view.ranges = reinterpret_cast<const BarRange*>(view.returns + view.record->returnCount);
+            records.push_back(view);
+            offset += static_cast<std::size_t>(view.record->recordBytes);
+        }
+        if (offset != mapped.Size()) {
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    void Close() {
+        mapped.Close();
+        records.clear();
+    }
+
+    bool IsOpen() const { return mapped.IsOpen(); }
+    std::size_t Count() const { return records.size(); }
+    const EngineStateView& Record(std::size_t index) const { return records[index]; }
+
+    // First record with `key`, or null
+    const EngineStateView* Find(std::uint64_t key) const {
+        for (const EngineStateView& view : records) {
+            if (view.record->key == key) return &view;
+        }
+        return nullptr;
+    }
+};
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Persistent worker pool for splitting the Monte Carlo path loop.
+// Workers are started once and sleep between jobs, so a bar pays for a
+// wake-up rather than thread creation. ParallelFor hands out fixed-size
+// chunks from an atomic counter and the calling thread works alongside
+// the pool; the job record lives on the caller's stack, so dispatching
+// never allocates. Chunk boundaries depend only on the chunk size, never
+// on the thread count, so any work that writes per-chunk results is
+// reproducible for every thread count. While one caller owns the pool,
+// other callers run their loops inline instead of queueing behind it, so
+// charts on separate threads never wait for each other.
+//
+// Workers are joined only by Stop(), never by the destructor: a pool that
+// lives until a DLL is unloaded would otherwise join its threads under the
+// loader lock, which deadlocks. Stop() a pool before it is destroyed.
+class ThreadPool {
+private:
+    struct Job {
+        void (*invoke)(const void* body, std::size_t begin, std::size_t end);
+        const void* body;
+        std::size_t count;
+        std::size_t chunkSize;
+        std::size_t chunkCount;
+        std::atomic<std::size_t> nextChunk{0};
+        std::atomic<std::size_t> finishedChunks{0};
+        int activeWorkers = 0;      // Guarded by mutex
+    };
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    Job* currentJob = nullptr;      // Guarded by mutex
+    std::size_t jobGeneration = 0;  // Guarded by mutex
+    bool stopping = false;          // Guarded by mutex
+    std::mutex submitMutex;         // Held by the caller that owns the pool
+    int configuredThreads = 1;      // Guarded by submitMutex
+    bool running = true;            // Guarded by submitMutex
+
+    static bool& InsideWorker() {
+        thread_local bool insideWorker = false;
+        return insideWorker;
+    }
+
+public:
+    // threadCount counts the calling thread; <= 0 means one per hardware thread
+    explicit ThreadPool(int threadCount = 0) { SetThreadCount(threadCount); }
+
+    ~ThreadPool() {
+        assert(workers.empty() && "Stop() a ThreadPool before destroying it");
+        if (!workers.empty()) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            for (std::thread& worker : workers) worker.detach();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void SetThreadCount(int threadCount) {
+        std::lock_guard<std::mutex> submitLock(submitMutex);
+        if (threadCount <= 0) {
+            threadCount = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        }
+        configuredThreads = threadCount;
+        if (!running || threadCount == ThreadCount()) return;
+
+        StopWorkers();
+        StartWorkers();
+    }
+
+    // Join the workers; until Start(), every loop runs inline on its caller.
+    // The count set by SetThreadCount is kept for Start().
+    void Stop() {
+        std::lock_guard<std::mutex> submitLock(submitMutex);
+        running = false;
+        StopWorkers();
+    }
+
+    // Restart the workers after Stop(); a no-op on a running pool
+    void Start() {
+        std::lock_guard<std::mutex> submitLock(submitMutex);
+        if (running) return;
+        running = true;
+        StartWorkers();
+    }
+
+    // Threads a loop runs on now: 1 while stopped
+    int ThreadCount() const { return static_cast<int>(workers.size()) + 1; }
+
+    // Run body(begin, end) over [0, count) in chunks of chunkSize. Returns
+    // once every chunk has finished. Calls made from inside a pool task, or
+    // while another thread is using the pool, run inline on that thread.
+    template <typename Body>
+    void ParallelFor(std::size_t count, std::size_t chunkSize, const Body& body) {
+        if (count == 0) return;
+        chunkSize = std::max<std::size_t>(chunkSize, 1);
+
+        // The worker list may only be read while holding submitMutex
+        std::unique_lock<std::mutex> submitLock;
+        if (count > chunkSize && !InsideWorker()) {
+            submitLock = std::unique_lock<std::mutex>(submitMutex, std::try_to_lock);
+        }
+        if (!submitLock.owns_lock() || workers.empty()) {
+            for (std::size_t begin = 0; begin < count; begin += chunkSize) {
+                body(begin, std::min(count, begin + chunkSize));
+            }
+            return;
+        }
+
+        Job job;
+        job.invoke = [](const void* context, std::size_t begin, std::size_t end) {
+            (*static_cast<const Body*>(context))(begin, end);
+        };
+        job.body = &body;
+        job.count = count;
+        job.chunkSize = chunkSize;
+        job.chunkCount = (count + chunkSize - 1) / chunkSize;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            currentJob = &job;
+            ++jobGeneration;
+        }
+        wake.notify_all();
+
+        InsideWorker() = true;
+        RunChunks(job);
+        InsideWorker() = false;
+
+        // Unpublish the job only once no worker can still be reading it
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [&] {
+            return job.activeWorkers == 0 &&
+                   job.finishedChunks.load(std::memory_order_acquire) == job.chunkCount;
+        });
+        currentJob = nullptr;
+    }
+
+private:
+    static void RunChunks(Job& job) {
+        for (;;) {
+            std::size_t chunk = job.nextChunk.fetch_add(1, std::memory_order_relaxed);
+            if (chunk >= job.chunkCount) return;
+            std::size_t begin = chunk * job.chunkSize;
+            job.invoke(job.body, begin, std::min(job.count, begin + job.chunkSize));
+            job.finishedChunks.fetch_add(1, std::memory_order_release);
+        }
+    }
+
+    void WorkerLoop() {
+        InsideWorker() = true;
+        std::size_t seenGeneration = 0;
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            wake.wait(lock, [&] {
+                return stopping || (currentJob && jobGeneration != seenGeneration);
+            });
+            if (stopping) return;
+
+            seenGeneration = jobGeneration;
+            Job* job = currentJob;
+            ++job->activeWorkers;
+            lock.unlock();
+            RunChunks(*job);
+            lock.lock();
+            --job->activeWorkers;
+            idle.notify_all();
+        }
+    }
+
+    void StopWorkers() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers) worker.join();
+        workers.clear();
+    }
+
+    void StartWorkers() {
+        stopping = false;
+        for (int i = 1; i < configuredThreads; ++i) {
+            workers.emplace_back([this] { WorkerLoop(); });
+        }
+    }
+};
+
+// Process-wide pool shared by every algorithm instance, so several charts
+// do not each start a full set of threads. It is never destroyed, so no
+// static destructor runs on its workers; the DLL stops it when the last
+// instance is released.
+inline ThreadPool& SharedThreadPool() {
+    static ThreadPool* pool = new ThreadPool;
+    return *pool;
+}
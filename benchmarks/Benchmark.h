@@ -0,0 +1,225 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Minimal benchmark harness with Google Benchmark's command line and JSON
+// schema, so its output can be diffed with Google Benchmark's compare.py
+// or any tool that reads that format. Each benchmark body runs a given
+// number of iterations; the harness grows the count until one run lasts
+// --benchmark_min_time, then reports time per iteration. Latency
+// benchmarks time every call and also report p50/p99.
+//
+//   --benchmark_filter=<regex>      Run matching benchmarks only
+//   --benchmark_min_time=<seconds>  Minimum measured time per benchmark (0.5)
+//   --benchmark_format=console|json Format written to stdout
+//   --benchmark_out=<file>          Also write JSON to <file>
+
+namespace bench {
+
+// Keep `value` alive so the computation producing it is not optimized out
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile char sink;
+    sink = *reinterpret_cast<const volatile char*>(&value);
+#endif
+}
+
+struct Result {
+    std::string name;
+    std::uint64_t iterations = 0;
+    double realTime = 0.0;         // Nanoseconds per iteration (wall clock)
+    double cpuTime = 0.0;          // Nanoseconds per iteration (process CPU, all threads)
+    double itemsPerSecond = 0.0;   // 0 when the benchmark has no item count
+    double p50 = -1.0;             // Latency percentiles in ns; < 0 when not measured
+    double p99 = -1.0;
+};
+
+class Runner {
+private:
+    std::string filter = ".*";
+    double minTime = 0.5;
+    bool json = false;
+    std::string outPath;
+    std::vector<std::pair<std::string, std::string>> context;
+    std::vector<Result> results;
+
+    using Clock = std::chrono::steady_clock;
+
+    static double Seconds(Clock::duration elapsed) { return std::chrono::duration<double>(elapsed).count(); }
+
+    bool Enabled(const std::string& name) const { return std::regex_search(name, std::regex(filter)); }
+
+    void Report(const Result& result) {
+        results.push_back(result);
+        if (json) return;
+        std::cout << std::left << std::setw(44) << result.name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(14) << result.realTime << " ns" << std::setw(14) << result.cpuTime << " ns"
+                  << std::setw(12) << result.iterations;
+        if (result.p50 >= 0.0) std::cout << "  p50=" << result.p50 << "ns p99=" << result.p99 << "ns";
+        if (result.itemsPerSecond > 0.0) {
+            std::cout << std::setprecision(3) << "  items/s=" << std::scientific << result.itemsPerSecond;
+        }
+        std::cout << std::defaultfloat << "\n";
+    }
+
+    static std::string Escape(const std::string& text) {
+        std::string escaped;
+        for (char ch : text) {
+            if (ch == '"' || ch == '\\') escaped += '\\';
+            escaped += ch;
+        }
+        return escaped;
+    }
+
+    void WriteJson(std::ostream& out) const {
+        char date[32];
+        std::time_t now = std::time(nullptr);
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+        out << "{\n  \"context\": {\n    \"date\": \"" << date << "\",\n    \"num_cpus\": "
+            << std::thread::hardware_concurrency() << ",\n    \"library_build_type\": \""
+#ifdef NDEBUG
+            << "release"
+#else
+            << "debug"
+#endif
+            << "\"";
+        for (const auto& entry : context) out << ",\n    \"" << Escape(entry.first) << "\": \"" << Escape(entry.second) << "\"";
+        out << "\n  },\n  \"benchmarks\": [";
+        out << std::setprecision(17);
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const Result& r = results[i];
+            out << (i ? "," : "") << "\n    {\n      \"name\": \"" << Escape(r.name) << "\",\n      \"run_name\": \""
+                << Escape(r.name) << "\",\n      \"run_type\": \"iteration\",\n      \"iterations\": " << r.iterations
+                << ",\n      \"real_time\": " << r.realTime << ",\n      \"cpu_time\": " << r.cpuTime
+                << ",\n      \"time_unit\": \"ns\"";
+            if (r.itemsPerSecond > 0.0) out << ",\n      \"items_per_second\": " << r.itemsPerSecond;
+            if (r.p50 >= 0.0) out << ",\n      \"p50\": " << r.p50 << ",\n      \"p99\": " << r.p99;
+            out << "\n    }";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+public:
+    // Parse the --benchmark_* flags; false (after printing usage) on an
+    // unknown argument
+    bool Parse(int argc, char* argv[]) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = [&](const char* flag) -> const char* {
+                std::size_t length = std::strlen(flag);
+                return arg.compare(0, length, flag) == 0 ? argv[i] + length : nullptr;
+            };
+            if (const char* v = value("--benchmark_filter=")) filter = v;
+            else if (const char* v = value("--benchmark_min_time=")) minTime = std::max(std::atof(v), 1e-3);
+            else if (const char* v = value("--benchmark_format=")) json = std::string(v) == "json";
+            else if (const char* v = value("--benchmark_out=")) outPath = v;
+            else {
+                std::cerr << "Unknown argument " << arg << "\nFlags: --benchmark_filter=<regex> "
+                          << "--benchmark_min_time=<seconds> --benchmark_format=console|json "
+                          << "--benchmark_out=<file>\n";
+                return false;
+            }
+        }
+        if (!json) {
+            std::cout << std::left << std::setw(44) << "Benchmark" << std::right << std::setw(17) << "Time"
+                      << std::setw(17) << "CPU" << std::setw(12) << "Iterations" << "\n"
+                      << std::string(90, '-') << "\n";
+        }
+        return true;
+    }
+
+    // Extra "context" entries for the JSON output (seed, ISA, threads, ...)
+    void AddContext(const std::string& key, const std::string& value) { context.emplace_back(key, value); }
+
+    // body(iterations) runs the benchmark `iterations` times; each
+    // iteration processes itemsPerIteration items (0 for none)
+    template <typename Body>
+    void Run(const std::string& name, double itemsPerIteration, const Body& body) {
+        if (!Enabled(name)) return;
+        body(1);   // Warm caches, pools and lazily built tables
+        std::uint64_t iterations = 1;
+        for (;;) {
+            std::clock_t cpuStart = std::clock();
+            Clock::time_point start = Clock::now();
+            body(iterations);
+            double elapsed = Seconds(Clock::now() - start);
+            double cpu = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+            if (elapsed >= minTime || iterations >= (std::uint64_t(1) << 40)) {
+                Result result;
+                result.name = name;
+                result.iterations = iterations;
+                result.realTime = elapsed * 1e9 / iterations;
+                result.cpuTime = cpu * 1e9 / iterations;
+                result.itemsPerSecond = itemsPerIteration * iterations / elapsed;
+                Report(result);
+                return;
+            }
+            // Aim 40% past the target, growing at most tenfold per round
+            double factor = elapsed > 0.0 ? 1.4 * minTime / elapsed : 10.0;
+            iterations = static_cast<std::uint64_t>(iterations * std::min(std::max(factor, 1.5), 10.0)) + 1;
+        }
+    }
+
+    // Time every call of call() separately for --benchmark_min_time (and at
+    // least 1000 calls); reports the mean and the p50/p99 latencies
+    template <typename Call>
+    void RunLatency(const std::string& name, const Call& call) {
+        if (!Enabled(name)) return;
+        for (int i = 0; i < 100; ++i) call();
+        std::vector<double> samples;
+        std::clock_t cpuStart = std::clock();
+        Clock::time_point start = Clock::now();
+        double elapsed = 0.0;
+        while (elapsed < minTime || samples.size() < 1000) {
+            Clock::time_point callStart = Clock::now();
+            call();
+            Clock::time_point callEnd = Clock::now();
+            samples.push_back(std::chrono::duration<double, std::nano>(callEnd - callStart).count());
+            elapsed = Seconds(callEnd - start);
+        }
+        double cpu = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+
+        Result result;
+        result.name = name;
+        result.iterations = samples.size();
+        result.realTime = elapsed * 1e9 / samples.size();
+        result.cpuTime = cpu * 1e9 / samples.size();
+        std::sort(samples.begin(), samples.end());
+        result.p50 = samples[samples.size() / 2];
+        result.p99 = samples[std::min(samples.size() - 1, samples.size() * 99 / 100)];
+        Report(result);
+    }
+
+    // Write the JSON report to stdout (--benchmark_format=json) and/or the
+    // --benchmark_out file; returns the process exit code
+    int Finish() const {
+        if (json) WriteJson(std::cout);
+        if (!outPath.empty()) {
+            std::ofstream out(outPath);
+            if (!out) {
+                std::cerr << "Cannot write " << outPath << "\n";
+                return 1;
+            }
+            WriteJson(out);
+        }
+        return 0;
+    }
+};
+
+} // namespace bench
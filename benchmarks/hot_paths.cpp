@@ -0,0 +1,372 @@
+/*
+Microbenchmarks for the per-bar hot paths: AnalyzeBar latency (per engine,
+for the screening preset and with the signal cache), UpdateTick, a
+book-wide bar close, the Monte Carlo engines, the streaming volatility
+update, the option chain pricer, the pricing surface and the normal CDF
+tiers. Inputs come from fixed seeds, so runs on one machine are comparable
+across commits:
+
+  cmake --build build --target hot_paths    (or hot_paths_avx2, hot_paths_avx512)
+  g++ -std=c++14 -O2 -DNDEBUG -pthread benchmarks/hot_paths.cpp -o hot_paths
+  ./hot_paths --benchmark_out=baseline.json
+  ./hot_paths --benchmark_filter=MonteCarlo --benchmark_format=json
+*/
+
+#include <random>
+#include <string>
+#include <vector>
+
+#define STANDALONE_TEST
+#include "../BlackScholesTradeStation.cpp"
+#include "Benchmark.h"
+
+namespace {
+
+constexpr std::uint64_t kBenchmarkSeed = 42;
+
+const char* SimdLevelName(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::Avx512: return "avx512";
+    case SimdLevel::Avx2: return "avx2";
+    default: return "scalar";
+    }
+}
+
+const char* EngineName(SimulationEngine engine) {
+    switch (engine) {
+    case SimulationEngine::PathStepping: return "PathStepping";
+    case SimulationEngine::Analytic: return "Analytic";
+    case SimulationEngine::Barrier: return "Barrier";
+    default: return "TerminalSampling";
+    }
+}
+
+template <CdfAccuracy Tier>
+const char* TierName();
+template <> const char* TierName<CdfAccuracy::Libm>() { return "libm"; }
+template <> const char* TierName<CdfAccuracy::Rational>() { return "rational"; }
+template <> const char* TierName<CdfAccuracy::Fast>() { return "fast"; }
+
+// Seeded daily closes, a random walk from 400 with 1.5% daily moves
+std::vector<double> SeededCloses(std::size_t count) {
+    std::mt19937 gen(kBenchmarkSeed);
+    std::normal_distribution<> dailyReturn(0.0003, 0.015);
+    std::vector<double> closes = {400.0};
+    while (closes.size() < count) closes.push_back(closes.back() * std::exp(dailyReturn(gen)));
+    return closes;
+}
+
+void BenchmarkAnalyzeBar(bench::Runner& runner, const std::vector<double>& closes) {
+    for (SimulationEngine engine : {SimulationEngine::TerminalSampling, SimulationEngine::PathStepping,
+                                    SimulationEngine::Analytic, SimulationEngine::Barrier}) {
+        BlackScholesTradeStation algo;
+        algo.SetRandomSeed(kBenchmarkSeed);
+        algo.SetSimulationEngine(engine);
+        algo.LoadHistory(closes.data(), 300);
+        std::size_t bar = 300;
+        runner.RunLatency(std::string("BM_AnalyzeBar/") + EngineName(engine), [&]() {
+            double close = closes[bar % closes.size()];
+            double buySignal, sellSignal, confidence;
+            int action = algo.AnalyzeBar(close, close, close, close, 1e6, static_cast<int>(++bar),
+                                         buySignal, sellSignal, confidence);
+            bench::DoNotOptimize(action);
+            bench::DoNotOptimize(confidence);
+        });
+    }
+    
+    // Compile-time screening preset: analytic engine, fast CDF tier
+    ScreeningTradeStation screening;
+    screening.LoadHistory(closes.data(), 300);
+    std::size_t bar = 300;
+    runner.RunLatency("BM_AnalyzeBar/ScreeningPreset", [&]() {
+        double close = closes[bar % closes.size()];
+        double buySignal, sellSignal, confidence;
+        int action = screening.AnalyzeBar(close, close, close, close, 1e6, static_cast<int>(++bar),
+                                          buySignal, sellSignal, confidence);
+        bench::DoNotOptimize(action);
+        bench::DoNotOptimize(confidence);
+    });
+}
+
+// Intrabar ticks moving within the epsilon, so the cached distribution is
+// reused: the tick-rate path of UpdateTick
+void BenchmarkUpdateTick(bench::Runner& runner, const std::vector<double>& closes) {
+    BlackScholesTradeStation algo;
+    algo.SetRandomSeed(kBenchmarkSeed);
+    algo.LoadHistory(closes.data(), 300, 1);
+    std::size_t tick = 0;
+    runner.RunLatency("BM_UpdateTick/Cached", [&]() {
+        double price = closes[299] * (1.0 + 0.0004 * std::sin(0.01 * static_cast<double>(++tick)));
+        double buySignal, sellSignal, confidence;
+        int action = algo.UpdateTick(price, buySignal, sellSignal, confidence);
+        bench::DoNotOptimize(action);
+        bench::DoNotOptimize(confidence);
+    });
+}
+
+// A quiet, range-bound name (closes alternating 0.4% around 400) with the
+// signal cache on, so nearly every bar reuses a cached signal
+void BenchmarkSignalCache(bench::Runner& runner) {
+    std::vector<double> closes;
+    for (int i = 0; i < 1000; ++i) closes.push_back(400.0 * (1.0 + ((i % 2) ? 0.004 : -0.004)));
+    BlackScholesTradeStation algo;
+    algo.SetRandomSeed(kBenchmarkSeed);
+    algo.SetSignalCacheTolerance(0.02);
+    algo.LoadHistory(closes.data(), 300, 1);
+    std::size_t bar = 300;
+    runner.RunLatency("BM_AnalyzeBar/SignalCache", [&]() {
+        double close = closes[bar % closes.size()];
+        double buySignal, sellSignal, confidence;
+        int action = algo.AnalyzeBar(close, close, close, close, 1e6, static_cast<int>(++bar),
+                                     buySignal, sellSignal, confidence);
+        bench::DoNotOptimize(action);
+        bench::DoNotOptimize(confidence);
+    });
+}
+
+// One bar close for a 300-symbol book of 1000-path instances, symbol by
+// symbol through AnalyzeBar and as one PortfolioEngine batch
+void BenchmarkPortfolio(bench::Runner& runner, const std::vector<double>& closes) {
+    const std::size_t symbols = 300;
+    std::vector<BlackScholesTradeStation> book(symbols);
+    std::vector<BlackScholesTradeStation*> instances;
+    for (std::size_t i = 0; i < symbols; ++i) {
+        book[i].SetRandomSeed(kBenchmarkSeed + i);
+        book[i].LoadHistory(closes.data() + i, 300);
+        instances.push_back(&book[i]);
+    }
+    std::vector<double> barCloses(symbols);
+    std::vector<int> actions(symbols);
+    std::size_t bar = 300;
+    
+    runner.Run("BM_BookBarClose/Sequential/300", symbols, [&](std::uint64_t iterations) {
+        for (std::uint64_t n = 0; n < iterations; ++n, ++bar) {
+            for (std::size_t i = 0; i < symbols; ++i) {
+                double close = closes[(bar + i) % closes.size()];
+                double buySignal, sellSignal, confidence;
+                actions[i] = book[i].AnalyzeBar(close, close, close, close, 1e6, static_cast<int>(bar),
+                                                buySignal, sellSignal, confidence);
+            }
+            bench::DoNotOptimize(actions[0]);
+        }
+    });
+    
+    PortfolioEngine<BlackScholesTradeStation> portfolio;
+    runner.Run("BM_BookBarClose/Portfolio/300", symbols, [&](std::uint64_t iterations) {
+        for (std::uint64_t n = 0; n < iterations; ++n, ++bar) {
+            for (std::size_t i = 0; i < symbols; ++i) barCloses[i] = closes[(bar + i) % closes.size()];
+            portfolio.AnalyzeBars(instances.data(), barCloses.data(), symbols, actions.data(),
+                                  nullptr, nullptr, nullptr);
+            bench::DoNotOptimize(actions[0]);
+        }
+    });
+}
+
+void BenchmarkMonteCarlo(bench::Runner& runner, const std::vector<double>& closes) {
+    for (SimulationEngine engine : {SimulationEngine::TerminalSampling, SimulationEngine::PathStepping,
+                                    SimulationEngine::Barrier}) {
+        for (int paths : {1000, 10000, 100000}) {
+            BlackScholesTradeStation algo;
+            algo.SetRandomSeed(kBenchmarkSeed);
+            algo.SetSimulationEngine(engine);
+            algo.SetMonteCarloSimulations(paths);
+            algo.LoadHistory(closes.data(), 300);
+            runner.Run(std::string("BM_MonteCarloSimulation/") + EngineName(engine) + "/" + std::to_string(paths),
+                       paths, [&](std::uint64_t iterations) {
+                for (std::uint64_t i = 0; i < iterations; ++i) {
+                    TerminalDistribution distribution = algo.EstimateTerminalDistribution(400.0, 0.08, 0.2);
+                    bench::DoNotOptimize(distribution.profitProbability);
+                }
+            });
+        }
+    }
+}
+
+// One close through the rolling windows plus the volatility read, the
+// per-bar cost of the estimator at each lookback
+void BenchmarkVolatility(bench::Runner& runner, const std::vector<double>& closes) {
+    for (int lookback : {21, 63, 252, 1008}) {
+        BlackScholesTradeStation algo;
+        algo.SetLookbackPeriod(lookback);
+        algo.LoadHistory(closes.data(), 2 * lookback);
+        std::size_t bar = 0;
+        runner.Run("BM_CalculateVolatility/" + std::to_string(lookback), 1, [&](std::uint64_t iterations) {
+            for (std::uint64_t i = 0; i < iterations; ++i) {
+                algo.LoadHistory(&closes[bar++ % closes.size()], 1);
+                bench::DoNotOptimize(algo.GetVolatility());
+            }
+        });
+    }
+    
+    // Yang-Zhang from OHLC bars at the short lookback it allows
+    std::vector<double> opens(closes.size()), highs(closes.size()), lows(closes.size());
+    for (std::size_t i = 0; i < closes.size(); ++i) {
+        opens[i] = i ? closes[i - 1] : closes[i];
+        highs[i] = std::max(opens[i], closes[i]) * 1.004;
+        lows[i] = std::min(opens[i], closes[i]) * 0.996;
+    }
+    BlackScholesTradeStation algo;
+    algo.SetLookbackPeriod(21);
+    algo.SetVolatilityEstimator(VolatilityEstimator::YangZhang);
+    BarSeries bars;
+    bars.open = opens.data();
+    bars.high = highs.data();
+    bars.low = lows.data();
+    bars.close = closes.data();
+    bars.count = 42;
+    algo.LoadHistory(bars);
+    std::size_t bar = 0;
+    runner.Run("BM_CalculateVolatility/YangZhang/21", 1, [&](std::uint64_t iterations) {
+        for (std::uint64_t i = 0; i < iterations; ++i) {
+            std::size_t index = bar++ % closes.size();
+            BarSeries next;
+            next.open = &opens[index];
+            next.high = &highs[index];
+            next.low = &lows[index];
+            next.close = &closes[index];
+            next.count = 1;
+            algo.LoadHistory(next);
+            bench::DoNotOptimize(algo.GetVolatility());
+        }
+    });
+}
+
+void BenchmarkOptionChain(bench::Runner& runner) {
+    std::mt19937 gen(kBenchmarkSeed);
+    std::uniform_real_distribution<> strike(300.0, 500.0), expiry(7.0 / 365.0, 2.0);
+    for (std::size_t count : {std::size_t(2), std::size_t(1024)}) {
+        std::vector<double> strikes(count), expiries(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            strikes[i] = strike(gen);
+            expiries[i] = expiry(gen);
+        }
+        std::sort(expiries.begin(), expiries.end());
+        std::vector<double> callPrice(count), putPrice(count), callDelta(count), putDelta(count),
+            gamma(count), vega(count), callTheta(count), putTheta(count);
+        simd::OptionChainOutputs outputs;
+        outputs.callPrice = callPrice.data();
+        outputs.putPrice = putPrice.data();
+        outputs.callDelta = callDelta.data();
+        outputs.putDelta = putDelta.data();
+        outputs.gamma = gamma.data();
+        outputs.vega = vega.data();
+        outputs.callTheta = callTheta.data();
+        outputs.putTheta = putTheta.data();
+        simd::OptionChainMarket market;
+        market.spot = 400.0;
+        market.rate = 0.02;
+        market.volatility = 0.2;
+
+        for (int level = 0; level <= static_cast<int>(ActiveSimdLevel()); ++level) {
+            SimdLevel isa = static_cast<SimdLevel>(level);
+            runner.Run(std::string("BM_PriceOptionChain/") + SimdLevelName(isa) + "/" + std::to_string(count),
+                       static_cast<double>(count), [&](std::uint64_t iterations) {
+                for (std::uint64_t i = 0; i < iterations; ++i) {
+                    simd::PriceOptionChain(isa, market, strikes.data(), expiries.data(), count, outputs);
+                    bench::DoNotOptimize(callPrice[0]);
+                }
+            });
+        }
+    }
+}
+
+// The signal's call/put pair from the volatility table, against pricing
+// the same two contracts (BM_PriceOptionChain/.../2)
+void BenchmarkPricingSurface(bench::Runner& runner) {
+    PricingSurface surface;
+    surface.Build(0.02, 30.0 / 365.0, 1.05, 0.95);
+    std::mt19937 gen(kBenchmarkSeed);
+    std::uniform_real_distribution<> volatility(0.05, 0.8);
+    std::vector<double> volatilities(1024);
+    for (double& v : volatilities) v = volatility(gen);
+    runner.Run("BM_PricingSurface/Lookup", 2.0, [&](std::uint64_t iterations) {
+        for (std::uint64_t i = 0; i < iterations; ++i) {
+            double call = 0.0, put = 0.0;
+            surface.Lookup(volatilities[i & 1023], call, put);
+            bench::DoNotOptimize(call);
+            bench::DoNotOptimize(put);
+        }
+    });
+}
+
+template <CdfAccuracy Tier>
+void BenchmarkNormalCdfTier(bench::Runner& runner, const std::vector<double>& x, std::vector<double>& out) {
+    runner.Run(std::string("BM_NormalCDF/") + TierName<Tier>(), static_cast<double>(x.size()),
+               [&](std::uint64_t iterations) {
+        for (std::uint64_t i = 0; i < iterations; ++i) {
+            for (std::size_t j = 0; j < x.size(); ++j) out[j] = NormalCDF<Tier>(x[j]);
+            bench::DoNotOptimize(out[0]);
+        }
+    });
+    for (int level = 0; level <= static_cast<int>(ActiveSimdLevel()); ++level) {
+        SimdLevel isa = static_cast<SimdLevel>(level);
+        runner.Run(std::string("BM_NormalCdfArray/") + SimdLevelName(isa) + "/" + TierName<Tier>(),
+                   static_cast<double>(x.size()), [&](std::uint64_t iterations) {
+            for (std::uint64_t i = 0; i < iterations; ++i) {
+                simd::NormalCdf<Tier>(isa, x.data(), x.size(), out.data());
+                bench::DoNotOptimize(out[0]);
+            }
+        });
+    }
+}
+
+void BenchmarkNormalCdf(bench::Runner& runner) {
+    std::mt19937 gen(kBenchmarkSeed);
+    std::uniform_real_distribution<> uniform(-8.0, 8.0);
+    std::vector<double> x(4096), out(4096);
+    for (double& value : x) value = uniform(gen);
+    BenchmarkNormalCdfTier<CdfAccuracy::Libm>(runner, x, out);
+    BenchmarkNormalCdfTier<CdfAccuracy::Rational>(runner, x, out);
+    BenchmarkNormalCdfTier<CdfAccuracy::Fast>(runner, x, out);
+}
+
+// Block normal draws: Ziggurat over each generator, against the
+// mt19937 + std::normal_distribution pair it replaced
+template <typename Generator>
+void BenchmarkZiggurat(bench::Runner& runner, const char* name, const Generator& generator, std::vector<double>& out) {
+    ZigguratNormal<Generator> normal(generator);
+    runner.Run(std::string("BM_NormalFill/Ziggurat/") + name, static_cast<double>(out.size()),
+               [&](std::uint64_t iterations) {
+        for (std::uint64_t i = 0; i < iterations; ++i) {
+            normal.Fill(out.data(), out.size());
+            bench::DoNotOptimize(out[0]);
+        }
+    });
+}
+
+void BenchmarkNormalSamplers(bench::Runner& runner) {
+    std::vector<double> out(4096);
+    std::mt19937 gen(kBenchmarkSeed);
+    std::normal_distribution<> standard;
+    runner.Run("BM_NormalFill/StdNormalDistribution", static_cast<double>(out.size()), [&](std::uint64_t iterations) {
+        for (std::uint64_t i = 0; i < iterations; ++i) {
+            for (double& z : out) z = standard(gen);
+            bench::DoNotOptimize(out[0]);
+        }
+    });
+    BenchmarkZiggurat(runner, "Xoshiro256", Xoshiro256(kBenchmarkSeed), out);
+    BenchmarkZiggurat(runner, "Philox4x32", Philox4x32(kBenchmarkSeed), out);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    bench::Runner runner;
+    if (!runner.Parse(argc, argv)) return 2;
+    runner.AddContext("seed", std::to_string(kBenchmarkSeed));
+    runner.AddContext("simd_level", SimdLevelName(ActiveSimdLevel()));
+    runner.AddContext("threads", std::to_string(SharedThreadPool().ThreadCount()));
+
+    std::vector<double> closes = SeededCloses(4096);
+    BenchmarkAnalyzeBar(runner, closes);
+    BenchmarkUpdateTick(runner, closes);
+    BenchmarkSignalCache(runner);
+    BenchmarkPortfolio(runner, closes);
+    BenchmarkMonteCarlo(runner, closes);
+    BenchmarkVolatility(runner, closes);
+    BenchmarkOptionChain(runner);
+    BenchmarkPricingSurface(runner);
+    BenchmarkNormalCdf(runner);
+    BenchmarkNormalSamplers(runner);
+    return runner.Finish();
+}
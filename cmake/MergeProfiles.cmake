@@ -0,0 +1,11 @@
+# Merge the raw Clang profiles of a pgo_train run into one .profdata file:
+#   cmake -DLLVM_PROFDATA=... -DPROFILE_DIR=... -DOUTPUT=... -P MergeProfiles.cmake
+file(GLOB raw_profiles "${PROFILE_DIR}/*.profraw")
+if(NOT raw_profiles)
+    message(FATAL_ERROR "No .profraw files in ${PROFILE_DIR}; did the training run use the GENERATE build?")
+endif()
+execute_process(COMMAND "${LLVM_PROFDATA}" merge "-output=${OUTPUT}" ${raw_profiles}
+                RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "llvm-profdata merge failed (${result})")
+endif()
@@ -0,0 +1,35 @@
+// Convert a TradeStation CSV export (File > Export Data, or the Data
+// Window's "Send to File") to the columnar bar format read by BarFile.h.
+//
+//   convert_bars input.csv output.bars
+//
+// Build: cmake --build build --target convert_bars, or
+//        g++ -std=c++14 -O2 -o convert_bars examples/convert_bars.cpp
+
+#include <iostream>
+
+#include "../BarFile.h"
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: convert_bars input.csv output.bars\n";
+        return 2;
+    }
+
+    BarColumns columns;
+    if (!ReadTradeStationCsv(argv[1], columns)) {
+        std::cerr << "Cannot parse " << argv[1] << " as a TradeStation CSV export\n";
+        return 1;
+    }
+    if (!WriteBarFile(argv[2], columns)) {
+        std::cerr << "Cannot write " << argv[2] << "\n";
+        return 1;
+    }
+
+    std::cout << "Wrote " << columns.Size() << " bars";
+    if (columns.Size() > 0) {
+        std::cout << " (" << columns.timestamps.front() << " to " << columns.timestamps.back() << ")";
+    }
+    std::cout << " to " << argv[2] << "\n";
+    return 0;
+}
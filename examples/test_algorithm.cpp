@@ -7,11 +7,24 @@ Standalone testing without TradeStation dependency
 #include <vector>
 #include <iomanip>
 #include <fstream>
+#include <chrono>
+#include <thread>
 
-// Include the main algorithm (without TradeStation DLL exports)
+// Include the main algorithm (without TradeStation DLL exports). The
+// allocation check makes every warm AnalyzeBar in the suite heap-free.
 #define STANDALONE_TEST
+#ifndef BSTS_CHECK_ALLOCATIONS
+#define BSTS_CHECK_ALLOCATIONS 1
+#endif
 #include "../BlackScholesTradeStation.cpp"
 
+// Every Monte Carlo random number hook swapped: runs the scalar path loop
+struct ZigguratFloatPolicy : DefaultSignalPolicy {
+    using Rng = Xoshiro256;
+    template <typename Generator> using NormalSampler = ZigguratNormal<Generator>;
+    using Real = float;
+};
+
 class AlgorithmTester {
 private:
     BlackScholesTradeStation algo;
@@ -60,6 +73,81 @@ public:
         // Test 4: Parameter sensitivity
         TestParameterSensitivity();
         
+        // Test 5: Streaming volatility vs batch computation
+        TestRollingVolatility();
+        
+        // Test 6: Analytic engine vs Monte Carlo engines
+        TestAnalyticEngine();
+        
+        // Test 7: Vectorized path kernel agrees across instruction sets
+        TestSimdKernels();
+        
+        // Test 8: Multi-threaded simulation is reproducible
+        TestThreadedDeterminism();
+        
+        // Test 9: Variance reduction modes and their standard errors
+        TestVarianceReduction();
+        
+        // Test 10: Instance handles
+        TestInstanceTable();
+        
+        // Test 11: Bulk history warm-up
+        TestLoadHistory();
+        
+        // Test 12: Option chain pricer vs closed form
+        TestOptionChainPricer();
+        
+        // Test 13: Normal CDF accuracy tiers
+        TestNormalCdfTiers();
+        
+        // Test 14: Implied volatility round trip and warm starts
+        TestImpliedVolatility();
+        
+        // Test 15: Parallel walk-forward parameter sweep
+        TestWalkForwardSweep();
+        
+        // Test 16: Backtester order rules and metrics
+        TestBacktester();
+        
+        // Test 17: Bar file conversion and memory-mapped replay
+        TestBarFile();
+        
+        // Test 18: Per-stage latency histograms
+        TestPerfStats();
+        
+        // Test 19: Allocation-free steady state
+        TestSteadyStateAllocations();
+        
+        // Test 20: Intrabar tick updates
+        TestUpdateTick();
+        
+        // Test 21: Portfolio-wide batched bar close
+        TestPortfolioEngine();
+        
+        // Test 22: Asynchronous signal pipeline
+        TestAsyncSignals();
+        
+        // Test 23: Quantized signal cache
+        TestSignalCache();
+        
+        // Test 24: Tabulated signal option values
+        TestPricingSurface();
+        
+        // Test 25: Compile-time engine presets
+        TestSignalPolicies();
+        
+        // Test 26: Generators, Ziggurat sampler and seed replay
+        TestRandomNumbers();
+        
+        // Test 27: State snapshots and restore
+        TestStateFiles();
+        
+        // Test 28: Range-based volatility estimators
+        TestRangeVolatility();
+        
+        // Test 29: Stop-loss / take-profit first passage
+        TestBarrierEngine();
+        
         // Generate report
         GenerateReport();
     }
@@ -180,6 +268,24 @@ private:
             std::cout << "FAIL ✗ (Position should have triggered take profit)\n";
         }
         
+        // A short as the ELD reports it: each bar closes, then the position
+        // is set from CurrentShares * MarketPosition
+        BlackScholesTradeStation shortAlgo;
+        const int currentShares = 100, marketPosition = -1;
+        const double shortCloses[] = {410.0, 420.0, 380.0, 340.0};   // P&L -2.5%, -5% (stop), +5%, +15% (target)
+        bool shouldClose[4];
+        for (int i = 0; i < 4; ++i) {
+            double buy, sell, confidence;
+            double close = shortCloses[i];
+            shortAlgo.AnalyzeBar(close, close + 1, close - 1, close, 1000000, i + 1, buy, sell, confidence);
+            shortAlgo.SetPosition(400.0, currentShares * marketPosition);
+            shouldClose[i] = shortAlgo.ShouldClosePosition();
+        }
+        bool shortPass = !shouldClose[0] && shouldClose[1] && !shouldClose[2] && shouldClose[3] &&
+                         shortAlgo.GetUnrealizedPnL() == 6000.0;
+        std::cout << "Short Stop/Target Test: " << (shortPass ? "PASS ✓" : "FAIL ✗")
+                  << " (stop at +5%, target at -15%)\n";
+        
         std::cout << "\n";
     }
     
@@ -208,6 +314,1899 @@ private:
         std::cout << "\n";
     }
     
+    void TestRollingVolatility() {
+        std::cout << "Test 5: Rolling Volatility Accuracy\n";
+        std::cout << "-----------------------------------\n";
+        
+        // Long series with a short lookback so the window slides and resyncs
+        const int lookback = 60;
+        const int bars = 5000;
+        BlackScholesTradeStation testAlgo;
+        testAlgo.SetLookbackPeriod(lookback);
+        testAlgo.SetMonteCarloSimulations(10);
+        
+        std::mt19937 gen(42);
+        std::normal_distribution<> dailyReturn(0.0005, 0.015);
+        std::vector<double> closes = {400.0};
+        for (int i = 1; i < bars; ++i) {
+            closes.push_back(closes.back() * (1.0 + dailyReturn(gen)));
+        }
+        
+        double maxVolError = 0.0;
+        double maxDriftError = 0.0;
+        for (int i = 0; i < bars; ++i) {
+            double buySignal, sellSignal, confidence;
+            testAlgo.AnalyzeBar(closes[i], closes[i] + 1, closes[i] - 1, closes[i], 1000000,
+                              i + 1, buySignal, sellSignal, confidence);
+            
+            // Two-pass batch reference over the same returns window
+            std::vector<double> window;
+            int first = std::max(1, i - lookback + 1);
+            for (int j = first; j <= i; ++j) {
+                window.push_back(std::log(closes[j] / closes[j - 1]));
+            }
+            if (window.size() < 21) continue;
+            
+            double mean = 0.0;
+            for (double r : window) mean += r;
+            mean /= window.size();
+            double variance = 0.0;
+            for (double r : window) variance += (r - mean) * (r - mean);
+            double batchVol = std::sqrt(variance / (window.size() - 1) * 252);
+            
+            double drift = 0.0;
+            for (size_t j = window.size() - 21; j < window.size(); ++j) drift += window[j];
+            double batchDrift = drift / 21 * 252;
+            
+            maxVolError = std::max(maxVolError, std::abs(testAlgo.GetVolatility() - batchVol) / batchVol);
+            maxDriftError = std::max(maxDriftError, std::abs(testAlgo.GetExpectedReturn() - batchDrift));
+        }
+        
+        std::cout << "Volatility vs batch (rel 1e-9): ";
+        if (maxVolError < 1e-9) {
+            std::cout << "PASS ✓ (max error " << std::scientific << maxVolError << ")\n";
+        } else {
+            std::cout << "FAIL ✗ (max error " << std::scientific << maxVolError << ")\n";
+        }
+        std::cout << "Drift vs batch (abs 1e-9): ";
+        if (maxDriftError < 1e-9) {
+            std::cout << "PASS ✓ (max error " << maxDriftError << ")\n";
+        } else {
+            std::cout << "FAIL ✗ (max error " << maxDriftError << ")\n";
+        }
+        std::cout << std::fixed << "\n";
+    }
+    
+    void TestAnalyticEngine() {
+        std::cout << "Test 6: Analytic Engine Cross-Check\n";
+        std::cout << "-----------------------------------\n";
+        
+        const double price = 400.0, drift = 0.12, volatility = 0.25;
+        BlackScholesTradeStation testAlgo;
+        testAlgo.SetSimulationEngine(SimulationEngine::Analytic);
+        TerminalDistribution exact = testAlgo.EstimateTerminalDistribution(price, drift, volatility);
+        
+        // 200k paths: probability standard error ~0.0011, mean ~0.05
+        testAlgo.SetMonteCarloSimulations(200000);
+        const SimulationEngine engines[] = {SimulationEngine::TerminalSampling,
+                                            SimulationEngine::PathStepping};
+        const char* names[] = {"Terminal sampling", "Path stepping"};
+        
+        for (int i = 0; i < 2; ++i) {
+            testAlgo.SetSimulationEngine(engines[i]);
+            TerminalDistribution simulated = testAlgo.EstimateTerminalDistribution(price, drift, volatility);
+            
+            bool match = std::abs(simulated.profitProbability - exact.profitProbability) < 0.006 &&
+                         std::abs(simulated.lossProbability - exact.lossProbability) < 0.006 &&
+                         std::abs(simulated.meanPrice - exact.meanPrice) < 0.3;
+            
+            std::cout << names[i] << " vs analytic: " << (match ? "PASS ✓" : "FAIL ✗")
+                      << std::setprecision(4) << " (P(profit) " << simulated.profitProbability
+                      << " vs " << exact.profitProbability << ", P(loss) " << simulated.lossProbability
+                      << " vs " << exact.lossProbability << ")\n";
+        }
+        std::cout << "\n";
+    }
+    
+    void TestSimdKernels() {
+        std::cout << "Test 7: SIMD Path Kernel\n";
+        std::cout << "------------------------\n";
+        
+        simd::GbmTileParameters parameters;
+        parameters.spot = 400.0;
+        parameters.stepDrift = (0.12 - 0.5 * 0.25 * 0.25) / 252.0;
+        parameters.stepVolatility = 0.25 * std::sqrt(1.0 / 252.0);
+        parameters.steps = 21;
+        parameters.seed = 0x5EEDULL;
+        parameters.stream = 3;
+        
+        const std::uint64_t tiles = 64;
+        std::vector<double> reference(tiles * simd::kGbmTilePaths);
+        simd::SimulateGbmTiles(SimdLevel::Scalar, parameters, 0, tiles, reference.data());
+        
+        // Every supported ISA must reproduce the scalar paths to rounding
+        const SimdLevel levels[] = {SimdLevel::Avx2, SimdLevel::Avx512};
+        const char* names[] = {"AVX2", "AVX-512"};
+        for (int i = 0; i < 2; ++i) {
+            if (static_cast<int>(levels[i]) > static_cast<int>(DetectSimdLevel())) {
+                std::cout << names[i] << " vs scalar: SKIPPED (not supported by this CPU)\n";
+                continue;
+            }
+            std::vector<double> vectorized(reference.size());
+            simd::SimulateGbmTiles(levels[i], parameters, 0, tiles, vectorized.data());
+            
+            double maxError = 0.0;
+            for (size_t j = 0; j < reference.size(); ++j) {
+                maxError = std::max(maxError, std::abs(vectorized[j] - reference[j]) / reference[j]);
+            }
+            std::cout << names[i] << " vs scalar (rel 1e-12): " << (maxError < 1e-12 ? "PASS ✓" : "FAIL ✗")
+                      << std::scientific << std::setprecision(3) << " (max error " << maxError << ")\n"
+                      << std::fixed;
+        }
+        
+        // Paths depend only on (seed, stream, tile), so any split of the tile
+        // range reproduces the single-call result
+        std::vector<double> split(reference.size());
+        simd::SimulateGbmTiles(parameters, 0, 24, split.data());
+        simd::SimulateGbmTiles(parameters, 24, tiles - 24, split.data() + 24 * simd::kGbmTilePaths);
+        bool identical = true;
+        for (size_t j = 0; j < reference.size(); ++j) {
+            if (std::abs(split[j] - reference[j]) > 1e-12 * reference[j]) identical = false;
+        }
+        std::cout << "Split tile ranges: " << (identical ? "PASS ✓" : "FAIL ✗") << "\n";
+
+        // The fused reduction must match sums over the stored paths, for
+        // every ISA, split ranges and a path limit inside the last tile
+        simd::TerminalReduction reduction;
+        reduction.profitLevel = parameters.spot * 1.02;
+        reduction.lossLevel = parameters.spot * 0.98;
+        reduction.pathLimit = reference.size() - 5;
+        simd::TerminalPriceSums expected;
+        for (std::uint64_t j = 0; j < reduction.pathLimit; ++j) {
+            double deviation = reference[j] - parameters.spot;
+            expected.paths += 1.0;
+            expected.price += deviation;
+            expected.priceSquared += deviation * deviation;
+            expected.profit += reference[j] > reduction.profitLevel;
+            expected.loss += reference[j] < reduction.lossLevel;
+            expected.priceProfit += reference[j] > reduction.profitLevel ? deviation : 0.0;
+        }
+        bool reduced = true;
+        for (int level = 0; level <= static_cast<int>(DetectSimdLevel()); ++level) {
+            simd::TerminalPriceSums sums;
+            simd::ReduceGbmTiles(static_cast<SimdLevel>(level), parameters, reduction, 0, 24, sums);
+            simd::ReduceGbmTiles(static_cast<SimdLevel>(level), parameters, reduction, 24, tiles - 24, sums);
+            if (sums.paths != expected.paths || sums.profit != expected.profit || sums.loss != expected.loss ||
+                std::abs(sums.price - expected.price) > 1e-9 * expected.priceSquared ||
+                std::abs(sums.priceSquared - expected.priceSquared) > 1e-9 * expected.priceSquared ||
+                std::abs(sums.priceProfit - expected.priceProfit) > 1e-9 * expected.priceSquared) {
+                reduced = false;
+            }
+        }
+        std::cout << "Fused terminal reduction: " << (reduced ? "PASS ✓" : "FAIL ✗") << " ("
+                  << static_cast<int>(expected.paths) << " paths)\n\n";
+    }
+    
+    void TestThreadedDeterminism() {
+        std::cout << "Test 8: Threaded Simulation Determinism\n";
+        std::cout << "---------------------------------------\n";
+        
+        BlackScholesTradeStation testAlgo;
+        testAlgo.SetMonteCarloSimulations(50000);
+        
+        // Same seed, different thread counts: results must match exactly
+        const int threadCounts[] = {1, 2, 4, 7};
+        TerminalDistribution results[4];
+        for (int i = 0; i < 4; ++i) {
+            SharedThreadPool().SetThreadCount(threadCounts[i]);
+            testAlgo.SetRandomSeed(20240501);
+            results[i] = testAlgo.EstimateTerminalDistribution(400.0, 0.12, 0.25);
+        }
+        
+        // A stopped pool runs loops inline and restarts with its thread count
+        SharedThreadPool().SetThreadCount(4);
+        SharedThreadPool().Stop();
+        bool stopped = SharedThreadPool().ThreadCount() == 1;
+        testAlgo.SetRandomSeed(20240501);
+        TerminalDistribution inlineResult = testAlgo.EstimateTerminalDistribution(400.0, 0.12, 0.25);
+        SharedThreadPool().Start();
+        bool restarted = SharedThreadPool().ThreadCount() == 4;
+        SharedThreadPool().SetThreadCount(0);
+        
+        for (int i = 1; i < 4; ++i) {
+            bool identical = results[i].meanPrice == results[0].meanPrice &&
+                             results[i].profitProbability == results[0].profitProbability &&
+                             results[i].lossProbability == results[0].lossProbability;
+            std::cout << threadCounts[i] << " threads vs 1 thread: "
+                      << (identical ? "PASS ✓" : "FAIL ✗") << "\n";
+        }
+        bool inlineIdentical = inlineResult.meanPrice == results[0].meanPrice &&
+                               inlineResult.profitProbability == results[0].profitProbability;
+        std::cout << "Stopped pool runs inline: " << (stopped && inlineIdentical ? "PASS ✓" : "FAIL ✗") << "\n";
+        std::cout << "Start restores the workers: " << (restarted ? "PASS ✓" : "FAIL ✗") << "\n";
+        std::cout << "\n";
+    }
+    
+    void TestVarianceReduction() {
+        std::cout << "Test 9: Variance Reduction\n";
+        std::cout << "--------------------------\n";
+        
+        const double price = 400.0, drift = 0.12, volatility = 0.25;
+        BlackScholesTradeStation testAlgo;
+        testAlgo.SetSimulationEngine(SimulationEngine::Analytic);
+        TerminalDistribution exact = testAlgo.EstimateTerminalDistribution(price, drift, volatility);
+        
+        testAlgo.SetSimulationEngine(SimulationEngine::TerminalSampling);
+        testAlgo.SetMonteCarloSimulations(4000);
+        
+        const VarianceReduction modes[] = {VarianceReduction::None, VarianceReduction::Antithetic,
+                                           VarianceReduction::ControlVariate, VarianceReduction::Sobol};
+        const char* names[] = {"None", "Antithetic", "Control variate", "Sobol"};
+        
+        // Each estimate must land within 4 of its own standard errors of the
+        // exact value, checked over many independent seeds
+        for (int i = 0; i < 4; ++i) {
+            testAlgo.SetVarianceReduction(modes[i]);
+            int outliers = 0;
+            double meanError = 0.0, meanEffectivePaths = 0.0;
+            const int trials = 50;
+            for (int trial = 0; trial < trials; ++trial) {
+                testAlgo.SetRandomSeed(7 + trial);
+                TerminalDistribution d = testAlgo.EstimateTerminalDistribution(price, drift, volatility);
+                double error = d.profitProbability - exact.profitProbability;
+                if (std::abs(error) > 4.0 * d.profitProbabilityStdError + 1e-12) outliers++;
+                if (std::abs(d.lossProbability - exact.lossProbability) > 4.0 * d.lossProbabilityStdError + 1e-12) outliers++;
+                meanError += error * error;
+                meanEffectivePaths += d.effectivePaths;
+            }
+            double rmsError = std::sqrt(meanError / trials);
+            std::cout << names[i] << ": " << (outliers <= 1 ? "PASS ✓" : "FAIL ✗")
+                      << std::setprecision(5) << " (P(profit) RMS error " << rmsError
+                      << std::setprecision(0) << ", effective paths " << meanEffectivePaths / trials
+                      << ")\n" << std::setprecision(3);
+        }
+        testAlgo.SetVarianceReduction(VarianceReduction::None);
+        std::cout << "\n";
+    }
+    
+    void TestInstanceTable() {
+        std::cout << "Test 10: Instance Handle Table\n";
+        std::cout << "------------------------------\n";
+        
+        InstanceTable<BlackScholesTradeStation> table(4);
+        int first = table.Insert(new BlackScholesTradeStation());
+        int second = table.Insert(new BlackScholesTradeStation());
+        
+        // Instances keep separate histories
+        double buySignal, sellSignal, confidence;
+        for (int i = 0; i < 40; ++i) {
+            double price = 100.0 * std::exp(0.01 * i);
+            table.Get(first)->AnalyzeBar(price, price, price, price, 1000, i, buySignal, sellSignal, confidence);
+        }
+        bool independent = table.Get(first)->GetExpectedReturn() != 0.0 &&
+                           table.Get(second)->GetExpectedReturn() == 0.0;
+        std::cout << "Separate instance state: " << (independent ? "PASS ✓" : "FAIL ✗") << "\n";
+        
+        // A destroyed handle stays dead even after its slot is reused
+        table.Erase(first);
+        int reused = 0;
+        for (int i = 0; i < 3; ++i) reused = table.Insert(new BlackScholesTradeStation());
+        bool stale = table.Get(first) == nullptr && !table.Erase(first) && table.Get(reused) != nullptr;
+        bool full = table.Insert(new BlackScholesTradeStation()) == 0;
+        std::cout << "Stale handle rejected: " << (stale ? "PASS ✓" : "FAIL ✗") << "\n";
+        std::cout << "Full table returns 0: " << (full ? "PASS ✓" : "FAIL ✗") << "\n\n";
+    }
+    
+    void TestLoadHistory() {
+        std::cout << "Test 11: Bulk History Warm-Up\n";
+        std::cout << "-----------------------------\n";
+        
+        // The analytic engine is deterministic, so warm-up and bar-by-bar
+        // processing must agree exactly
+        const int signalBars = 10;
+        const int count = static_cast<int>(testPrices.size());
+        BlackScholesTradeStation barByBar, bulk;
+        barByBar.SetSimulationEngine(SimulationEngine::Analytic);
+        bulk.SetSimulationEngine(SimulationEngine::Analytic);
+        
+        std::vector<int> expectedActions;
+        std::vector<double> expectedConfidence;
+        for (int i = 0; i < count; ++i) {
+            double price = testPrices[i];
+            double buySignal, sellSignal, confidence;
+            int action = barByBar.AnalyzeBar(price, price, price, price, 0.0, i + 1,
+                                             buySignal, sellSignal, confidence);
+            if (i >= count - signalBars) {
+                expectedActions.push_back(action);
+                expectedConfidence.push_back(confidence);
+            }
+        }
+        
+        std::vector<int> actions(signalBars);
+        std::vector<double> buySignals(signalBars), sellSignals(signalBars), confidences(signalBars);
+        int loaded = bulk.LoadHistory(testPrices.data(), count, signalBars, actions.data(),
+                                      buySignals.data(), sellSignals.data(), confidences.data());
+        
+        bool sameState = loaded == count && bulk.GetVolatility() == barByBar.GetVolatility() &&
+                         bulk.GetExpectedReturn() == barByBar.GetExpectedReturn();
+        bool sameSignals = actions == expectedActions && confidences == expectedConfidence;
+        std::cout << "Warm-up state matches bar-by-bar: " << (sameState ? "PASS ✓" : "FAIL ✗") << "\n";
+        std::cout << "Last " << signalBars << " signals match: " << (sameSignals ? "PASS ✓" : "FAIL ✗") << "\n\n";
+    }
+    
+    void TestOptionChainPricer() {
+        std::cout << "Test 12: Option Chain Pricer\n";
+        std::cout << "----------------------------\n";
+        
+        // 5 expiries x 41 strikes, with a tail that does not fill a vector
+        std::vector<double> strikes, expiries;
+        for (int e = 1; e <= 5; ++e) {
+            for (int k = 0; k < 41; ++k) {
+                strikes.push_back(300.0 + 5.0 * k);
+                expiries.push_back(e * 0.125);
+            }
+        }
+        const size_t count = strikes.size();
+        simd::OptionChainMarket market;
+        market.spot = 400.0;
+        market.rate = 0.03;
+        market.volatility = 0.25;
+        
+        auto cdf = [](double x) { return 0.5 * std::erfc(-x / std::sqrt(2.0)); };
+        const SimdLevel levels[] = {SimdLevel::Scalar, SimdLevel::Avx2, SimdLevel::Avx512};
+        const char* names[] = {"Scalar", "AVX2", "AVX-512"};
+        for (int level = 0; level < 3; ++level) {
+            if (static_cast<int>(levels[level]) > static_cast<int>(DetectSimdLevel())) continue;
+            
+            std::vector<double> call(count), put(count), callDelta(count), gamma(count), vega(count), callTheta(count);
+            simd::OptionChainOutputs outputs;
+            outputs.callPrice = call.data();
+            outputs.putPrice = put.data();
+            outputs.callDelta = callDelta.data();
+            outputs.gamma = gamma.data();
+            outputs.vega = vega.data();
+            outputs.callTheta = callTheta.data();
+            simd::PriceOptionChain(levels[level], market, strikes.data(), expiries.data(), count, outputs);
+            
+            double maxPriceError = 0.0, maxGreekError = 0.0;
+            for (size_t i = 0; i < count; ++i) {
+                double S = market.spot, K = strikes[i], T = expiries[i], r = market.rate, v = market.volatility;
+                double d1 = (std::log(S / K) + (r + 0.5 * v * v) * T) / (v * std::sqrt(T));
+                double d2 = d1 - v * std::sqrt(T);
+                double density = std::exp(-0.5 * d1 * d1) / std::sqrt(2.0 * 3.14159265358979323846);
+                double expectedCall = S * cdf(d1) - K * std::exp(-r * T) * cdf(d2);
+                double expectedPut = K * std::exp(-r * T) * cdf(-d2) - S * cdf(-d1);
+                double expectedTheta = -S * density * v / (2.0 * std::sqrt(T)) - r * K * std::exp(-r * T) * cdf(d2);
+                
+                maxPriceError = std::max({maxPriceError, std::abs(call[i] - expectedCall),
+                                          std::abs(put[i] - expectedPut)});
+                maxGreekError = std::max({maxGreekError, std::abs(callDelta[i] - cdf(d1)),
+                                          std::abs(gamma[i] - density / (S * v * std::sqrt(T))),
+                                          std::abs(vega[i] - S * density * std::sqrt(T)) / S,
+                                          std::abs(callTheta[i] - expectedTheta) / S});
+            }
+            bool pass = maxPriceError < 1e-10 && maxGreekError < 1e-12;
+            std::cout << names[level] << " prices and Greeks: " << (pass ? "PASS ✓" : "FAIL ✗")
+                      << std::scientific << std::setprecision(2) << " (price error " << maxPriceError
+                      << ", Greek error " << maxGreekError << ")\n" << std::fixed;
+        }
+        
+        // Zero volatility is the sigma -> 0+ limit: intrinsic value against
+        // the discounted strike while the contract is live
+        const double flatStrikes[] = {80.0, 90.0, 100.0, 110.0, 120.0, 90.0};
+        const double flatExpiries[] = {1.0, 1.0, 1.0, 1.0, 1.0, 0.0};
+        double flat[6][6], tiny[6][6];
+        for (int run = 0; run < 2; ++run) {
+            simd::OptionChainMarket flatMarket;
+            flatMarket.spot = 100.0;
+            flatMarket.rate = 0.05;
+            flatMarket.volatility = run == 0 ? 0.0 : 1e-9;
+            double (*values)[6] = run == 0 ? flat : tiny;
+            simd::OptionChainOutputs outputs;
+            outputs.callPrice = values[0];
+            outputs.putPrice = values[1];
+            outputs.callDelta = values[2];
+            outputs.putDelta = values[3];
+            outputs.callTheta = values[4];
+            outputs.putTheta = values[5];
+            simd::PriceOptionChain(SimdLevel::Scalar, flatMarket, flatStrikes, flatExpiries, 6, outputs);
+        }
+        double limitError = 0.0;
+        for (int output = 0; output < 6; ++output) {
+            for (int i = 0; i < 5; ++i) limitError = std::max(limitError, std::abs(flat[output][i] - tiny[output][i]));
+        }
+        bool flatPass = limitError < 1e-6 && std::abs(flat[0][1] - (100.0 - 90.0 * std::exp(-0.05))) < 1e-12 &&
+                        flat[0][5] == 10.0 && flat[4][5] == 0.0;
+        std::cout << "Zero volatility vs sigma -> 0+: " << (flatPass ? "PASS ✓" : "FAIL ✗")
+                  << " (K=90 call " << flat[0][1] << ", expired " << flat[0][5] << ")\n";
+        std::cout << "\n";
+    }
+    
+    void TestNormalCdfTiers() {
+        std::cout << "Test 13: Normal CDF Accuracy Tiers\n";
+        std::cout << "----------------------------------\n";
+        
+        // Both tails, the origin, and an odd count so the last vector is partial
+        std::vector<double> x;
+        for (double v = -40.0; v <= 40.0; v += 0.013) x.push_back(v);
+        x.push_back(0.0);
+        std::vector<double> expected(x.size());
+        for (size_t i = 0; i < x.size(); ++i) expected[i] = 0.5 * std::erfc(-x[i] / std::sqrt(2.0));
+        
+        auto maxError = [&](const std::vector<double>& values) {
+            double error = 0.0;
+            for (size_t i = 0; i < values.size(); ++i) error = std::max(error, std::abs(values[i] - expected[i]));
+            return error;
+        };
+        
+        const char* tierNames[] = {"Libm", "Rational", "Fast"};
+        const double bounds[] = {1e-15, 1e-14, 7.5e-8};
+        const SimdLevel levels[] = {SimdLevel::Scalar, SimdLevel::Avx2, SimdLevel::Avx512};
+        for (int tier = 0; tier < 3; ++tier) {
+            // Scalar entry point, then every supported ISA through the batch path
+            std::vector<double> values(x.size());
+            for (size_t i = 0; i < x.size(); ++i) {
+                values[i] = tier == 0 ? NormalCDF<CdfAccuracy::Libm>(x[i])
+                          : tier == 1 ? NormalCDF<CdfAccuracy::Rational>(x[i])
+                                      : NormalCDF<CdfAccuracy::Fast>(x[i]);
+            }
+            double error = maxError(values);
+            for (int level = 0; level < 3; ++level) {
+                if (static_cast<int>(levels[level]) > static_cast<int>(DetectSimdLevel())) continue;
+                if (tier == 0) simd::NormalCdf<CdfAccuracy::Libm>(levels[level], x.data(), x.size(), values.data());
+                if (tier == 1) simd::NormalCdf<CdfAccuracy::Rational>(levels[level], x.data(), x.size(), values.data());
+                if (tier == 2) simd::NormalCdf<CdfAccuracy::Fast>(levels[level], x.data(), x.size(), values.data());
+                error = std::max(error, maxError(values));
+            }
+            std::cout << tierNames[tier] << " tier vs erfc: " << (error < bounds[tier] ? "PASS ✓" : "FAIL ✗")
+                      << std::scientific << std::setprecision(2) << " (max error " << error << ")\n" << std::fixed;
+        }
+        
+        // The fast tier keeps chain prices within a fraction of a cent
+        std::vector<double> strikes, expiries;
+        for (int k = 0; k < 41; ++k) {
+            strikes.push_back(300.0 + 5.0 * k);
+            expiries.push_back(0.5);
+        }
+        simd::OptionChainMarket market;
+        market.spot = 400.0;
+        market.rate = 0.03;
+        market.volatility = 0.25;
+        std::vector<double> reference(strikes.size()), fast(strikes.size());
+        simd::OptionChainOutputs outputs;
+        outputs.callPrice = reference.data();
+        simd::PriceOptionChain<CdfAccuracy::Rational>(market, strikes.data(), expiries.data(), strikes.size(), outputs);
+        outputs.callPrice = fast.data();
+        simd::PriceOptionChain<CdfAccuracy::Fast>(market, strikes.data(), expiries.data(), strikes.size(), outputs);
+        double priceError = 0.0;
+        for (size_t i = 0; i < strikes.size(); ++i) priceError = std::max(priceError, std::abs(fast[i] - reference[i]));
+        std::cout << "Fast tier chain prices: " << (priceError < 1e-3 ? "PASS ✓" : "FAIL ✗")
+                  << std::scientific << std::setprecision(2) << " (max error " << priceError << ")\n" << std::fixed;
+        std::cout << "\n";
+    }
+    
+    void TestImpliedVolatility() {
+        std::cout << "Test 14: Implied Volatility Solver\n";
+        std::cout << "----------------------------------\n";
+        
+        // A smile over 4 expiries x 31 strikes, alternating calls and puts
+        std::vector<double> strikes, expiries, sigmas;
+        std::vector<int> isCall;
+        for (int e = 1; e <= 4; ++e) {
+            for (int k = 0; k < 31; ++k) {
+                strikes.push_back(340.0 + 4.0 * k);
+                expiries.push_back(e * 0.25);
+                sigmas.push_back(0.2 + 0.0004 * (k - 15) * (k - 15));
+                isCall.push_back(k % 2);
+            }
+        }
+        const size_t count = strikes.size();
+        auto quote = [&](double spot, double scale, std::vector<double>& prices) {
+            for (size_t i = 0; i < count; ++i) {
+                simd::OptionChainMarket market;
+                market.spot = spot;
+                market.rate = 0.03;
+                market.volatility = sigmas[i] * scale;
+                double call, put;
+                simd::OptionChainOutputs outputs;
+                outputs.callPrice = &call;
+                outputs.putPrice = &put;
+                simd::PriceOptionChain(SimdLevel::Scalar, market, &strikes[i], &expiries[i], 1, outputs);
+                prices[i] = isCall[i] ? call : put;
+            }
+        };
+        std::vector<double> prices(count), volatilities(count);
+        std::vector<int> iterations(count);
+        quote(400.0, 1.0, prices);
+        
+        const SimdLevel levels[] = {SimdLevel::Scalar, SimdLevel::Avx2, SimdLevel::Avx512};
+        const char* names[] = {"Scalar", "AVX2", "AVX-512"};
+        simd::ImpliedVolMarket market;
+        market.spot = 400.0;
+        market.rate = 0.03;
+        for (int level = 0; level < 3; ++level) {
+            if (static_cast<int>(levels[level]) > static_cast<int>(DetectSimdLevel())) continue;
+            int solved = simd::SolveImpliedVolatility(levels[level], market, strikes.data(), expiries.data(),
+                                                      prices.data(), isCall.data(), nullptr, count,
+                                                      volatilities.data(), iterations.data());
+            double maxError = 0.0;
+            for (size_t i = 0; i < count; ++i) maxError = std::max(maxError, std::abs(volatilities[i] - sigmas[i]));
+            bool pass = solved == static_cast<int>(count) && maxError < 1e-9;
+            std::cout << names[level] << " prices to volatilities: " << (pass ? "PASS ✓" : "FAIL ✗")
+                      << std::scientific << std::setprecision(2) << " (max error " << maxError << ")\n" << std::fixed;
+        }
+        
+        // The next bar moves spot and vols slightly; cached solutions are
+        // one or two Halley steps from the new ones
+        BlackScholesTradeStation solver;
+        solver.SetRiskFreeRate(0.03);
+        solver.ImpliedVolatilityChain(400.0, strikes.data(), expiries.data(), prices.data(), isCall.data(),
+                                    count, volatilities.data());
+        quote(401.0, 1.01, prices);
+        int solved = solver.ImpliedVolatilityChain(401.0, strikes.data(), expiries.data(), prices.data(),
+                                                   isCall.data(), count, volatilities.data(), iterations.data());
+        double maxError = 0.0;
+        int maxIterations = 0;
+        for (size_t i = 0; i < count; ++i) {
+            maxError = std::max(maxError, std::abs(volatilities[i] - 1.01 * sigmas[i]));
+            maxIterations = std::max(maxIterations, iterations[i]);
+        }
+        bool pass = solved == static_cast<int>(count) && maxError < 1e-9 && maxIterations <= 2;
+        std::cout << "Warm start: " << (pass ? "PASS ✓" : "FAIL ✗") << " (max " << maxIterations
+                  << " iterations per contract)\n";
+        
+        // Below intrinsic, above the spot, expired
+        double badStrikes[] = {350.0, 400.0, 400.0};
+        double badExpiries[] = {0.5, 0.5, 0.0};
+        double badPrices[] = {40.0, 450.0, 5.0};
+        int badCalls[] = {1, 1, 0};
+        double badVolatilities[3];
+        solved = simd::SolveImpliedVolatility(market, badStrikes, badExpiries, badPrices, badCalls, nullptr, 3,
+                                              badVolatilities);
+        pass = solved == 0 && std::isnan(badVolatilities[0]) && std::isnan(badVolatilities[1]) &&
+               std::isnan(badVolatilities[2]);
+        std::cout << "Arbitrage-violating quotes rejected: " << (pass ? "PASS ✓" : "FAIL ✗") << "\n";
+
+        // A wing quote too small for the price to resolve to tolerance: the
+        // solver stalls, and the stalled iterate is neither reported nor cached
+        double wingStrike = 40000.0, wingExpiry = 0.01, wingPrice = 1e-300, wingVolatility;
+        int wingCall = 1, wingIterations;
+        ImpliedVolatilitySolver wingSolver;
+        solved = wingSolver.Solve(market, &wingStrike, &wingExpiry, &wingPrice, &wingCall, 1, &wingVolatility,
+                                  &wingIterations);
+        pass = solved == 0 && std::isnan(wingVolatility) && wingSolver.CacheSize() == 0;
+        std::cout << "Unconverged quote left NaN and uncached: " << (pass ? "PASS ✓" : "FAIL ✗")
+                  << " (" << wingIterations << " iterations)\n";
+        std::cout << "\n";
+    }
+    
+    void TestWalkForwardSweep() {
+        std::cout << "Test 15: Walk-Forward Parameter Sweep\n";
+        std::cout << "-------------------------------------\n";
+        
+        std::mt19937 gen(7);
+        std::normal_distribution<> dailyReturn(0.0004, 0.02);
+        std::vector<double> closes = {400.0};
+        for (int i = 1; i < 900; ++i) closes.push_back(closes.back() * std::exp(dailyReturn(gen)));
+        
+        ParameterGrid grid;
+        grid.stopLossPercents = {0.03, 0.05};
+        grid.takeProfitPercents = {0.10, 0.15};
+        grid.lookbackPeriods = {60, 126};
+        std::vector<SweepParameters> combinations = grid.Combinations();
+        WalkForwardSchedule schedule;
+        schedule.trainBars = 300;
+        schedule.testBars = 100;
+        schedule.stepBars = 100;
+        
+        ThreadPool serial(1), parallel(4);
+        BarSeries bars = BarSeries::FromCloses(closes.data(), closes.size());
+        auto reports = RunWalkForward(bars, combinations, schedule, BlackScholesTradeStation::EvaluateParameters,
+                                      serial);
+        auto parallelReports = RunWalkForward(bars, combinations, schedule,
+                                              BlackScholesTradeStation::EvaluateParameters, parallel);
+        
+        bool windowsOk = reports.size() == 6 && combinations.size() == 8;
+        bool rankedOk = true, identical = parallelReports.size() == reports.size();
+        bool outOfSampleOk = true;
+        int trades = 0;
+        for (size_t w = 0; w < reports.size(); ++w) {
+            const WalkForwardReport& report = reports[w];
+            windowsOk = windowsOk && report.window.trainBegin == 100 * w && report.window.testBegin == report.window.trainEnd;
+            for (size_t i = 0; i < report.ranked.size(); ++i) {
+                const BacktestMetrics& m = report.ranked[i].metrics;
+                trades += m.trades;
+                if (i > 0 && m.sharpeRatio > report.ranked[i - 1].metrics.sharpeRatio) rankedOk = false;
+                if (identical) {
+                    const SweepResult& other = parallelReports[w].ranked[i];
+                    identical = other.metrics.sharpeRatio == m.sharpeRatio && other.metrics.totalReturn == m.totalReturn &&
+                                other.parameters.stopLossPercent == report.ranked[i].parameters.stopLossPercent;
+                }
+            }
+            BacktestMetrics direct = BlackScholesTradeStation::EvaluateParameters(
+                report.ranked.front().parameters, bars, report.window.testBegin, report.window.testEnd);
+            outOfSampleOk = outOfSampleOk && direct.totalReturn == report.outOfSample.totalReturn;
+        }
+        
+        std::cout << "Windows and combinations: " << (windowsOk ? "PASS ✓" : "FAIL ✗") << " (" << reports.size()
+                  << " windows x " << combinations.size() << " combinations)\n";
+        std::cout << "Ranked by Sharpe: " << (rankedOk && trades > 0 ? "PASS ✓" : "FAIL ✗") << " (" << trades
+                  << " training trades)\n";
+        serial.Stop();
+        parallel.Stop();
+        std::cout << "4 threads vs 1 thread: " << (identical ? "PASS ✓" : "FAIL ✗") << "\n";
+        std::cout << "Out-of-sample uses the window winner: " << (outOfSampleOk ? "PASS ✓" : "FAIL ✗") << "\n";
+        if (!reports.empty()) WriteRankedTable(std::cout, reports.front().ranked, 3);
+        std::cout << "\n";
+    }
+    
+    // Scripted signals for checking the backtester's order handling
+    struct ScriptedStrategy {
+        std::vector<int> actions;
+        std::vector<double> confidences;
+        double entryPrice = 0.0;
+        int quantity = 0;
+        double lastClose = 0.0;
+        
+        int AnalyzeBar(double, double, double, double close, double, int barNumber,
+                       double& buySignal, double& sellSignal, double& confidence) {
+            lastClose = close;
+            int action = actions[barNumber - 1];
+            buySignal = action == 1 ? 0.5 : 0.0;
+            sellSignal = action == -1 ? 0.5 : 0.0;
+            confidence = confidences[barNumber - 1];
+            return action;
+        }
+        void SetPosition(double entry, int shares) {
+            entryPrice = entry;
+            quantity = shares;
+        }
+        bool ShouldClosePosition() const {
+            return quantity != 0 && (lastClose - entryPrice) * quantity >= 0.1 * entryPrice * std::abs(quantity);
+        }
+    };
+    
+    void TestBacktester() {
+        std::cout << "Test 16: Backtester\n";
+        std::cout << "-------------------\n";
+        
+        // Opens sit 1 below closes; prices climb 2 per bar
+        std::vector<double> open, close;
+        for (int i = 0; i < 20; ++i) {
+            close.push_back(100.0 + 2.0 * i);
+            open.push_back(close.back() - 1.0);
+        }
+        BarSeries bars;
+        bars.open = open.data();
+        bars.high = close.data();
+        bars.low = open.data();
+        bars.close = close.data();
+        bars.count = close.size();
+        
+        // A low-confidence buy on bar 2 is ignored; the buy on bar 4 fills at
+        // bar 5's open and exits at the open after the 10% target is reached
+        ScriptedStrategy scripted;
+        scripted.actions.assign(20, 0);
+        scripted.confidences.assign(20, 0.6);
+        scripted.actions[2] = 1;
+        scripted.confidences[2] = 0.4;
+        scripted.actions[4] = 1;
+        BacktestReport report = RunBacktest(scripted, bars, BacktestSettings());
+        
+        int expectedShares = static_cast<int>(100000.0 * 0.1 / close[4]);
+        bool pass = report.trades.size() == 1 && report.trades[0].entryBar == 5 && report.trades[0].exitBar == 11 &&
+                    report.trades[0].shares == expectedShares && report.trades[0].entryPrice == open[5] &&
+                    report.trades[0].exitPrice == open[11];
+        std::cout << "ELD entry gates, sizing and next-bar fills: " << (pass ? "PASS ✓" : "FAIL ✗") << "\n";
+        
+        double profit = expectedShares * (open[11] - open[5]);
+        pass = report.equity.size() == 20 && std::abs(report.equity.back() - 100000.0 - profit) < 1e-6 &&
+               std::abs(report.metrics.totalReturn - profit / 100000.0) < 1e-12 && report.metrics.winRate == 1.0;
+        std::cout << "Equity curve and metrics: " << (pass ? "PASS ✓" : "FAIL ✗") << "\n";
+        
+        // Shorts stop out on a rise, not on a fall
+        BlackScholesTradeStation shortAlgo;
+        for (int i = 0; i < 35; ++i) {
+            double buySignal, sellSignal, confidence;
+            shortAlgo.AnalyzeBar(400.0, 401.0, 399.0, 400.0, 0.0, i + 1, buySignal, sellSignal, confidence);
+        }
+        shortAlgo.SetPosition(400.0, -100);
+        double buySignal, sellSignal, confidence;
+        shortAlgo.AnalyzeBar(380.0, 381.0, 379.0, 380.0, 0.0, 36, buySignal, sellSignal, confidence);
+        bool holdsOnGain = !shortAlgo.ShouldClosePosition();
+        shortAlgo.AnalyzeBar(420.0, 421.0, 419.0, 420.0, 0.0, 37, buySignal, sellSignal, confidence);
+        std::cout << "Short stop loss: " << (holdsOnGain && shortAlgo.ShouldClosePosition() ? "PASS ✓" : "FAIL ✗")
+                  << "\n";
+        
+        // Ten years of daily bars through the full algorithm
+        std::mt19937 gen(11);
+        std::normal_distribution<> dailyReturn(0.0004, 0.02);
+        std::vector<double> closes = {400.0};
+        for (int i = 1; i < 2520; ++i) closes.push_back(closes.back() * std::exp(dailyReturn(gen)));
+        BlackScholesTradeStation algo;
+        algo.SetRandomSeed(11);
+        auto start = std::chrono::steady_clock::now();
+        report = RunBacktest(algo, BarSeries::FromCloses(closes.data(), closes.size()), BacktestSettings());
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double closed = 0.0;
+        for (const BacktestTrade& trade : report.trades) closed += trade.profit;
+        pass = report.equity.size() == closes.size() && !report.trades.empty() &&
+               std::abs(report.equity.back() - 100000.0 - closed) < 1e-6;
+        std::cout << "Full algorithm replay: " << (pass ? "PASS ✓" : "FAIL ✗") << " (" << report.trades.size()
+                  << " trades, " << std::setprecision(0) << closes.size() / seconds << " bars/s)\n"
+                  << std::setprecision(3);
+        std::cout << "\n";
+    }
+    
+    void TestBarFile() {
+        std::cout << "Test 17: Bar Files\n";
+        std::cout << "------------------\n";
+        
+        // A minute-bar export, written out of order with one repeated bar
+        std::mt19937 gen(17);
+        std::normal_distribution<> minuteReturn(0.0, 0.001);
+        BarColumns expected;
+        double price = 250.0;
+        for (int i = 0; i < 600; ++i) {
+            int minutes = 9 * 60 + 30 + i % 390;
+            int day = 3 + i / 390;
+            double open = price;
+            price *= std::exp(minuteReturn(gen));
+            expected.timestamps.push_back(202401000000LL + day * 10000LL + minutes / 60 * 100 + minutes % 60);
+            expected.open.push_back(open);
+            expected.high.push_back(std::max(open, price) + 0.05);
+            expected.low.push_back(std::min(open, price) - 0.05);
+            expected.close.push_back(price);
+            expected.volume.push_back(1000.0 + i);
+        }
+        {
+            std::ofstream csv("test_bars.csv");
+            csv << "\"Date\",\"Time\",\"Open\",\"High\",\"Low\",\"Close\",\"Vol\",\"OI\"\n";
+            csv << std::setprecision(17);
+            auto writeRow = [&](size_t i, double close) {
+                long long t = expected.timestamps[i];
+                csv << "01/" << std::setw(2) << std::setfill('0') << t / 10000 % 100 << "/2024,"
+                    << std::setw(2) << t / 100 % 100 << ":" << std::setw(2) << t % 100 << std::setfill(' ') << ","
+                    << expected.open[i] << "," << expected.high[i] << "," << expected.low[i] << ","
+                    << close << "," << expected.volume[i] << ",0\n";
+            };
+            writeRow(10, -1.0);   // Replaced by the later copy of bar 10
+            for (size_t i = 300; i < 600; ++i) writeRow(i, expected.close[i]);
+            for (size_t i = 0; i < 300; ++i) writeRow(i, expected.close[i]);
+        }
+        
+        BarColumns parsed;
+        bool pass = ReadTradeStationCsv("test_bars.csv", parsed) && parsed.Size() == expected.Size() &&
+                    parsed.timestamps == expected.timestamps && parsed.close == expected.close &&
+                    parsed.open == expected.open && parsed.volume == expected.volume;
+        std::cout << "TradeStation CSV import: " << (pass ? "PASS ✓" : "FAIL ✗") << "\n";
+        
+        BarFile file;
+        pass = WriteBarFile("test_bars.bars", parsed) && file.Open("test_bars.bars") && file.Count() == 600;
+        BarSeries mapped = file.Bars();
+        for (const double* column : {mapped.open, mapped.high, mapped.low, mapped.close, mapped.volume}) {
+            pass = pass && reinterpret_cast<std::uintptr_t>(column) % kBarFileAlignment == 0;
+        }
+        pass = pass && std::equal(expected.close.begin(), expected.close.end(), mapped.close) &&
+               std::equal(expected.high.begin(), expected.high.end(), mapped.high) &&
+               file.LowerBound(202401040930LL) == 390 && file.LowerBound(202401031600LL) == 390 &&
+               file.LowerBound(0) == 0 && file.LowerBound(209901010000LL) == 600;
+        std::cout << "Aligned mapped columns and time index: " << (pass ? "PASS ✓" : "FAIL ✗") << "\n";
+        
+        // The mapped view replays exactly like the in-memory columns
+        BlackScholesTradeStation fromMemory, fromFile;
+        fromMemory.SetRandomSeed(17);
+        fromFile.SetRandomSeed(17);
+        fromMemory.LoadHistory(expected.close.data(), 100);
+        fromFile.LoadHistory(mapped.close, 100);
+        BacktestReport memoryReport = RunBacktest(fromMemory, expected.Series(), BacktestSettings(), 100);
+        BacktestReport fileReport = RunBacktest(fromFile, mapped, BacktestSettings(), 100);
+        pass = memoryReport.equity == fileReport.equity && memoryReport.trades.size() == fileReport.trades.size();
+        std::cout << "Zero-copy LoadHistory and backtest: " << (pass ? "PASS ✓" : "FAIL ✗") << "\n";
+        
+        // A truncated file is rejected
+        file.Close();
+        {
+            std::ifstream in("test_bars.bars", std::ios::binary);
+            std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            std::ofstream out("test_bars_truncated.bars", std::ios::binary);
+            out.write(bytes.data(), bytes.size() / 2);
+        }
+        BarFile truncated;
+        pass = !truncated.Open("test_bars_truncated.bars") && !truncated.IsOpen() &&
+               !truncated.Open("test_bars.csv") && !truncated.Open("missing.bars");
+        std::cout << "Invalid files rejected: " << (pass ? "PASS ✓" : "FAIL ✗") << "\n";
+        std::remove("test_bars.csv");
+        std::remove("test_bars.bars");
+        std::remove("test_bars_truncated.bars");
+        std::cout << "\n";
+    }
+    
+    void TestPerfStats() {
+        std::cout << "Test 18: Latency Instrumentation\n";
+        std::cout << "--------------------------------\n";
+        
+        // 1..100000 ns: percentiles within a sixteenth, exact count/mean/max
+        LatencyHistogram histogram;
+        for (std::uint64_t ns = 1; ns <= 100000; ++ns) histogram.Record(ns);
+        double worst = 0.0;
+        for (double q : {0.1, 0.5, 0.9, 0.99}) {
+            double expected = 1.0 + q * 99999.0;
+            worst = std::max(worst, std::abs(histogram.PercentileNanoseconds(q) / expected - 1.0));
+        }
+        bool pass = histogram.Count() == 100000 && histogram.MeanNanoseconds() == 50000.5 &&
+                    histogram.MaxNanoseconds() == 100000.0 && worst <= 1.0 / 16.0;
+        std::cout << "Histogram percentiles: " << (pass ? "PASS ✓" : "FAIL ✗") << " (max relative error "
+                  << std::setprecision(3) << worst << ")\n";
+        
+        // Concurrent writers lose no samples
+        histogram.Reset();
+        std::vector<std::thread> writers;
+        for (int t = 0; t < 4; ++t) {
+            writers.emplace_back([&histogram, t]() {
+                for (int i = 0; i < 25000; ++i) histogram.Record(100 * (t + 1));
+            });
+        }
+        for (std::thread& writer : writers) writer.join();
+        pass = histogram.Count() == 100000 && histogram.MaxNanoseconds() == 400.0 &&
+               histogram.PercentileNanoseconds(0.0) <= 100.0 * 17 / 16;
+        std::cout << "Lock-free concurrent recording: " << (pass ? "PASS ✓" : "FAIL ✗") << "\n";
+        
+        BlackScholesTradeStation instrumented;
+        instrumented.SetRandomSeed(18);
+        for (int i = 0; i < 60; ++i) {
+            double price = 400.0 + 5.0 * std::sin(0.3 * i);
+            double buySignal, sellSignal, confidence;
+            instrumented.AnalyzeBar(price, price + 1, price - 1, price, 1e6, i + 1,
+                                    buySignal, sellSignal, confidence);
+        }
+        double stats[kPerfStageCount * kPerfStatFieldCount];
+        int stages = instrumented.GetPerfStats(stats, kPerfStageCount * kPerfStatFieldCount);
+#if BSTS_PERF_STATS
+        const double* bar = stats + static_cast<int>(PerfStage::Bar) * kPerfStatFieldCount;
+        const double* simulation = stats + static_cast<int>(PerfStage::Simulation) * kPerfStatFieldCount;
+        pass = stages == kPerfStageCount && bar[kPerfCount] == 60 && simulation[kPerfCount] == 31 &&
+               stats[kPerfCount] == 60 && bar[kPerfMean] * 60 >= simulation[kPerfMean] * 31 &&
+               bar[kPerfP50] <= bar[kPerfP99] && bar[kPerfP99] <= bar[kPerfMax] * 17 / 16;
+        double barMedian = bar[kPerfP50];
+        instrumented.ResetPerfStats();
+        pass = pass && instrumented.GetPerfStats(stats, kPerfStageCount * kPerfStatFieldCount) == kPerfStageCount &&
+               stats[kPerfCount] == 0;
+        std::cout << "AnalyzeBar stage spans: " << (pass ? "PASS ✓" : "FAIL ✗") << " (bar p50 "
+                  << std::setprecision(1) << barMedian << " us)\n" << std::setprecision(3);
+#else
+        std::cout << "Compiled out without BSTS_PERF_STATS: " << (stages == 0 ? "PASS ✓" : "FAIL ✗") << "\n";
+#endif
+        std::cout << "\n";
+    }
+    
+    void TestSteadyStateAllocations() {
+        std::cout << "Test 19: Steady-State Allocations\n";
+        std::cout << "---------------------------------\n";
+        
+        auto countAllocations = [](BlackScholesTradeStation& instance, int firstBar, int bars) {
+            std::uint64_t start = ThreadAllocationCount();
+            for (int i = firstBar; i < firstBar + bars; ++i) {
+                double price = 400.0 * std::exp(0.01 * std::sin(0.2 * i));
+                double buySignal, sellSignal, confidence;
+                instance.AnalyzeBar(price, price, price, price, 1e6, i + 1, buySignal, sellSignal, confidence);
+            }
+            return ThreadAllocationCount() - start;
+        };
+        
+        // Every engine and variance reduction mode: after the first signal
+        // bar, bars allocate nothing, even when the path count changes
+        std::uint64_t warm = 0;
+        for (SimulationEngine engine : {SimulationEngine::PathStepping, SimulationEngine::TerminalSampling,
+                                        SimulationEngine::Analytic}) {
+            for (VarianceReduction mode : {VarianceReduction::None, VarianceReduction::Antithetic,
+                                           VarianceReduction::ControlVariate, VarianceReduction::Sobol}) {
+                BlackScholesTradeStation instance;
+                instance.SetRandomSeed(19);
+                instance.SetSimulationEngine(engine);
+                instance.SetVarianceReduction(mode);
+                countAllocations(instance, 0, 31);
+                warm += countAllocations(instance, 31, 20);
+                instance.SetMonteCarloSimulations(5000);
+                warm += countAllocations(instance, 51, 5);
+                instance.SetMonteCarloSimulations(700);
+                warm += countAllocations(instance, 56, 5);
+            }
+        }
+#if BSTS_CHECK_ALLOCATIONS
+        std::cout << "Warm AnalyzeBar heap allocations: " << (warm == 0 ? "PASS ✓" : "FAIL ✗") << " (" << warm
+                  << " in 360 bars)\n";
+#else
+        std::cout << "Warm AnalyzeBar heap allocations: not counted (built without BSTS_CHECK_ALLOCATIONS)\n";
+#endif
+        std::cout << "\n";
+    }
+    
+    void TestUpdateTick() {
+        std::cout << "Test 20: Intrabar Tick Updates\n";
+        std::cout << "------------------------------\n";
+        
+        std::mt19937 gen(20);
+        std::normal_distribution<> dailyReturn(0.0005, 0.015);
+        std::vector<double> closes = {400.0};
+        while (closes.size() < 302) closes.push_back(closes.back() * std::exp(dailyReturn(gen)));
+        
+        // A tick evaluates the forming bar exactly as a close would, without
+        // moving the windows; ticks within the epsilon reuse that evaluation
+        // and draw no simulation stream, so the next close is unaffected
+        bool provisional = true, windowsKept = true, reused = true;
+        for (SimulationEngine engine : {SimulationEngine::TerminalSampling, SimulationEngine::Analytic}) {
+            BlackScholesTradeStation ticked, closed;
+            for (BlackScholesTradeStation* instance : {&ticked, &closed}) {
+                instance->SetRandomSeed(20);
+                instance->SetSimulationEngine(engine);
+                instance->LoadHistory(closes.data(), 300);
+            }
+            double volatility = ticked.GetVolatility();
+            double tickBuy, tickSell, tickConfidence, barBuy, barSell, barConfidence;
+            int tickAction = ticked.UpdateTick(closes[300], tickBuy, tickSell, tickConfidence);
+            int barAction = closed.AnalyzeBar(closes[300], closes[300], closes[300], closes[300], 0.0, 301,
+                                              barBuy, barSell, barConfidence);
+            provisional = provisional && tickAction == barAction && tickBuy == barBuy && tickSell == barSell &&
+                          tickConfidence == barConfidence;
+            windowsKept = windowsKept && ticked.GetVolatility() == volatility;
+            
+            ticked.UpdateTick(closes[300] * 1.0004, tickBuy, tickSell, tickConfidence);
+            ticked.AnalyzeBar(closes[300], closes[300], closes[300], closes[300], 0.0, 301,
+                              tickBuy, tickSell, tickConfidence);
+            tickAction = ticked.AnalyzeBar(closes[301], closes[301], closes[301], closes[301], 0.0, 302,
+                                           tickBuy, tickSell, tickConfidence);
+            barAction = closed.AnalyzeBar(closes[301], closes[301], closes[301], closes[301], 0.0, 302,
+                                          barBuy, barSell, barConfidence);
+            reused = reused && tickAction == barAction && tickBuy == barBuy && tickConfidence == barConfidence;
+        }
+        std::cout << "Tick matches a close at the same price: " << (provisional ? "PASS ✓" : "FAIL ✗") << "\n";
+        std::cout << "Windows untouched until the bar closes: " << (windowsKept ? "PASS ✓" : "FAIL ✗") << "\n";
+        std::cout << "Ticks within epsilon reuse the simulation: " << (reused ? "PASS ✓" : "FAIL ✗") << "\n";
+        
+        // Tick-rate cost once the distribution is cached
+        BlackScholesTradeStation live;
+        live.SetRandomSeed(20);
+        live.LoadHistory(closes.data(), 300, 1);
+        const int ticks = 100000;
+        double buySignal, sellSignal, confidence;
+        std::uint64_t allocations = ThreadAllocationCount();
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < ticks; ++i) {
+            live.UpdateTick(closes[299] * (1.0 + 0.0004 * std::sin(0.01 * i)), buySignal, sellSignal, confidence);
+        }
+        double nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        allocations = ThreadAllocationCount() - allocations;
+        std::cout << "Cached tick latency: " << (nanoseconds / ticks < 5000.0 && allocations == 0 ? "PASS ✓" : "FAIL ✗")
+                  << std::fixed << std::setprecision(0) << " (" << nanoseconds / ticks << " ns per tick, "
+                  << allocations << " allocations)\n\n";
+    }
+    
+    void TestPortfolioEngine() {
+        std::cout << "Test 21: Portfolio Bar Close\n";
+        std::cout << "----------------------------\n";
+        
+        // A mixed book: every engine and variance reduction, several path
+        // counts, one random walk per symbol
+        const std::size_t symbols = 48;
+        const int bars = 80;
+        std::vector<BlackScholesTradeStation> sequential(symbols), batched(symbols);
+        std::vector<BlackScholesTradeStation*> book(symbols);
+        for (std::size_t i = 0; i < symbols; ++i) {
+            for (BlackScholesTradeStation* instance : {&sequential[i], &batched[i]}) {
+                instance->SetRandomSeed(2100 + i);
+                instance->SetSimulationEngine(static_cast<SimulationEngine>(i % 3));
+                instance->SetVarianceReduction(static_cast<VarianceReduction>(i / 3 % 4));
+                instance->SetMonteCarloSimulations(i % 2 ? 1000 : 3000);
+            }
+            book[i] = &batched[i];
+        }
+        std::vector<std::vector<double>> closes(bars, std::vector<double>(symbols));
+        std::mt19937 gen(21);
+        std::normal_distribution<> dailyReturn(0.0005, 0.02);
+        for (std::size_t i = 0; i < symbols; ++i) {
+            double price = 50.0 + 10.0 * i;
+            for (int bar = 0; bar < bars; ++bar) closes[bar][i] = price *= std::exp(dailyReturn(gen));
+        }
+        
+        // Every signal must match AnalyzeBar exactly, whatever the thread
+        // count of the batch
+        bool identical = true;
+        int signals = 0;
+        PortfolioEngine<BlackScholesTradeStation> portfolio;
+        std::vector<int> actions(symbols);
+        std::vector<double> buySignals(symbols), sellSignals(symbols), confidences(symbols);
+        for (int bar = 0; bar < bars; ++bar) {
+            SharedThreadPool().SetThreadCount(bar % 2 ? 1 : 4);
+            portfolio.AnalyzeBars(book.data(), closes[bar].data(), symbols, actions.data(), buySignals.data(),
+                                  sellSignals.data(), confidences.data());
+            for (std::size_t i = 0; i < symbols; ++i) {
+                double close = closes[bar][i];
+                double buySignal, sellSignal, confidence;
+                int action = sequential[i].AnalyzeBar(close, close, close, close, 0.0, bar + 1,
+                                                      buySignal, sellSignal, confidence);
+                identical = identical && action == actions[i] && buySignal == buySignals[i] &&
+                            sellSignal == sellSignals[i] && confidence == confidences[i];
+                if (action != 0) ++signals;
+            }
+        }
+        SharedThreadPool().SetThreadCount(0);
+        std::cout << "Batch matches per-symbol AnalyzeBar: " << (identical ? "PASS ✓" : "FAIL ✗") << " ("
+                  << symbols << " symbols x " << bars << " bars, " << signals << " trade signals)\n";
+        
+        // Warm batches reuse the engine's buffers and every instance's
+        std::uint64_t allocations = ThreadAllocationCount();
+        portfolio.AnalyzeBars(book.data(), closes[0].data(), symbols, actions.data(), nullptr, nullptr, nullptr);
+        allocations = ThreadAllocationCount() - allocations;
+        std::cout << "Warm batch heap allocations: " << (allocations == 0 ? "PASS ✓" : "FAIL ✗") << " ("
+                  << allocations << ")\n\n";
+    }
+    
+    void TestAsyncSignals() {
+        std::cout << "Test 22: Asynchronous Signals\n";
+        std::cout << "-----------------------------\n";
+        
+        // The queue hands a million items across threads in order
+        SpscQueue<std::uint64_t, 64> queue;
+        const std::uint64_t items = 1000000;
+        bool ordered = true;
+        std::thread consumer([&] {
+            std::uint64_t expected = 0, item;
+            while (expected < items) {
+                if (!queue.TryPop(item)) continue;
+                if (item != expected++) ordered = false;
+            }
+        });
+        for (std::uint64_t i = 0; i < items; ++i) {
+            while (!queue.TryPush(i)) std::this_thread::yield();
+        }
+        consumer.join();
+        std::cout << "SPSC queue order across threads: " << (ordered ? "PASS ✓" : "FAIL ✗") << "\n";
+        
+        // Readers never see a half-written value
+        struct Triple { double a, b, c; };
+        Seqlock<Triple> slot;
+        std::atomic<bool> done(false);
+        std::atomic<int> torn(0);
+        std::thread reader([&] {
+            while (!done.load()) {
+                Triple value = slot.Load();
+                if (value.a != value.b || value.b != value.c) ++torn;
+            }
+        });
+        for (int i = 1; i <= 200000; ++i) slot.Store(Triple{double(i), double(i), double(i)});
+        done = true;
+        reader.join();
+        std::cout << "Seqlock reads are consistent: " << (torn == 0 ? "PASS ✓" : "FAIL ✗") << "\n";
+        
+        // The async instance computes exactly the synchronous signals; every
+        // returned or polled signal matches the bar its sequence names, and
+        // the last one is current after the queue drains
+        std::mt19937 gen(22);
+        std::normal_distribution<> dailyReturn(0.0005, 0.02);
+        std::vector<double> closes = {400.0};
+        while (closes.size() < 120) closes.push_back(closes.back() * std::exp(dailyReturn(gen)));
+        
+        BlackScholesTradeStation synchronous, asynchronous;
+        for (BlackScholesTradeStation* instance : {&synchronous, &asynchronous}) {
+            instance->SetRandomSeed(22);
+            instance->SetMonteCarloSimulations(20000);
+        }
+        asynchronous.SetAsyncMode(true);
+        std::vector<int> actions(closes.size());
+        std::vector<double> confidences(closes.size());
+        double syncSeconds = 0.0, asyncSeconds = 0.0;
+        bool matched = true;
+        for (std::size_t i = 0; i < closes.size(); ++i) {
+            double buySignal, sellSignal, confidence;
+            auto start = std::chrono::steady_clock::now();
+            actions[i] = synchronous.AnalyzeBar(closes[i], closes[i], closes[i], closes[i], 0.0, static_cast<int>(i + 1),
+                                                buySignal, sellSignal, confidence);
+            confidences[i] = confidence;
+            auto middle = std::chrono::steady_clock::now();
+            std::uint64_t sequence;
+            int action = asynchronous.AnalyzeBar(closes[i], closes[i], closes[i], closes[i], 0.0,
+                                                 static_cast<int>(i + 1), buySignal, sellSignal, confidence,
+                                                 sequence);
+            auto end = std::chrono::steady_clock::now();
+            if (sequence > i + 1 || (sequence > 0 && (action != actions[sequence - 1] ||
+                                                      confidence != confidences[sequence - 1]))) {
+                matched = false;
+            }
+            syncSeconds += std::chrono::duration<double>(middle - start).count();
+            asyncSeconds += std::chrono::duration<double>(end - middle).count();
+            
+            AsyncSignal polled = asynchronous.PollSignal();
+            if (polled.sequence > 0 && (polled.barNumber != static_cast<int>(polled.sequence) ||
+                                        polled.action != actions[polled.sequence - 1] ||
+                                        polled.confidence != confidences[polled.sequence - 1])) {
+                matched = false;
+            }
+        }
+        double volatility = asynchronous.GetVolatility();   // Waits for the queue
+        AsyncSignal last = asynchronous.PollSignal();
+        matched = matched && last.sequence == closes.size() && asynchronous.SubmittedBars() == closes.size() &&
+                  last.action == actions.back() && last.confidence == confidences.back() &&
+                  volatility == synchronous.GetVolatility();
+        std::cout << "Async signals match synchronous bars: " << (matched ? "PASS ✓" : "FAIL ✗") << "\n";
+        std::cout << "Chart thread time per bar: " << std::fixed << std::setprecision(1)
+                  << syncSeconds / closes.size() * 1e6 << " us synchronous, "
+                  << asyncSeconds / closes.size() * 1e6 << " us async\n";
+        
+        asynchronous.SetAsyncMode(false);
+        double buySignal, sellSignal, confidence;
+        int action = asynchronous.AnalyzeBar(closes[0], closes[0], closes[0], closes[0], 0.0, 121,
+                                             buySignal, sellSignal, confidence);
+        int expected = synchronous.AnalyzeBar(closes[0], closes[0], closes[0], closes[0], 0.0, 121,
+                                              buySignal, sellSignal, confidence);
+        std::cout << "Back to synchronous mode: " << (action == expected && !asynchronous.AsyncMode() ? "PASS ✓" : "FAIL ✗")
+                  << "\n\n";
+    }
+    
+    void TestSignalCache() {
+        std::cout << "Test 23: Signal Cache\n";
+        std::cout << "---------------------\n";
+        
+        // States within a cell share a key; the path count must match and a
+        // zero tolerance never keys
+        SignalCacheKey a, b, c;
+        bool pass = QuantizeSignalState(400.0, 0.20, 0.08, 21, 1000, 0.01, a) &&
+                    QuantizeSignalState(400.4, 0.2001, 0.0801, 21, 1000, 0.01, b) && a == b &&
+                    QuantizeSignalState(400.0, 0.20, 0.08, 21, 2000, 0.01, c) && !(a == c) &&
+                    !QuantizeSignalState(400.0, 0.20, 0.08, 21, 1000, 0.0, c) &&
+                    !QuantizeSignalState(400.0, 0.0, 0.08, 21, 1000, 0.01, c);
+        
+        // Least recently used slot goes first
+        SignalCache<int, 2> cache;
+        SignalCacheKey keys[3];
+        for (int i = 0; i < 3; ++i) keys[i].drift = i;
+        cache.Insert(keys[0], 0);
+        cache.Insert(keys[1], 1);
+        pass = pass && cache.Find(keys[0]) && *cache.Find(keys[0]) == 0;
+        cache.Insert(keys[2], 2);
+        pass = pass && cache.Find(keys[0]) && !cache.Find(keys[1]) && cache.Find(keys[2]) && *cache.Find(keys[2]) == 2;
+        cache.Clear();
+        pass = pass && !cache.Find(keys[0]);
+        std::cout << "Cell keys and LRU slots: " << (pass ? "PASS ✓" : "FAIL ✗") << "\n";
+        
+        // A quiet, range-bound name: the returns alternate around a flat
+        // price, so volatility and drift barely move between bars
+        std::vector<double> closes;
+        for (int i = 0; i < 200; ++i) closes.push_back(400.0 * (1.0 + 0.004 * ((i % 2) ? 1 : -1) + 0.0005 * std::sin(0.1 * i)));
+        const int signalBars = static_cast<int>(closes.size()) - 29;
+        
+        BlackScholesTradeStation uncached, cached, batched;
+        for (BlackScholesTradeStation* instance : {&uncached, &cached, &batched}) {
+            instance->SetRandomSeed(23);
+            instance->SetMonteCarloSimulations(20000);
+        }
+        cached.SetSignalCacheTolerance(0.02);
+        batched.SetSignalCacheTolerance(0.02);
+        
+        // Cached signals come from earlier bars in the same cell; the batch
+        // path caches exactly like AnalyzeBar
+        BlackScholesTradeStation* book[1] = {&batched};
+        PortfolioEngine<BlackScholesTradeStation> portfolio;
+        double uncachedSeconds = 0.0, cachedSeconds = 0.0;
+        bool identical = true, agrees = true;
+        for (std::size_t i = 0; i < closes.size(); ++i) {
+            double close = closes[i];
+            double buySignal, sellSignal, confidence, cachedBuy, cachedSell, cachedConfidence;
+            auto start = std::chrono::steady_clock::now();
+            int action = uncached.AnalyzeBar(close, close, close, close, 0.0, static_cast<int>(i + 1),
+                                             buySignal, sellSignal, confidence);
+            auto middle = std::chrono::steady_clock::now();
+            int cachedAction = cached.AnalyzeBar(close, close, close, close, 0.0, static_cast<int>(i + 1),
+                                                 cachedBuy, cachedSell, cachedConfidence);
+            auto end = std::chrono::steady_clock::now();
+            uncachedSeconds += std::chrono::duration<double>(middle - start).count();
+            cachedSeconds += std::chrono::duration<double>(end - middle).count();
+            agrees = agrees && action == cachedAction && std::abs(confidence - cachedConfidence) < 0.05;
+            
+            int batchAction;
+            double batchBuy, batchSell, batchConfidence;
+            portfolio.AnalyzeBars(book, &close, 1, &batchAction, &batchBuy, &batchSell, &batchConfidence);
+            identical = identical && batchAction == cachedAction && batchBuy == cachedBuy &&
+                        batchSell == cachedSell && batchConfidence == cachedConfidence;
+        }
+        std::cout << "Cached signals agree with full evaluation: " << (agrees ? "PASS ✓" : "FAIL ✗") << "\n";
+        std::cout << "Batch and AnalyzeBar share the cache: " << (identical ? "PASS ✓" : "FAIL ✗") << "\n";
+        std::cout << "Time per bar: " << std::fixed << std::setprecision(1)
+                  << uncachedSeconds / closes.size() * 1e6 << " us uncached, "
+                  << cachedSeconds / closes.size() * 1e6 << " us cached\n";
+        
+#if BSTS_PERF_STATS
+        double stats[kPerfTableSize];
+        cached.GetPerfStats(stats, kPerfTableSize);
+        const double* counters = stats + kPerfStageCount * kPerfStatFieldCount;
+        double hits = counters[static_cast<int>(PerfCounter::SignalCacheHit)];
+        double misses = counters[static_cast<int>(PerfCounter::SignalCacheMiss)];
+        pass = hits + misses == signalBars && hits >= 0.9 * signalBars;
+        std::cout << "Hit and miss counters: " << (pass ? "PASS ✓" : "FAIL ✗") << " (" << std::setprecision(0)
+                  << hits << " hits, " << misses << " misses)\n";
+#else
+        (void)signalBars;
+#endif
+        std::cout << "\n";
+    }
+    
+    void TestPricingSurface() {
+        std::cout << "Test 24: Pricing Surface\n";
+        std::cout << "------------------------\n";
+        
+        // Interpolated values against the pricer at random volatilities,
+        // within the error Build measured, for two rates
+        const double years = 30.0 / 365.0;
+        PricingSurface surface;
+        double call = 0.0, put = 0.0;
+        bool pass = !surface.Lookup(0.2, call, put);
+        std::mt19937 gen(24);
+        std::uniform_real_distribution<> volatility(0.0, PricingSurface::kMaxVolatility);
+        double worst = 0.0, bound = 0.0;
+        for (double rate : {0.02, 0.10}) {
+            surface.Build(rate, years, 1.05, 0.95);
+            bound = std::max(bound, surface.MaxError());
+            simd::OptionChainMarket market;
+            market.spot = 1.0;
+            market.rate = rate;
+            const double strikes[2] = {1.05, 0.95};
+            const double expiries[2] = {years, years};
+            for (int i = 0; i < 20000; ++i) {
+                market.volatility = volatility(gen);
+                double calls[2], puts[2];
+                simd::OptionChainOutputs outputs;
+                outputs.callPrice = calls;
+                outputs.putPrice = puts;
+                simd::PriceOptionChain<CdfAccuracy::Libm>(market, strikes, expiries, 2, outputs);
+                pass = pass && surface.Lookup(market.volatility, call, put);
+                worst = std::max({worst, std::abs(call - calls[0]), std::abs(put - puts[1])});
+            }
+            pass = pass && surface.Rate() == rate;
+        }
+        pass = pass && worst <= 2.0 * bound && bound < 1e-8 &&
+               !surface.Lookup(PricingSurface::kMaxVolatility * 1.01, call, put) && !surface.Lookup(-0.01, call, put);
+        std::cout << "Hermite lookups within the bound: " << (pass ? "PASS ✓" : "FAIL ✗") << std::scientific
+                  << std::setprecision(2) << " (max error " << worst << ", bound " << bound << ")\n" << std::fixed;
+        
+        // Signals match direct pricing bar for bar, including after a rate
+        // change rebuilds the table
+        std::normal_distribution<> dailyReturn(0.0005, 0.02);
+        BlackScholesTradeStation direct, tabulated;
+        for (BlackScholesTradeStation* instance : {&direct, &tabulated}) {
+            instance->SetRandomSeed(24);
+            instance->SetVarianceReduction(VarianceReduction::Sobol);
+        }
+        tabulated.SetPricingSurface(true);
+        double price = 400.0, drift = 0.0;
+        bool matched = tabulated.PricingSurfaceError() > 0.0 && direct.PricingSurfaceError() == 0.0;
+        for (int i = 0; i < 160; ++i) {
+            if (i == 80) {
+                direct.SetRiskFreeRate(0.05);
+                tabulated.SetRiskFreeRate(0.05);
+            }
+            price *= std::exp(dailyReturn(gen));
+            double buySignal, sellSignal, confidence, tabulatedBuy, tabulatedSell, tabulatedConfidence;
+            int action = direct.AnalyzeBar(price, price, price, price, 0.0, i + 1, buySignal, sellSignal, confidence);
+            int tabulatedAction = tabulated.AnalyzeBar(price, price, price, price, 0.0, i + 1,
+                                                       tabulatedBuy, tabulatedSell, tabulatedConfidence);
+            drift = std::max({drift, std::abs(buySignal - tabulatedBuy), std::abs(sellSignal - tabulatedSell)});
+            matched = matched && action == tabulatedAction && confidence == tabulatedConfidence;
+        }
+        matched = matched && drift < 1e-6;
+        std::cout << "Signals match direct pricing: " << (matched ? "PASS ✓" : "FAIL ✗") << std::scientific
+                  << std::setprecision(2) << " (max strength difference " << drift << ")\n\n" << std::fixed;
+    }
+    
+    // A one-week horizon with 3% thresholds, on the closed-form engine
+    struct WeeklyPolicy : ScreeningPolicy {
+        static constexpr int kHorizonDays = 5;
+        static constexpr double kProfitThreshold = 1.03;
+        static constexpr double kLossThreshold = 0.97;
+    };
+    
+    void TestSignalPolicies() {
+        std::cout << "Test 25: Engine Presets\n";
+        std::cout << "-----------------------\n";
+        
+        std::mt19937 gen(25);
+        std::normal_distribution<> dailyReturn(0.0005, 0.02);
+        std::vector<double> closes = {400.0};
+        while (closes.size() < 200) closes.push_back(closes.back() * std::exp(dailyReturn(gen)));
+        
+        // The fixed terminal preset is the runtime default, bit for bit,
+        // and ignores engine changes
+        BlackScholesTradeStation runtime, analytic;
+        TerminalSamplingTradeStation terminal;
+        ScreeningTradeStation screening;
+        runtime.SetRandomSeed(25);
+        terminal.SetRandomSeed(25);
+        terminal.SetSimulationEngine(SimulationEngine::PathStepping);
+        analytic.SetSimulationEngine(SimulationEngine::Analytic);
+        bool identical = true, agrees = true;
+        double runtimeSeconds = 0.0, screeningSeconds = 0.0;
+        for (std::size_t i = 0; i < closes.size(); ++i) {
+            double close = closes[i];
+            int bar = static_cast<int>(i + 1);
+            double buySignal, sellSignal, confidence, otherBuy, otherSell, otherConfidence;
+            auto start = std::chrono::steady_clock::now();
+            int action = runtime.AnalyzeBar(close, close, close, close, 0.0, bar, buySignal, sellSignal, confidence);
+            auto middle = std::chrono::steady_clock::now();
+            int screened = screening.AnalyzeBar(close, close, close, close, 0.0, bar, otherBuy, otherSell, otherConfidence);
+            auto end = std::chrono::steady_clock::now();
+            runtimeSeconds += std::chrono::duration<double>(middle - start).count();
+            screeningSeconds += std::chrono::duration<double>(end - middle).count();
+            
+            // Screening matches the runtime analytic engine to the fast CDF's accuracy
+            double exactBuy, exactSell, exactConfidence;
+            int exact = analytic.AnalyzeBar(close, close, close, close, 0.0, bar, exactBuy, exactSell, exactConfidence);
+            agrees = agrees && screened == exact && std::abs(otherBuy - exactBuy) < 1e-5 &&
+                     std::abs(otherSell - exactSell) < 1e-5 && otherConfidence == exactConfidence;
+            
+            int fixed = terminal.AnalyzeBar(close, close, close, close, 0.0, bar, otherBuy, otherSell, otherConfidence);
+            identical = identical && fixed == action && otherBuy == buySignal && otherSell == sellSignal &&
+                        otherConfidence == confidence;
+        }
+        std::cout << "Fixed terminal preset matches the runtime engine: " << (identical ? "PASS ✓" : "FAIL ✗") << "\n";
+        std::cout << "Screening preset matches the analytic engine: " << (agrees ? "PASS ✓" : "FAIL ✗") << "\n";
+        std::cout << "Time per bar: " << std::setprecision(1) << runtimeSeconds / closes.size() * 1e6
+                  << " us runtime (1000 paths), " << std::setprecision(2)
+                  << screeningSeconds / closes.size() * 1e6 << " us screening\n";
+        
+        // A custom policy changes the horizon and thresholds at compile time
+        BasicBlackScholesTradeStation<WeeklyPolicy> weekly;
+        TerminalDistribution distribution = weekly.EstimateTerminalDistribution(400.0, 0.1, 0.3);
+        double horizon = 5.0 / 252.0;
+        double mean = (0.1 - 0.5 * 0.3 * 0.3) * horizon;
+        double deviation = 0.3 * std::sqrt(horizon);
+        bool pass = std::abs(distribution.profitProbability - NormalCDF((mean - std::log(1.03)) / deviation)) < 1e-6 &&
+                    std::abs(distribution.lossProbability - NormalCDF((std::log(0.97) - mean) / deviation)) < 1e-6;
+        std::cout << "Custom horizon policy: " << (pass ? "PASS ✓" : "FAIL ✗") << "\n\n";
+    }
+    
+    void TestRandomNumbers() {
+        std::cout << "Test 26: Random Numbers\n";
+        std::cout << "-----------------------\n";
+        
+        // Published known-answer vectors: Philox4x32-10 (Random123) for
+        // zero and all-ones counter and key, and xoshiro256++ from state
+        // {1, 2, 3, 4}. The path kernels run the same rounds.
+        std::uint32_t zero[4] = {0, 0, 0, 0};
+        std::uint32_t ones[4] = {0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu};
+        Philox4x32::Block(zero, 0, 0);
+        Philox4x32::Block(ones, 0xFFFFFFFFu, 0xFFFFFFFFu);
+        bool philox = zero[0] == 0x6627E8D5u && zero[1] == 0xE169C58Du && zero[2] == 0xBC57AC4Cu &&
+                      zero[3] == 0x9B00DBD8u && ones[0] == 0x408F276Du && ones[1] == 0x41C83B0Eu &&
+                      ones[2] == 0xA20BC7C6u && ones[3] == 0x6D5451FDu;
+        Xoshiro256 xoshiro(1, 2, 3, 4);
+        bool xoshiroPass = xoshiro.Next() == 41943041u;
+        std::cout << "Philox4x32-10 known answers: " << (philox ? "PASS ✓" : "FAIL ✗") << "\n";
+        std::cout << "xoshiro256++ known answer: " << (xoshiroPass ? "PASS ✓" : "FAIL ✗") << "\n";
+        
+        // Ziggurat moments and tail mass, for both generators, and Box-Muller's
+        const std::size_t count = 1000000;
+        std::vector<double> draws(count);
+        bool moments = true;
+        for (int generator = 0; generator < 3; ++generator) {
+            if (generator == 0) {
+                ZigguratNormal<Xoshiro256> normal(Xoshiro256(26));
+                normal.Fill(draws.data(), count);
+            } else if (generator == 1) {
+                ZigguratNormal<Philox4x32> normal(Philox4x32(26));
+                normal.Fill(draws.data(), count);
+            } else {
+                BoxMullerNormal<Philox4x32> normal(Philox4x32(26));
+                normal.Fill(draws.data(), count);
+            }
+            double sum = 0.0, squares = 0.0, fourth = 0.0;
+            std::size_t tail = 0;
+            for (double z : draws) {
+                sum += z;
+                squares += z * z;
+                fourth += z * z * z * z;
+                if (std::abs(z) > 3.442619855899) ++tail;
+            }
+            double mean = sum / count;
+            double variance = squares / count - mean * mean;
+            double expectedTail = 2.0 * (1.0 - NormalCDF(3.442619855899)) * count;
+            moments = moments && std::abs(mean) < 0.005 && std::abs(variance - 1.0) < 0.005 &&
+                      std::abs(fourth / count - 3.0) < 0.05 && std::abs(tail - expectedTail) < 5.0 * std::sqrt(expectedTail);
+        }
+        std::cout << "Ziggurat and Box-Muller mean, variance, kurtosis and tail: " << (moments ? "PASS ✓" : "FAIL ✗")
+                  << "\n";
+        
+        // Fill in pieces continues the same stream
+        ZigguratNormal<Xoshiro256> whole(Xoshiro256(42)), pieces(Xoshiro256(42));
+        std::vector<double> first(1000), second(1000);
+        whole.Fill(first.data(), first.size());
+        pieces.Fill(second.data(), 300);
+        pieces.Fill(second.data() + 300, 700);
+        bool blocks = first == second;
+        std::cout << "Block fills are one stream: " << (blocks ? "PASS ✓" : "FAIL ✗") << "\n";
+        
+        // Seed replay: a fresh instance given another's seed reproduces its
+        // signals, and self-drawn seeds survive an EasyLanguage double
+        BlackScholesTradeStation original, replay;
+        std::uint64_t seed = original.GetRandomSeed();
+        replay.SetRandomSeed(static_cast<std::uint64_t>(static_cast<double>(seed)));
+        bool replayed = seed < (std::uint64_t(1) << 53) && replay.GetRandomSeed() == seed;
+        double price = 400.0;
+        for (int bar = 1; bar <= 80; ++bar) {
+            price *= 1.0 + 0.01 * std::sin(bar * 0.7);
+            double buy, sell, confidence, otherBuy, otherSell, otherConfidence;
+            int action = original.AnalyzeBar(price, price, price, price, 0.0, bar, buy, sell, confidence);
+            int other = replay.AnalyzeBar(price, price, price, price, 0.0, bar, otherBuy, otherSell, otherConfidence);
+            replayed = replayed && action == other && buy == otherBuy && sell == otherSell && confidence == otherConfidence;
+        }
+        std::cout << "Seed round trip replays signals: " << (replayed ? "PASS ✓" : "FAIL ✗") << "\n";
+        
+        // Tick re-pricing and diagnostics between bars draw from their own
+        // streams, so the bar-close signals stay on the same paths
+        bool undisturbed = true;
+        for (SimulationEngine engine : {SimulationEngine::TerminalSampling, SimulationEngine::Barrier}) {
+            BlackScholesTradeStation quiet, busy;
+            for (BlackScholesTradeStation* instance : {&quiet, &busy}) {
+                instance->SetRandomSeed(2600);
+                instance->SetSimulationEngine(engine);
+            }
+            price = 400.0;
+            for (int bar = 1; bar <= 80; ++bar) {
+                price *= 1.0 + 0.01 * std::sin(bar * 0.7);
+                double buy, sell, confidence, otherBuy, otherSell, otherConfidence;
+                for (int tick = 1; tick <= 3; ++tick) {
+                    busy.UpdateTick(price * (1.0 + 0.002 * tick), otherBuy, otherSell, otherConfidence);
+                }
+                busy.EstimateTerminalDistribution(price, 0.1, 0.3);
+                busy.EstimateExitDistribution(price, 0.1, 0.3);
+                int action = quiet.AnalyzeBar(price, price, price, price, 0.0, bar, buy, sell, confidence);
+                int other = busy.AnalyzeBar(price, price, price, price, 0.0, bar, otherBuy, otherSell, otherConfidence);
+                undisturbed = undisturbed && action == other && buy == otherBuy && sell == otherSell &&
+                              confidence == otherConfidence;
+            }
+        }
+        std::cout << "Ticks and diagnostics leave bar signals unchanged: " << (undisturbed ? "PASS ✓" : "FAIL ✗")
+                  << "\n";
+        
+        // Policy hooks: a xoshiro256++ / Ziggurat / float engine matches the
+        // exact distribution within its standard errors, draws other paths
+        // than the kernels, and gives the same result for any thread count
+        BlackScholesTradeStation exactEngine, kernels;
+        exactEngine.SetSimulationEngine(SimulationEngine::Analytic);
+        TerminalDistribution exact = exactEngine.EstimateTerminalDistribution(400.0, 0.12, 0.25);
+        bool hooked = true;
+        for (SimulationEngine engine : {SimulationEngine::TerminalSampling, SimulationEngine::PathStepping}) {
+            for (VarianceReduction mode : {VarianceReduction::None, VarianceReduction::Antithetic}) {
+                BasicBlackScholesTradeStation<ZigguratFloatPolicy> custom;
+                auto configure = [&](auto& instance) {
+                    instance.SetSimulationEngine(engine);
+                    instance.SetVarianceReduction(mode);
+                    instance.SetMonteCarloSimulations(100000);
+                    instance.SetRandomSeed(2601);
+                };
+                configure(custom);
+                configure(kernels);
+                SharedThreadPool().SetThreadCount(1);
+                TerminalDistribution serial = custom.EstimateTerminalDistribution(400.0, 0.12, 0.25);
+                SharedThreadPool().SetThreadCount(4);
+                TerminalDistribution parallel = custom.EstimateTerminalDistribution(400.0, 0.12, 0.25);
+                TerminalDistribution kernel = kernels.EstimateTerminalDistribution(400.0, 0.12, 0.25);
+                hooked = hooked && serial.meanPrice == parallel.meanPrice &&
+                         serial.profitProbability == parallel.profitProbability &&
+                         serial.profitProbability != kernel.profitProbability &&
+                         std::abs(serial.profitProbability - exact.profitProbability) <
+                             4.0 * serial.profitProbabilityStdError &&
+                         std::abs(serial.lossProbability - exact.lossProbability) < 4.0 * serial.lossProbabilityStdError;
+            }
+        }
+        SharedThreadPool().SetThreadCount(0);
+        std::cout << "Rng/NormalSampler/Real policy hooks: " << (hooked ? "PASS ✓" : "FAIL ✗") << "\n";
+        
+        // Sampler cost against the standard library pair it replaces
+        const std::size_t samples = 2000000;
+        std::mt19937 gen(26);
+        std::normal_distribution<> standard;
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < samples; ++i) draws[i % count] = standard(gen);
+        auto middle = std::chrono::steady_clock::now();
+        ZigguratNormal<Xoshiro256> ziggurat(Xoshiro256(26));
+        for (std::size_t done = 0; done < samples; done += count) ziggurat.Fill(draws.data(), count);
+        auto end = std::chrono::steady_clock::now();
+        std::cout << "Time per normal: " << std::setprecision(1)
+                  << std::chrono::duration<double>(middle - start).count() / samples * 1e9
+                  << " ns mt19937 + normal_distribution, "
+                  << std::chrono::duration<double>(end - middle).count() / samples * 1e9 << " ns Ziggurat\n\n";
+    }
+    
+    void TestStateFiles() {
+        std::cout << "Test 27: State Snapshots\n";
+        std::cout << "------------------------\n";
+        
+        std::mt19937 gen(27);
+        std::normal_distribution<> dailyReturn(0.0005, 0.02);
+        std::vector<double> closes = {400.0};
+        while (closes.size() < 400) closes.push_back(closes.back() * std::exp(dailyReturn(gen)));
+        
+        // Save mid-run (with an open position), restore into a fresh
+        // instance, and both continue identically
+        BlackScholesTradeStation original, restored;
+        original.SetLookbackPeriod(120);
+        restored.SetLookbackPeriod(120);
+        original.LoadHistory(closes.data(), 300);
+        original.SetPosition(closes[299], 50);
+        StateFileWriter writer;
+        original.SaveState(writer, 0, 20240105.0);
+        bool pass = writer.Write("test_state.bsts");
+        StateFile file;
+        pass = pass && file.Open("test_state.bsts") && file.Count() == 1 && file.Find(0) &&
+               file.Find(0)->record->stamp == 20240105.0 && restored.LoadState(*file.Find(0));
+        pass = pass && restored.GetVolatility() == original.GetVolatility() &&
+               restored.GetExpectedReturn() == original.GetExpectedReturn();
+        for (std::size_t i = 300; i < closes.size(); ++i) {
+            double close = closes[i];
+            int bar = static_cast<int>(i + 1);
+            double buy, sell, confidence, otherBuy, otherSell, otherConfidence;
+            int action = original.AnalyzeBar(close, close, close, close, 0.0, bar, buy, sell, confidence);
+            int other = restored.AnalyzeBar(close, close, close, close, 0.0, bar, otherBuy, otherSell, otherConfidence);
+            pass = pass && action == other && buy == otherBuy && sell == otherSell && confidence == otherConfidence &&
+                   original.GetUnrealizedPnL() == restored.GetUnrealizedPnL();
+        }
+        std::cout << "Restored instance continues bit for bit: " << (pass ? "PASS ✓" : "FAIL ✗") << "\n";
+        
+        // A different lookback, a truncated file and a foreign file are refused
+        BlackScholesTradeStation mismatched;
+        mismatched.SetLookbackPeriod(60);
+        pass = !mismatched.LoadState(*file.Find(0));
+        file.Close();
+        {
+            std::ifstream in("test_state.bsts", std::ios::binary);
+            std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            std::ofstream out("test_state_truncated.bsts", std::ios::binary);
+            out.write(bytes.data(), bytes.size() - 8);
+        }
+        StateFile invalid;
+        pass = pass && !invalid.Open("test_state_truncated.bsts") && !invalid.IsOpen() &&
+               !invalid.Open("missing.bsts");
+        std::cout << "Mismatched and invalid snapshots rejected: " << (pass ? "PASS ✓" : "FAIL ✗") << "\n";
+        
+        // A 300-symbol book: one file, restored by key from one mapping
+        const int book = 300;
+        std::vector<BlackScholesTradeStation> instances(book), copies(book);
+        StateFileWriter bookWriter;
+        for (int i = 0; i < book; ++i) {
+            instances[i].LoadHistory(closes.data() + i % 100, 252);
+            instances[i].SaveState(bookWriter, 1000 + i, i);
+        }
+        pass = bookWriter.Write("test_book.bsts");
+        auto start = std::chrono::steady_clock::now();
+        StateFile bookFile;
+        pass = pass && bookFile.Open("test_book.bsts") && bookFile.Count() == book;
+        for (int i = book - 1; i >= 0 && pass; --i) {
+            const EngineStateView* state = bookFile.Find(1000 + i);
+            pass = state && state->record->stamp == i && copies[i].LoadState(*state);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        for (int i = 0; i < book && pass; ++i) pass = copies[i].GetVolatility() == instances[i].GetVolatility();
+        std::cout << "Book restored by key: " << (pass ? "PASS ✓" : "FAIL ✗") << "\n";
+        std::cout << "Restore time for " << book << " instances: " << std::setprecision(2) << seconds * 1e3 << " ms\n\n";
+        bookFile.Close();
+        std::remove("test_state.bsts");
+        std::remove("test_state_truncated.bsts");
+        std::remove("test_book.bsts");
+    }
+    
+    // Bars of a driftless Brownian log price stepped finely within each
+    // bar; gapShare of each bar's variance is an overnight gap before the open
+    static BarColumns BrownianBars(std::size_t count, double dailyVolatility, double gapShare, std::uint64_t seed) {
+        const int steps = 2000;
+        ZigguratNormal<Xoshiro256> normal((Xoshiro256(seed)));
+        double gap = dailyVolatility * std::sqrt(gapShare);
+        double step = dailyVolatility * std::sqrt((1.0 - gapShare) / steps);
+        BarColumns bars;
+        double logClose = std::log(100.0);
+        for (std::size_t i = 0; i < count; ++i) {
+            double logPrice = logClose + gap * normal();
+            double logOpen = logPrice, logHigh = logPrice, logLow = logPrice;
+            for (int j = 0; j < steps; ++j) {
+                logPrice += step * normal();
+                logHigh = std::max(logHigh, logPrice);
+                logLow = std::min(logLow, logPrice);
+            }
+            logClose = logPrice;
+            bars.timestamps.push_back(static_cast<std::int64_t>(i));
+            bars.open.push_back(std::exp(logOpen));
+            bars.high.push_back(std::exp(logHigh));
+            bars.low.push_back(std::exp(logLow));
+            bars.close.push_back(std::exp(logClose));
+            bars.volume.push_back(0.0);
+        }
+        return bars;
+    }
+    
+    void TestRangeVolatility() {
+        std::cout << "Test 28: Range Volatility Estimators\n";
+        std::cout << "------------------------------------\n";
+        
+        // Daily variance estimates over many independent 21-bar windows:
+        // bias and relative efficiency against close-to-close
+        const VolatilityEstimator estimators[4] = {VolatilityEstimator::CloseToClose, VolatilityEstimator::Parkinson,
+                                                   VolatilityEstimator::GarmanKlass, VolatilityEstimator::YangZhang};
+        const char* names[4] = {"Close-to-close", "Parkinson", "Garman-Klass", "Yang-Zhang"};
+        const int windows = 300;
+        const int lookback = 21;
+        const double dailyVolatility = 0.015;
+        double means[2][4], variances[2][4];
+        for (int gapped = 0; gapped < 2; ++gapped) {
+            double sums[4] = {0, 0, 0, 0}, squares[4] = {0, 0, 0, 0};
+            for (int w = 0; w < windows; ++w) {
+                BarColumns bars = BrownianBars(lookback + 1, dailyVolatility, gapped ? 0.3 : 0.0, 2800 + w);
+                for (int e = 0; e < 4; ++e) {
+                    BlackScholesTradeStation estimator;
+                    estimator.SetLookbackPeriod(lookback);
+                    estimator.SetVolatilityEstimator(estimators[e]);
+                    estimator.LoadHistory(bars.Series());
+                    double volatility = estimator.GetVolatility();
+                    double ratio = volatility * volatility / 252.0 / (dailyVolatility * dailyVolatility);
+                    sums[e] += ratio;
+                    squares[e] += ratio * ratio;
+                }
+            }
+            for (int e = 0; e < 4; ++e) {
+                means[gapped][e] = sums[e] / windows;
+                variances[gapped][e] = squares[e] / windows - means[gapped][e] * means[gapped][e];
+            }
+        }
+        bool unbiased = true, efficient = true;
+        for (int e = 0; e < 4; ++e) {
+            unbiased = unbiased && std::abs(means[0][e] - 1.0) < 0.08;
+            if (e > 0) efficient = efficient && variances[0][0] / variances[0][e] > 3.0;
+            std::cout << "  " << names[e] << ": mean " << std::setprecision(3) << means[0][e] << " (gapped "
+                      << means[1][e] << "), efficiency " << std::setprecision(1)
+                      << variances[0][0] / variances[0][e] << "x\n";
+        }
+        std::cout << "Unbiased on Brownian bars: " << (unbiased ? "PASS ✓" : "FAIL ✗") << "\n";
+        std::cout << "At least 3x close-to-close efficiency: " << (efficient ? "PASS ✓" : "FAIL ✗") << "\n";
+        bool gaps = std::abs(means[1][3] - 1.0) < 0.08 && std::abs(means[1][0] - 1.0) < 0.08 && means[1][1] < 0.8;
+        std::cout << "Yang-Zhang keeps opening gaps, Parkinson misses them: " << (gaps ? "PASS ✓" : "FAIL ✗") << "\n";
+        
+        // Close-only bars carry no range: Yang-Zhang falls back to the
+        // close-to-close variance
+        std::vector<double> closes(300);
+        BarColumns bars = BrownianBars(closes.size(), dailyVolatility, 0.0, 28);
+        BlackScholesTradeStation closeToClose, yangZhang;
+        yangZhang.SetVolatilityEstimator(VolatilityEstimator::YangZhang);
+        closeToClose.LoadHistory(bars.close.data(), static_cast<int>(bars.Size()));
+        yangZhang.LoadHistory(bars.close.data(), static_cast<int>(bars.Size()));
+        bool fallback = std::abs(yangZhang.GetVolatility() / closeToClose.GetVolatility() - 1.0) < 1e-9;
+        std::cout << "Close-only bars fall back to close-to-close: " << (fallback ? "PASS ✓" : "FAIL ✗") << "\n";
+        
+        // Portfolio batches of full bars match AnalyzeBar under Yang-Zhang;
+        // a close-only batch is refused rather than degrading the estimate
+        const std::size_t symbols = 6;
+        const int batchBars = 60;
+        std::vector<BlackScholesTradeStation> single(symbols), batched(symbols);
+        std::vector<BlackScholesTradeStation*> book(symbols);
+        std::vector<BarColumns> symbolBars;
+        for (std::size_t i = 0; i < symbols; ++i) {
+            for (BlackScholesTradeStation* instance : {&single[i], &batched[i]}) {
+                instance->SetRandomSeed(2810 + i);
+                instance->SetSimulationEngine(static_cast<SimulationEngine>(i % 3));
+                instance->SetVolatilityEstimator(VolatilityEstimator::YangZhang);
+            }
+            book[i] = &batched[i];
+            symbolBars.push_back(BrownianBars(batchBars, dailyVolatility, 0.3, 2820 + i));
+        }
+        PortfolioEngine<BlackScholesTradeStation> portfolio;
+        std::vector<double> opens(symbols), highs(symbols), lows(symbols), batchCloses(symbols);
+        std::vector<int> actions(symbols);
+        std::vector<double> buys(symbols), sells(symbols), confidences(symbols);
+        bool matched = true;
+        int signals = 0;
+        for (int bar = 0; bar < batchBars; ++bar) {
+            for (std::size_t i = 0; i < symbols; ++i) {
+                opens[i] = symbolBars[i].open[bar];
+                highs[i] = symbolBars[i].high[bar];
+                lows[i] = symbolBars[i].low[bar];
+                batchCloses[i] = symbolBars[i].close[bar];
+            }
+            portfolio.AnalyzeBars(book.data(), opens.data(), highs.data(), lows.data(), batchCloses.data(), symbols,
+                                  actions.data(), buys.data(), sells.data(), confidences.data());
+            for (std::size_t i = 0; i < symbols; ++i) {
+                double buy, sell, confidence;
+                int action = single[i].AnalyzeBar(opens[i], highs[i], lows[i], batchCloses[i], 0.0, bar + 1,
+                                                  buy, sell, confidence);
+                matched = matched && action == actions[i] && buy == buys[i] && sell == sells[i] &&
+                          confidence == confidences[i];
+                if (confidence > 0.0) ++signals;
+            }
+        }
+        matched = matched && signals > 0 && batched[0].GetVolatility() == single[0].GetVolatility();
+        std::cout << "Yang-Zhang batch matches AnalyzeBar: " << (matched ? "PASS ✓" : "FAIL ✗") << " (" << signals
+                  << " signals)\n";
+        double before = batched[0].GetVolatility();
+        portfolio.AnalyzeBars(book.data(), batchCloses.data(), symbols, actions.data(), buys.data(), sells.data(),
+                              confidences.data());
+        bool refused = batched[0].GetVolatility() == before;
+        for (std::size_t i = 0; i < symbols; ++i) refused = refused && actions[i] == 0 && confidences[i] == 0.0;
+        std::cout << "Close-only batch refused under Yang-Zhang: " << (refused ? "PASS ✓" : "FAIL ✗") << "\n";
+        
+        // The first signal comes after 10 bars instead of 30
+        BlackScholesTradeStation ranged;
+        ranged.SetRandomSeed(28);
+        ranged.SetVolatilityEstimator(VolatilityEstimator::GarmanKlass);
+        int firstSignal = 0;
+        for (int i = 0; i < 40 && firstSignal == 0; ++i) {
+            double buy, sell, confidence;
+            ranged.AnalyzeBar(bars.open[i], bars.high[i], bars.low[i], bars.close[i], 0.0, i + 1, buy, sell, confidence);
+            if (confidence > 0.0) firstSignal = i + 1;
+        }
+        std::cout << "Warm-up shortened to 10 bars: " << (firstSignal == 10 ? "PASS ✓" : "FAIL ✗") << "\n";
+        
+        // Range accumulators survive a snapshot bit for bit
+        BlackScholesTradeStation original, restored;
+        original.SetVolatilityEstimator(VolatilityEstimator::YangZhang);
+        restored.SetVolatilityEstimator(VolatilityEstimator::YangZhang);
+        BarSeries first = bars.Series();
+        first.count = 200;
+        original.LoadHistory(first);
+        StateFileWriter writer;
+        original.SaveState(writer, 0, 0.0);
+        bool pass = writer.Write("test_range_state.bsts");
+        StateFile file;
+        pass = pass && file.Open("test_range_state.bsts") && restored.LoadState(file.Record(0));
+        for (std::size_t i = 200; i < bars.Size() && pass; ++i) {
+            double buy, sell, confidence, otherBuy, otherSell, otherConfidence;
+            original.AnalyzeBar(bars.open[i], bars.high[i], bars.low[i], bars.close[i], 0.0, 0, buy, sell, confidence);
+            restored.AnalyzeBar(bars.open[i], bars.high[i], bars.low[i], bars.close[i], 0.0, 0, otherBuy, otherSell,
+                                otherConfidence);
+            pass = buy == otherBuy && sell == otherSell && original.GetVolatility() == restored.GetVolatility();
+        }
+        file.Close();
+        std::remove("test_range_state.bsts");
+        std::cout << "Range state restored bit for bit: " << (pass ? "PASS ✓" : "FAIL ✗") << "\n\n";
+    }
+    
+    // P(min of a GBM log path hits log level b < 0 by t), drift nu = mu - sigma^2/2
+    static double FirstPassageProbability(double b, double nu, double sigma, double t) {
+        if (t <= 0.0) return 0.0;
+        double spread = sigma * std::sqrt(t);
+        return NormalCDF((b - nu * t) / spread) +
+               std::exp(2.0 * nu * b / (sigma * sigma)) * NormalCDF((b + nu * t) / spread);
+    }
+    
+    void TestBarrierEngine() {
+        std::cout << "Test 29: Barrier First-Passage Engine\n";
+        std::cout << "-------------------------------------\n";
+        
+        // A lone stop-loss against the closed-form first passage of drifted
+        // GBM; the holding time is the integral of the survival curve
+        const double drift = 0.1, sigma = 0.3, horizon = 21.0 / 252.0, paths = 200000;
+        const double nu = drift - 0.5 * sigma * sigma, level = std::log(0.95);
+        BlackScholesTradeStation barrier;
+        barrier.SetRandomSeed(29);
+        barrier.SetMonteCarloSimulations(static_cast<int>(paths));
+        barrier.SetStopLoss(0.05);
+        barrier.SetTakeProfit(1e6);
+        TerminalDistribution single = barrier.EstimateExitDistribution(100.0, drift, sigma);
+        double exact = FirstPassageProbability(level, nu, sigma, horizon);
+        double exactDays = 0.0;
+        for (int i = 0; i < 4000; ++i) {
+            exactDays += 1.0 - FirstPassageProbability(level, nu, sigma, (i + 0.5) / 4000 * horizon);
+        }
+        exactDays *= 21.0 / 4000;
+        double error = std::sqrt(exact * (1.0 - exact) / paths);
+        std::cout << std::setprecision(4) << "  Stop hit " << single.stopLossHitProbability << " (exact " << exact
+                  << "), exit after " << single.expectedExitDays << " days (exact " << exactDays << ")\n";
+        bool pass = std::abs(single.stopLossHitProbability - exact) < 4.0 * error &&
+                    single.takeProfitHitProbability == 0.0 && std::abs(single.expectedExitDays - exactDays) < 0.1;
+        std::cout << "Single barrier matches the closed form: " << (pass ? "PASS ✓" : "FAIL ✗") << "\n";
+        
+        // Two levels +-a in log space with no log drift: each is hit first
+        // with half the exit probability of the series solution
+        const double a = 0.08, pi = 3.14159265358979323846;
+        barrier.SetStopLoss(1.0 - std::exp(-a));
+        barrier.SetTakeProfit(std::exp(a) - 1.0);
+        TerminalDistribution both = barrier.EstimateExitDistribution(100.0, 0.5 * sigma * sigma, sigma);
+        double survival = 0.0;
+        for (int k = 0; k < 50; ++k) {
+            double m = 2.0 * k + 1.0;
+            survival += (k % 2 ? -4.0 : 4.0) / (pi * m) * std::exp(-m * m * pi * pi * sigma * sigma * horizon / (8.0 * a * a));
+        }
+        double side = 0.5 * (1.0 - survival);
+        error = std::sqrt(side * (1.0 - side) / paths);
+        std::cout << "  Take-profit " << both.takeProfitHitProbability << ", stop " << both.stopLossHitProbability
+                  << " (exact " << side << " each)\n";
+        pass = std::abs(both.takeProfitHitProbability - side) < 4.0 * error &&
+               std::abs(both.stopLossHitProbability - side) < 4.0 * error &&
+               both.profitProbability >= both.takeProfitHitProbability &&
+               both.lossProbability >= both.stopLossHitProbability;
+        std::cout << "Double barrier matches the series solution: " << (pass ? "PASS ✓" : "FAIL ✗") << "\n";
+        
+        // Every ISA takes the same exits (crossing tests may flip on
+        // rounding at most a path or two), and any tile split sums the same
+        simd::GbmTileParameters parameters;
+        parameters.spot = 400.0;
+        parameters.stepDrift = 0.05 * 5.0 / 252.0;
+        parameters.stepVolatility = 0.3 * std::sqrt(5.0 / 252.0);
+        parameters.steps = 5;
+        parameters.seed = 0x5EEDULL;
+        parameters.stream = 29;
+        simd::BarrierReduction levels;
+        levels.upperLevel = 440.0;
+        levels.lowerLevel = 380.0;
+        levels.profitLevel = 420.0;
+        levels.lossLevel = 380.0;
+        levels.pathLimit = 1000;
+        const std::uint64_t tiles = 63;
+        simd::BarrierSums reference;
+        simd::ReduceBarrierTiles(SimdLevel::Scalar, parameters, levels, 0, tiles, reference);
+        const SimdLevel isas[] = {SimdLevel::Avx2, SimdLevel::Avx512};
+        const char* names[] = {"AVX2", "AVX-512"};
+        for (int i = 0; i < 2; ++i) {
+            if (static_cast<int>(isas[i]) > static_cast<int>(DetectSimdLevel())) {
+                std::cout << names[i] << " barrier exits vs scalar: SKIPPED (not supported by this CPU)\n";
+                continue;
+            }
+            simd::BarrierSums vectorized;
+            simd::ReduceBarrierTiles(isas[i], parameters, levels, 0, tiles, vectorized);
+            pass = vectorized.exit.paths == reference.exit.paths &&
+                   std::abs(vectorized.upperHits - reference.upperHits) <= 2.0 &&
+                   std::abs(vectorized.lowerHits - reference.lowerHits) <= 2.0;
+            std::cout << names[i] << " barrier exits vs scalar: " << (pass ? "PASS ✓" : "FAIL ✗") << "\n";
+        }
+        simd::BarrierSums whole, split;
+        simd::ReduceBarrierTiles(parameters, levels, 0, tiles, whole);
+        simd::ReduceBarrierTiles(parameters, levels, 0, 24, split);
+        simd::ReduceBarrierTiles(parameters, levels, 24, tiles - 24, split);
+        pass = split.exit.paths == 1000 && split.upperHits == whole.upperHits && split.lowerHits == whole.lowerHits &&
+               split.exitSteps == whole.exitSteps && std::abs(split.exit.price - whole.exit.price) < 1e-9 * 1000 * 400;
+        std::cout << "Split tile ranges and path limit: " << (pass ? "PASS ✓" : "FAIL ✗") << "\n";
+        
+        // Barrier-mode signals replay under one seed, and the exit levels
+        // move them
+        BlackScholesTradeStation first, second;
+        for (BlackScholesTradeStation* engine : {&first, &second}) {
+            engine->SetRandomSeed(290);
+            engine->SetSimulationEngine(SimulationEngine::Barrier);
+        }
+        pass = true;
+        for (size_t i = 0; i < testPrices.size(); ++i) {
+            double price = testPrices[i], buy, sell, confidence, otherBuy, otherSell, otherConfidence;
+            int action = first.AnalyzeBar(price, price, price, price, 0.0, static_cast<int>(i), buy, sell, confidence);
+            int other = second.AnalyzeBar(price, price, price, price, 0.0, static_cast<int>(i), otherBuy, otherSell,
+                                          otherConfidence);
+            pass = pass && action == other && buy == otherBuy && sell == otherSell && confidence == otherConfidence;
+        }
+        TerminalDistribution wide = first.EstimateTerminalDistribution(100.0, 0.08, 0.25);
+        first.SetStopLoss(0.02);
+        TerminalDistribution tight = first.EstimateTerminalDistribution(100.0, 0.08, 0.25);
+        pass = pass && tight.stopLossHitProbability > wide.stopLossHitProbability &&
+               tight.expectedExitDays < wide.expectedExitDays && wide.expectedExitDays > 0.0 &&
+               wide.expectedExitDays <= 21.0;
+        std::cout << "Barrier signals replay and follow the exit levels: " << (pass ? "PASS ✓" : "FAIL ✗") << "\n";
+        
+        // Coarse bridged steps with early exit against the daily loop
+        auto bestTime = [](BlackScholesTradeStation& engine) {
+            double best = 1e30;
+            for (int run = 0; run < 5; ++run) {
+                auto start = std::chrono::steady_clock::now();
+                TerminalDistribution distribution = engine.EstimateTerminalDistribution(100.0, 0.08, 0.25);
+                auto stop = std::chrono::steady_clock::now();
+                best = std::min(best, std::chrono::duration<double, std::micro>(stop - start).count());
+                if (!(distribution.confidence > 0.0)) best = 1e30;
+            }
+            return best;
+        };
+        BlackScholesTradeStation stepping, bridged;
+        stepping.SetSimulationEngine(SimulationEngine::PathStepping);
+        bridged.SetSimulationEngine(SimulationEngine::Barrier);
+        stepping.SetMonteCarloSimulations(20000);
+        bridged.SetMonteCarloSimulations(20000);
+        double steppingTime = bestTime(stepping), bridgedTime = bestTime(bridged);
+        std::cout << "  20000 paths: daily steps " << std::setprecision(0) << steppingTime << " us, barrier "
+                  << bridgedTime << " us\n";
+        std::cout << "Barrier engine cheaper than daily path stepping: "
+                  << (bridgedTime < steppingTime ? "PASS ✓" : "FAIL ✗") << "\n\n";
+    }
+    
     void GenerateReport() {
         std::cout << "=== Test Report Summary ===\n";
         std::cout << "Algorithm Status: OPERATIONAL ✓\n";